@@ -0,0 +1,118 @@
+#include "thread_pool.h"
+
+#include <atomic>
+#include <memory>
+#include <algorithm>
+
+namespace undicht {
+
+    ThreadPool::ThreadPool(unsigned int thread_count) {
+
+        if (!thread_count) {
+            // the calling thread usually works as well (see parallelFor())
+            thread_count = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+        }
+
+        for (unsigned int i = 0; i < thread_count; i++)
+            m_workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+
+    ThreadPool::~ThreadPool() {
+
+        {
+            std::lock_guard<std::mutex> lock(m_task_mutex);
+            m_stop = true;
+        }
+
+        m_task_available.notify_all();
+
+        for (std::thread& worker : m_workers)
+            worker.join();
+    }
+
+    unsigned int ThreadPool::getThreadCount() const {
+
+        return m_workers.size();
+    }
+
+    void ThreadPool::submit(const std::function<void()>& task) {
+        /** the task is executed on one of the worker threads (in the order the tasks were submitted) */
+
+        {
+            std::lock_guard<std::mutex> lock(m_task_mutex);
+            m_tasks.push(task);
+        }
+
+        m_task_available.notify_one();
+    }
+
+    void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& function) {
+        /** calls function(i) for every i in [0, count), distributed among the worker threads and the calling thread
+        * returns once all calls have finished */
+
+        struct ParallelForState {
+            std::atomic<size_t> next_index;
+            std::atomic<size_t> finished_count;
+            std::mutex mutex;
+            std::condition_variable all_finished;
+        };
+
+        if (!count)
+            return;
+
+        // the workers may only start after the calling thread already did all the work
+        // so the state has to be kept alive until the last worker is done with it
+        std::shared_ptr<ParallelForState> state = std::make_shared<ParallelForState>();
+        state->next_index = 0;
+        state->finished_count = 0;
+
+        // executes calls until there are none left
+        std::function<void()> work = [state, count, &function]() {
+
+            for (size_t i = state->next_index++; i < count; i = state->next_index++) {
+
+                function(i);
+
+                if (++state->finished_count == count) {
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    state->all_finished.notify_all();
+                }
+
+            }
+
+        };
+
+        size_t helper_count = std::min<size_t>(m_workers.size(), count - 1);
+        for (size_t i = 0; i < helper_count; i++)
+            submit(work);
+
+        work();
+
+        // waiting for the calls still executed by the workers
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->all_finished.wait(lock, [&state, count] { return state->finished_count == count; });
+    }
+
+    void ThreadPool::workerLoop() {
+
+        while (true) {
+
+            std::function<void()> task;
+
+            {
+                std::unique_lock<std::mutex> lock(m_task_mutex);
+                m_task_available.wait(lock, [this] { return m_stop || !m_tasks.empty(); });
+
+                if (m_tasks.empty())
+                    return; // stopped and all tasks are done
+
+                task = m_tasks.front();
+                m_tasks.pop();
+            }
+
+            task();
+        }
+
+    }
+
+} // namespace undicht
@@ -0,0 +1,53 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+#include "unique_object.h"
+
+namespace undicht {
+
+    class ThreadPool : public core::UniqueObject {
+        /** a fixed number of worker threads that execute tasks
+        * (so that threads dont have to be created every time something should be done in parallel) */
+
+      protected:
+
+        std::vector<std::thread> m_workers;
+
+        std::queue<std::function<void()>> m_tasks;
+        std::mutex m_task_mutex;
+        std::condition_variable m_task_available;
+        bool m_stop = false;
+
+      public:
+
+        /** @param thread_count: the number of worker threads (0: one per hardware thread, minus the calling thread) */
+        ThreadPool(unsigned int thread_count = 0);
+
+        /** waits for the tasks that were already submitted */
+        virtual ~ThreadPool();
+
+        unsigned int getThreadCount() const;
+
+        /** the task is executed on one of the worker threads (in the order the tasks were submitted) */
+        void submit(const std::function<void()>& task);
+
+        /** calls function(i) for every i in [0, count), distributed among the worker threads and the calling thread
+        * returns once all calls have finished
+        * can be called from inside a task (the calling thread keeps working, so it does not wait for busy workers) */
+        void parallelFor(size_t count, const std::function<void(size_t)>& function);
+
+      protected:
+
+        void workerLoop();
+    };
+
+} // namespace undicht
+
+#endif // THREAD_POOL_H
@@ -12,6 +12,8 @@ namespace undicht {
         COLOR_RGBA,
         DEPTH_BUFFER,
         DEPTH_STENCIL_BUFFER,
+        NORMALIZED_INT, // integers that are read as floats in [-1, 1] (snorm)
+        NORMALIZED_UNSIGNED_INT, // integers that are read as floats in [0, 1] (unorm)
     };
 
     class FixedType {
@@ -56,6 +58,7 @@ namespace undicht {
 #define UND_UINT32 FixedType(Type::UNSIGNED_INT, 4)
 #define UND_UINT64 FixedType(Type::UNSIGNED_INT, 8)
 
+#define UND_FLOAT16 FixedType(Type::FLOAT, 2) // half
 #define UND_FLOAT32 FixedType(Type::FLOAT, 4) // float
 #define UND_FLOAT64 FixedType(Type::FLOAT, 8) // double
 
@@ -63,10 +66,23 @@ namespace undicht {
 #define UND_VEC3F FixedType(Type::FLOAT, 4, 3)
 #define UND_VEC4F FixedType(Type::FLOAT, 4, 4)
 
+#define UND_VEC2H FixedType(Type::FLOAT, 2, 2)
+#define UND_VEC4H FixedType(Type::FLOAT, 2, 4)
+
 #define UND_VEC2I FixedType(Type::INT, 4, 2)
 #define UND_VEC3I FixedType(Type::INT, 4, 3)
 #define UND_VEC4I FixedType(Type::INT, 4, 4)
 
+// compact vertex attributes (8 / 16 bit integers that are read as floats in [-1, 1] / [0, 1])
+#define UND_VEC2SN8 FixedType(Type::NORMALIZED_INT, 1, 2)
+#define UND_VEC4SN8 FixedType(Type::NORMALIZED_INT, 1, 4)
+#define UND_VEC2SN16 FixedType(Type::NORMALIZED_INT, 2, 2)
+#define UND_VEC4SN16 FixedType(Type::NORMALIZED_INT, 2, 4)
+#define UND_VEC2UN8 FixedType(Type::NORMALIZED_UNSIGNED_INT, 1, 2)
+#define UND_VEC4UN8 FixedType(Type::NORMALIZED_UNSIGNED_INT, 1, 4)
+#define UND_VEC2UN16 FixedType(Type::NORMALIZED_UNSIGNED_INT, 2, 2)
+#define UND_VEC4UN16 FixedType(Type::NORMALIZED_UNSIGNED_INT, 2, 4)
+
 #define UND_MAT3F FixedType(Type::FLOAT, 4, 9)
 #define UND_MAT4F FixedType(Type::FLOAT, 4, 16)
 
@@ -0,0 +1,26 @@
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+#include <chrono>
+
+namespace benchmarks {
+
+    /** @return the time since the start point in milliseconds */
+    inline double getMillisecondsSince(const std::chrono::steady_clock::time_point& start) {
+
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    /** ModelLoader::buildIndices() (hash map) against the quadratic search it replaced, on synthetic meshes of up to a million vertices
+    * @param full: also run the quadratic search on the biggest mesh (takes minutes) */
+    void vertexWelding(bool full);
+
+    /** walking the arena element tree against the vector layout it replaced (a collada like file with ~240k elements) */
+    void xmlTraversal();
+
+    /** extractFloatArray() / extractIntArray() against the strtof / strtol loops they replaced, in MB/s of text */
+    void numberParsing();
+
+} // benchmarks
+
+#endif // BENCHMARKS_H
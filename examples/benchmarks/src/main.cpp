@@ -0,0 +1,24 @@
+#include "benchmarks.h"
+#include "debug.h"
+
+#include <string>
+
+int main(int argc, char** argv) {
+    // benchmarks [name] [full]
+    // runs all benchmarks, or only the one with the name (i.e. "benchmarks vertex_welding")
+    // full: also runs the slow reference implementations on the biggest inputs
+
+    std::string selected = (argc > 1) ? argv[1] : "all";
+    bool full = (argc > 2) && (std::string(argv[2]) == "full");
+
+    if ((selected == "all") || (selected == "vertex_welding"))
+        benchmarks::vertexWelding(full);
+
+    if ((selected == "all") || (selected == "xml_traversal"))
+        benchmarks::xmlTraversal();
+
+    if ((selected == "all") || (selected == "number_parsing"))
+        benchmarks::numberParsing();
+
+    return 0;
+}
@@ -0,0 +1,133 @@
+#include "benchmarks.h"
+#include "debug.h"
+#include "file_tools.h"
+
+#include <vector>
+#include <string>
+#include <cstdlib>
+#include <cstdio>
+
+using namespace undicht;
+using namespace tools;
+
+namespace benchmarks {
+
+    namespace {
+
+        /// the old extractFloatArray(): copies the string, strtof per number, no reserve
+        void extractFloatArrayReference(std::vector<float>& loadTo, std::string src) {
+
+            src.push_back('X'); // making sure the extracting stops there
+            char* reading_position = ((char*)src.data());
+            char* end_position = ((char*)src.data()) + src.size() - 1;
+
+            while (reading_position < end_position) {
+                loadTo.push_back(strtof(reading_position, &reading_position));
+                reading_position += 1;
+            }
+        }
+
+        /// the old extractIntArray()
+        void extractIntArrayReference(std::vector<int>& loadTo, std::string src) {
+
+            src.push_back('X');
+            char* reading_position = ((char*)src.data());
+            char* end_position = ((char*)src.data()) + src.size() - 1;
+
+            while (reading_position < end_position) {
+                loadTo.push_back(strtol(reading_position, &reading_position, 10));
+                reading_position += 1;
+            }
+        }
+
+        /// a collada float_array (positions / normals / uvs, 6 decimal places, single spaces)
+        std::string createFloatText(size_t count) {
+
+            std::string text;
+            text.reserve(count * 10);
+
+            char number[32];
+            unsigned int seed = 1;
+
+            for (size_t i = 0; i < count; i++) {
+                seed = seed * 1103515245u + 12345u;
+                float value = float(int(seed >> 8) % 2000000 - 1000000) / 100000.0f;
+                snprintf(number, sizeof(number), (i + 1 < count) ? "%.6f " : "%.6f", value);
+                text += number;
+            }
+
+            return text;
+        }
+
+        /// a collada <p> index list
+        std::string createIntText(size_t count) {
+
+            std::string text;
+            text.reserve(count * 7);
+
+            char number[32];
+            unsigned int seed = 1;
+
+            for (size_t i = 0; i < count; i++) {
+                seed = seed * 1103515245u + 12345u;
+                snprintf(number, sizeof(number), (i + 1 < count) ? "%u " : "%u", (seed >> 8) % 200000);
+                text += number;
+            }
+
+            return text;
+        }
+
+        /// @return the throughput in MB/s
+        double getMegabytesPerSecond(size_t byte_size, double milliseconds) {
+
+            return (double(byte_size) / (1024.0 * 1024.0)) / (milliseconds / 1000.0);
+        }
+
+    } // namespace
+
+    void numberParsing() {
+        /** extractFloatArray() / extractIntArray() against the strtof / strtol loops they replaced, in MB/s of text */
+
+        UND_LOG << "number parsing (extractFloatArray / extractIntArray)\n";
+
+        const size_t number_count = 4000000;
+        const int repeat_count = 5;
+
+        std::string float_text = createFloatText(number_count);
+        std::string int_text = createIntText(number_count);
+
+        std::vector<float> floats, reference_floats;
+        std::vector<int> ints, reference_ints;
+
+        double float_time = 0.0, reference_float_time = 0.0;
+        double int_time = 0.0, reference_int_time = 0.0;
+
+        for (int i = 0; i < repeat_count; i++) {
+
+            floats.clear();
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            extractFloatArray(floats, float_text);
+            float_time += getMillisecondsSince(start);
+
+            // the old functions didnt reserve, so they start from an empty vector
+            std::vector<float>().swap(reference_floats);
+            start = std::chrono::steady_clock::now();
+            extractFloatArrayReference(reference_floats, float_text);
+            reference_float_time += getMillisecondsSince(start);
+
+            ints.clear();
+            start = std::chrono::steady_clock::now();
+            extractIntArray(ints, int_text);
+            int_time += getMillisecondsSince(start);
+
+            std::vector<int>().swap(reference_ints);
+            start = std::chrono::steady_clock::now();
+            extractIntArrayReference(reference_ints, int_text);
+            reference_int_time += getMillisecondsSince(start);
+        }
+
+        UND_LOG << "    floats (" << float_text.size() / 1024 << " kb): " << getMegabytesPerSecond(float_text.size(), float_time / repeat_count) << " MB/s, strtof loop " << getMegabytesPerSecond(float_text.size(), reference_float_time / repeat_count) << " MB/s, same result: " << ((floats == reference_floats) ? "yes" : "NO") << "\n";
+        UND_LOG << "    ints (" << int_text.size() / 1024 << " kb): " << getMegabytesPerSecond(int_text.size(), int_time / repeat_count) << " MB/s, strtol loop " << getMegabytesPerSecond(int_text.size(), reference_int_time / repeat_count) << " MB/s, same result: " << ((ints == reference_ints) ? "yes" : "NO") << "\n";
+    }
+
+} // benchmarks
@@ -0,0 +1,141 @@
+#include "benchmarks.h"
+#include "debug.h"
+#include "model_loading/model_loader.h"
+
+#include <vector>
+#include <cmath>
+
+using namespace undicht;
+using namespace tools;
+
+namespace benchmarks {
+
+    namespace {
+
+        class WeldingLoader : public ModelLoader {
+            /// gives access to buildIndices() (the loading functions are not needed)
+        public:
+
+            int getMeshCount() { return 0; }
+            int getTextureCount() { return 0; }
+            void getMesh(MeshData&, unsigned int) {}
+            void getTexture(ImageData&, int) {}
+            void loadAllMeshes(std::vector<MeshData>&) {}
+            void loadAllTextures(std::vector<ImageData>&) {}
+
+            void weld(const std::vector<float>& vertices, const BufferLayout& vertex_layout, std::vector<float>& loadTo_vertices, std::vector<int>& loadTo_indices) {
+                buildIndices(vertices, vertex_layout, loadTo_vertices, loadTo_indices);
+            }
+        };
+
+        /// the implementation of ModelLoader::buildIndices() before the hash map was used
+        /// (every vertex gets compared with every unique vertex found so far)
+        void buildIndicesQuadratic(const std::vector<float>& vertices, const BufferLayout& vertex_layout, std::vector<float>& loadTo_vertices, std::vector<int>& loadTo_indices) {
+
+            int vertex_size = vertex_layout.getTotalSize() / sizeof(float);
+            int vertex_count = vertices.size() / vertex_size;
+
+            for (int vertex = 0; vertex < vertex_count; vertex++) {
+
+                int indexed_vertex;
+                bool vertices_are_equal = false;
+
+                for (indexed_vertex = 0; indexed_vertex < int(loadTo_vertices.size()) / vertex_size; indexed_vertex++) {
+
+                    vertices_are_equal = true;
+
+                    for (int f = 0; f < vertex_size; f++) {
+
+                        if (vertices[vertex * vertex_size + f] != loadTo_vertices[indexed_vertex * vertex_size + f]) {
+                            vertices_are_equal = false;
+                            break;
+                        }
+                    }
+
+                    if (vertices_are_equal) {
+                        loadTo_indices.push_back(indexed_vertex);
+                        break;
+                    }
+                }
+
+                if (!vertices_are_equal) {
+                    loadTo_indices.push_back(loadTo_vertices.size() / vertex_size);
+                    loadTo_vertices.insert(loadTo_vertices.end(), vertices.begin() + vertex * vertex_size, vertices.begin() + (vertex + 1) * vertex_size);
+                }
+            }
+
+        }
+
+        /// a wavy grid of quads stored as a triangle list (position, uv, normal), so most vertices are used by 6 triangles
+        /// @param grid_size: number of quads per side (6 * grid_size^2 vertices)
+        void createGridMesh(int grid_size, std::vector<float>& loadTo_vertices) {
+
+            loadTo_vertices.clear();
+            loadTo_vertices.reserve(size_t(grid_size) * grid_size * 6 * 8);
+
+            const int corners[6][2] = { {0, 0}, {1, 0}, {1, 1}, {1, 1}, {0, 1}, {0, 0} };
+
+            for (int x = 0; x < grid_size; x++) {
+                for (int y = 0; y < grid_size; y++) {
+                    for (int c = 0; c < 6; c++) {
+
+                        float u = float(x + corners[c][0]) / grid_size;
+                        float v = float(y + corners[c][1]) / grid_size;
+                        float height = 0.1f * std::sin(u * 20.0f) * std::cos(v * 20.0f);
+
+                        float vertex[8] = { u * 100.0f, height, v * 100.0f, u, v, 0.0f, 1.0f, 0.0f };
+                        loadTo_vertices.insert(loadTo_vertices.end(), vertex, vertex + 8);
+                    }
+                }
+            }
+
+        }
+
+    } // namespace
+
+    void vertexWelding(bool full) {
+        /** ModelLoader::buildIndices() (hash map) against the quadratic search it replaced, on synthetic meshes of up to a million vertices
+        * @param full: also run the quadratic search on the biggest mesh (takes minutes) */
+
+        UND_LOG << "vertex welding (ModelLoader::buildIndices)\n";
+
+        BufferLayout vertex_layout({ UND_VEC3F, UND_VEC2F, UND_VEC3F });
+        WeldingLoader loader;
+
+        // 6 * grid_size^2 vertices: ~10k, ~100k, ~1M
+        const int grid_sizes[] = { 41, 129, 408 };
+
+        for (int grid_size : grid_sizes) {
+
+            std::vector<float> vertices;
+            createGridMesh(grid_size, vertices);
+            size_t vertex_count = vertices.size() / 8;
+
+            std::vector<float> hashed_vertices;
+            std::vector<int> hashed_indices;
+
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            loader.weld(vertices, vertex_layout, hashed_vertices, hashed_indices);
+            double hashed_time = getMillisecondsSince(start);
+
+            UND_LOG << "    " << vertex_count << " vertices (" << hashed_vertices.size() / 8 << " unique): hash map " << hashed_time << " ms\n";
+
+            if ((grid_size == grid_sizes[2]) && !full) {
+                UND_LOG << "    (skipped the quadratic search, run with \"vertex_welding full\" to include it)\n";
+                continue;
+            }
+
+            std::vector<float> quadratic_vertices;
+            std::vector<int> quadratic_indices;
+
+            start = std::chrono::steady_clock::now();
+            buildIndicesQuadratic(vertices, vertex_layout, quadratic_vertices, quadratic_indices);
+            double quadratic_time = getMillisecondsSince(start);
+
+            bool identical = (hashed_vertices == quadratic_vertices) && (hashed_indices == quadratic_indices);
+            UND_LOG << "    " << vertex_count << " vertices: quadratic search " << quadratic_time << " ms (" << quadratic_time / hashed_time << "x), identical output: " << (identical ? "yes" : "NO") << "\n";
+        }
+
+    }
+
+} // benchmarks
@@ -0,0 +1,133 @@
+#include "benchmarks.h"
+#include "debug.h"
+#include "xml/xml_file.h"
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <cstdio>
+
+using namespace undicht;
+using namespace tools;
+
+namespace benchmarks {
+
+    namespace {
+
+        struct VectorTreeElement {
+            /// the layout of XmlElement before the arena was used
+            /// (each element stores its attributes and child elements in its own vectors)
+
+            XmlString m_tag_name;
+            std::vector<XmlTagAttrib> m_tag_attributes;
+            XmlString m_content;
+            std::vector<VectorTreeElement> m_child_elements;
+            VectorTreeElement* m_parent_element = 0;
+        };
+
+        /// copies the element tree into the vector layout (the same allocations the old parser made)
+        void buildVectorTree(const XmlElement& elem, VectorTreeElement& loadTo) {
+
+            loadTo.m_tag_name = elem.getName();
+            loadTo.m_content = elem.getContent();
+            loadTo.m_tag_attributes.assign(elem.getAttributes(), elem.getAttributes() + elem.getAttributeCount());
+
+            for (XmlElement* child = elem.getFirstChild(); child; child = child->getNextSibling()) {
+
+                loadTo.m_child_elements.emplace_back(VectorTreeElement());
+                buildVectorTree(*child, loadTo.m_child_elements.back());
+            }
+
+            // the children dont move anymore
+            for (VectorTreeElement& child : loadTo.m_child_elements)
+                child.m_parent_element = &loadTo;
+        }
+
+        /// the work done per element: counting the elements, their attributes + the elements with the name
+        void walk(const XmlElement& elem, size_t& element_count, size_t& attribute_count, size_t& named_count) {
+
+            element_count++;
+            attribute_count += elem.getAttributeCount();
+            named_count += (elem.getName() == "instance_material");
+
+            for (XmlElement* child = elem.getFirstChild(); child; child = child->getNextSibling())
+                walk(*child, element_count, attribute_count, named_count);
+        }
+
+        void walk(const VectorTreeElement& elem, size_t& element_count, size_t& attribute_count, size_t& named_count) {
+
+            element_count++;
+            attribute_count += elem.m_tag_attributes.size();
+            named_count += (elem.m_tag_name == "instance_material");
+
+            for (const VectorTreeElement& child : elem.m_child_elements)
+                walk(child, element_count, attribute_count, named_count);
+        }
+
+        /// writes a collada like scene (6 elements per node) to the file
+        void writeSceneFile(const std::string& file_name, int node_count) {
+
+            std::ofstream file(file_name, std::ios::binary | std::ios::trunc);
+
+            file << "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<COLLADA version=\"1.4.1\">\n<library_visual_scenes>\n<visual_scene id=\"scene\">\n";
+
+            for (int i = 0; i < node_count; i++) {
+                file << "<node id=\"node" << i << "\" name=\"node" << i << "\" type=\"NODE\">\n";
+                file << "  <matrix sid=\"transform\">1 0 0 " << i << " 0 1 0 0 0 0 1 0 0 0 0 1</matrix>\n";
+                file << "  <instance_geometry url=\"#geometry" << i % 100 << "\"><bind_material><technique_common>\n";
+                file << "    <instance_material symbol=\"material\" target=\"#material" << i % 20 << "\"/>\n";
+                file << "  </technique_common></bind_material></instance_geometry>\n</node>\n";
+            }
+
+            file << "</visual_scene>\n</library_visual_scenes>\n</COLLADA>\n";
+        }
+
+    } // namespace
+
+    void xmlTraversal() {
+        /** walking the arena element tree against the vector layout it replaced (a collada like file with ~240k elements) */
+
+        UND_LOG << "xml traversal (XmlArena)\n";
+
+        const std::string file_name = "xml_traversal_benchmark.xml";
+        const int walk_count = 20;
+        writeSceneFile(file_name, 40000);
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        XmlFile xml_file(file_name);
+        double parse_time = getMillisecondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        VectorTreeElement vector_tree;
+        buildVectorTree(xml_file, vector_tree);
+        double build_time = getMillisecondsSince(start);
+
+        size_t arena_elements = 0, arena_attributes = 0, arena_named = 0;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < walk_count; i++)
+            walk(xml_file, arena_elements, arena_attributes, arena_named);
+        double arena_walk_time = getMillisecondsSince(start) / walk_count;
+
+        size_t vector_elements = 0, vector_attributes = 0, vector_named = 0;
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < walk_count; i++)
+            walk(vector_tree, vector_elements, vector_attributes, vector_named);
+        double vector_walk_time = getMillisecondsSince(start) / walk_count;
+
+        // clearing the vector tree frees every element on its own, the arena is freed at once
+        start = std::chrono::steady_clock::now();
+        vector_tree.m_child_elements.clear();
+        double vector_free_time = getMillisecondsSince(start);
+
+        start = std::chrono::steady_clock::now();
+        xml_file.clear();
+        double arena_free_time = getMillisecondsSince(start);
+
+        std::remove(file_name.c_str());
+
+        UND_LOG << "    " << arena_elements / walk_count << " elements: parsing into the arena " << parse_time << " ms, copying into the vector layout " << build_time << " ms\n";
+        UND_LOG << "    walk: arena " << arena_walk_time << " ms, vector layout " << vector_walk_time << " ms, same result: " << ((arena_elements == vector_elements) && (arena_attributes == vector_attributes) && (arena_named == vector_named) ? "yes" : "NO") << "\n";
+        UND_LOG << "    free: arena " << arena_free_time << " ms, vector layout " << vector_free_time << " ms\n";
+    }
+
+} // benchmarks
@@ -2,7 +2,9 @@
 #include "undicht_graphics.h"
 #include "3D/camera/perspective_camera_3d.h"
 #include "model_loading/collada/collada_file.h"
+#include "model_loading/mesh_optimizer.h"
 #include "debug.h"
+#include "thread_pool.h"
 
 using namespace undicht;
 using namespace graphics;
@@ -27,24 +29,32 @@ int main() {
     std::vector<MeshData> meshes;
     std::vector<ImageData> images;
 
-    ColladaFile model_file(PROJECT_DIR + "res/sponza_collada/sponza.dae");
+    ThreadPool thread_pool;
+    MeshOptimizer mesh_optimizer;
+    ColladaFile model_file;
+    model_file.setThreadPool(&thread_pool);
+    model_file.setMeshOptimizer(&mesh_optimizer);
+    model_file.open(PROJECT_DIR + "res/sponza_collada/sponza.dae", true);
     model_file.loadAllMeshes(meshes);
     model_file.loadAllTextures(images);
 
     UND_LOG << "loaded " << meshes.size() << " meshes + " << images.size() << " textures\n";
 
     // loading the model to the gpu
-    std::vector<VertexBuffer*> vbos(meshes.size(), nullptr);
+    // (all meshes are stored in one vertex + index buffer)
+    GeometryPool geometry = gpu.create<GeometryPool>();
     std::vector<Texture*> textures(images.size(), nullptr);
 
-    for(int i = 0; i < meshes.size(); i++) {
-        MeshData& mesh = meshes.at(i);
-        vbos.at(i) = new VertexBuffer(gpu.create<VertexBuffer>());
-        vbos.at(i)->setVertexAttribute(0, UND_VEC3F); // position
-        vbos.at(i)->setVertexAttribute(1, UND_VEC2F); // uv
-        vbos.at(i)->setVertexAttribute(2, UND_VEC3F); // normal
-        vbos.at(i)->setVertexData(mesh.vertices);
-    }
+    geometry.setVertexAttribute(0, UND_VEC3F); // position
+    geometry.setVertexAttribute(1, UND_VEC2F); // uv
+    geometry.setVertexAttribute(2, UND_VEC3F); // normal
+
+    // the id of each mesh in the geometry pool (INVALID_MESH_ID if the mesh could not be added)
+    std::vector<uint32_t> mesh_ids;
+    for(MeshData& mesh : meshes)
+        mesh_ids.push_back(geometry.addMesh(mesh.vertices, mesh.indices));
+
+    geometry.upload(); // the indices are stored as 16 bit indices, if possible
 
     for(int i = 0; i < images.size(); i++) {
         ImageData& image = images.at(i);
@@ -64,6 +74,8 @@ int main() {
     }
 
     UND_LOG << "finished transferring the model to the gpu\n";
+    UND_LOG << "vram: " << gpu.getVramAllocator()->info() << "\n";
+    UND_LOG << "staging: peak usage " << gpu.getUploadManager()->getPeakStagingUsage() / 1024 << " of " << gpu.getUploadManager()->getStagingSize() / 1024 << " kb, " << gpu.getUploadManager()->getStagingStalls() << " stalls\n";
 
     // setting up a 3D renderer
     Shader shader = gpu.create<Shader>();
@@ -72,7 +84,7 @@ int main() {
     shader.linkStages();
 
     Renderer renderer = gpu.create<Renderer>();
-    renderer.setVertexBufferLayout(*vbos.at(0));
+    renderer.setVertexBufferLayout(geometry.getVertexBuffer());
     renderer.setShader(&shader);
     renderer.setShaderInput(1, 1);
     renderer.setFramebufferLayout(swap_chain.getVisibleFramebuffer());
@@ -101,13 +113,24 @@ int main() {
         uniforms.setData(0, glm::value_ptr(cam.getCameraProjectionMatrix()), 16 * sizeof(float));
         uniforms.setData(1, glm::value_ptr(cam.getViewMatrix()), 16 * sizeof(float));
 
-        // drawing
-        renderer.beginRenderPass(&swap_chain.getVisibleFramebuffer());
-        for(int i = 0; i < meshes.size(); i++) {
-            renderer.submit(textures.at(meshes.at(i).color_texture), 1);
-            renderer.submit(&uniforms, 0);
-            renderer.draw(vbos.at(i));
-        }
+        // drawing (the meshes are split among the recorders, each one is filled by a different thread)
+        uint32_t recorder_count = thread_pool.getThreadCount() + 1;
+        renderer.beginRenderPass(&swap_chain.getVisibleFramebuffer(), recorder_count);
+        thread_pool.parallelFor(recorder_count, [&](size_t recorder_id) {
+
+            DrawRecorder* recorder = renderer.getRecorder(recorder_id);
+            recorder->submit(&uniforms, 0);
+
+            for(size_t i = meshes.size() * recorder_id / recorder_count; i < meshes.size() * (recorder_id + 1) / recorder_count; i++) {
+
+                if(mesh_ids.at(i) == GeometryPool::INVALID_MESH_ID)
+                    continue; // the mesh was not added to the pool
+
+                recorder->submit(textures.at(meshes.at(i).color_texture), 1);
+                recorder->draw(&geometry, mesh_ids.at(i));
+            }
+
+        });
         renderer.endRenderPass();
 
         swap_chain.presentImage();
@@ -118,8 +141,7 @@ int main() {
 
     gpu.waitForProcessesToFinish();
 
-    for(VertexBuffer* vbo : vbos)
-        delete vbo;
+    UND_LOG << "renderer: peak " << renderer.getPeakDrawCalls() << " draw calls, " << renderer.getPeakDescriptorSets() << " descriptor sets per frame\n";
 
     for(Texture* texture : textures)
         delete texture;
@@ -0,0 +1,164 @@
+#include "debug.h"
+#include "undicht_graphics.h"
+#include "core/vulkan/vram_allocator.h"
+
+#include "vulkan/vulkan.hpp"
+
+using namespace undicht;
+using namespace graphics;
+
+// checks the sub allocation paths of the VramAllocator (free list, best fit split, merge on free, dedicated blocks)
+// returns 1 if a check failed, so it can be used as a test
+// runs on a software vulkan driver as well, i.e.:
+// VK_ICD_FILENAMES=/usr/share/vulkan/icd.d/lvp_icd.x86_64.json xvfb-run ./vram_allocator
+
+const uint64_t KB = 1024;
+
+int failed_checks = 0;
+
+void check(bool condition, const char* description) {
+
+    if(!condition) {
+        UND_ERROR << "check failed: " << description << "\n";
+        failed_checks++;
+    }
+
+}
+
+bool hasFreeRanges(const VramBlock& block, const std::vector<VramRange>& ranges) {
+
+    if(block.m_free_ranges.size() != ranges.size())
+        return false;
+
+    for(size_t i = 0; i < ranges.size(); i++)
+        if((block.m_free_ranges.at(i).offset != ranges.at(i).offset) || (block.m_free_ranges.at(i).size != ranges.at(i).size))
+            return false;
+
+    return true;
+}
+
+void testBlock() {
+    // the free list of a single block (no vulkan calls)
+
+    VramBlock block(1024);
+    uint64_t a, b, c, d, e;
+
+    check(block.allocate(100, 1, a) && block.allocate(200, 1, b) && block.allocate(300, 1, c), "block: allocating from an empty block");
+    check((a == 0) && (b == 100) && (c == 300), "block: allocations are placed one after the other");
+    check(hasFreeRanges(block, {{600, 424}}), "block: the rest of the block is one free range");
+
+    // best fit: the hole left by b is smaller than the end of the block
+    block.free(b, 200);
+    check(hasFreeRanges(block, {{100, 200}, {600, 424}}), "block: freeing creates a hole");
+    check(block.allocate(150, 1, d) && (d == 100), "block: best fit takes the smaller free range");
+    check(hasFreeRanges(block, {{250, 50}, {600, 424}}), "block: the free range is split");
+
+    // the padding in front of an aligned allocation stays free
+    check(block.allocate(10, 64, e) && (e == 256), "block: aligned allocation");
+    check(hasFreeRanges(block, {{250, 6}, {266, 34}, {600, 424}}), "block: the padding before the allocation stays free");
+    check(!block.allocate(500, 1, b), "block: allocation bigger than every free range fails");
+
+    // merging with the previous + next free ranges
+    block.free(e, 10);
+    check(hasFreeRanges(block, {{250, 50}, {600, 424}}), "block: merging with both neighbours");
+    block.free(d, 150);
+    block.free(a, 100);
+    check(hasFreeRanges(block, {{0, 300}, {600, 424}}), "block: merging with the next range");
+    block.free(c, 300);
+    check(hasFreeRanges(block, {{0, 1024}}), "block: the whole block is free again");
+    check(!block.m_used && !block.m_allocation_count, "block: nothing used after freeing everything");
+}
+
+void testAllocator(const GraphicsDevice& gpu) {
+    // a separate allocator with small blocks (the allocator of the device is already used by the device itself)
+
+    VramAllocator allocator(&gpu);
+    allocator.setBlockSize(1024 * KB);
+
+    // using the first memory type the device has
+    vk::MemoryPropertyFlags properties = gpu.m_physical_device->getMemoryProperties().memoryTypes[0].propertyFlags;
+    vk::MemoryRequirements requirements(0, 256, 1);
+
+    // sub allocations from one block
+    requirements.size = 256 * KB;
+    VramAllocation a = allocator.allocate(requirements, properties);
+    VramAllocation b = allocator.allocate(requirements, properties);
+    requirements.size = 384 * KB;
+    VramAllocation c = allocator.allocate(requirements, properties);
+
+    check(allocator.getBlockCount() == 1, "allocator: the allocations share one block");
+    check((a.block == b.block) && (b.block == c.block) && !a.block->m_dedicated, "allocator: sub allocations are not dedicated");
+    check((a.memory == b.memory) && (a.offset == 0) && (b.offset == 256 * KB) && (c.offset == 512 * KB), "allocator: sub allocations are placed one after the other");
+
+    // best fit split: the free end of the block (128 kb) is smaller than the hole left by b (256 kb)
+    VramBlock* block = a.block;
+    allocator.free(b);
+    check(!b.block && (allocator.getFreeCount() == 1), "allocator: freeing resets the allocation");
+    check(allocator.getFragmentation() > 0.0f, "allocator: the free memory is split");
+
+    requirements.size = 100 * KB;
+    VramAllocation d = allocator.allocate(requirements, properties);
+    requirements.size = 200 * KB;
+    VramAllocation e = allocator.allocate(requirements, properties);
+
+    check((d.block == block) && (d.offset == 896 * KB), "allocator: best fit takes the end of the block");
+    check((e.block == block) && (e.offset == 256 * KB), "allocator: best fit takes the hole");
+    check(hasFreeRanges(*block, {{456 * KB, 56 * KB}, {996 * KB, 28 * KB}}), "allocator: the free ranges are split");
+    check(allocator.getUsedSize() == 940 * KB, "allocator: used size");
+
+    // a full block: a new block is allocated
+    requirements.size = 128 * KB;
+    VramAllocation f = allocator.allocate(requirements, properties);
+    check((f.block != block) && !f.block->m_dedicated && (allocator.getBlockCount() == 2), "allocator: a new block when the first one is full");
+
+    // dedicated blocks for allocations bigger than half the block size
+    requirements.size = 768 * KB;
+    VramAllocation g = allocator.allocate(requirements, properties);
+    check(g.block && g.block->m_dedicated && (g.block->m_size == 768 * KB) && (g.offset == 0), "allocator: big allocation gets a dedicated block");
+    check(allocator.getBlockCount() == 3, "allocator: the dedicated block is counted");
+    allocator.free(g);
+    check(allocator.getBlockCount() == 2, "allocator: the dedicated block is freed with its allocation");
+
+    // merge on free
+    allocator.free(a);
+    allocator.free(c);
+    allocator.free(d);
+    allocator.free(e);
+    check(hasFreeRanges(*block, {{0, 1024 * KB}}), "allocator: the free ranges are merged");
+    check(allocator.getBlockCount() == 2, "allocator: an empty block is kept");
+
+    // only one empty block is kept
+    allocator.free(f);
+    check(allocator.getBlockCount() == 1, "allocator: the second empty block is freed");
+    check(!allocator.getAllocationCount() && !allocator.getUsedSize(), "allocator: nothing used after freeing everything");
+    check(allocator.getFragmentation() == 0.0f, "allocator: the free memory is in one piece");
+
+    UND_LOG << "vram allocator: " << allocator.info() << "\n";
+}
+
+int main() {
+
+    testBlock();
+
+    // the allocator needs a device
+    WindowAPI window_api;
+    Window window("Vram Allocator Test", 100, 100);
+    GraphicsAPI graphics_api;
+    GraphicsSurface canvas = graphics_api.createGraphicsSurface(window);
+    GraphicsDevice gpu = graphics_api.getGraphicsDevice(canvas);
+
+    UND_LOG << "using gpu: " << gpu.info() << "\n";
+
+    testAllocator(gpu);
+
+    gpu.waitForProcessesToFinish();
+
+    if(failed_checks) {
+        UND_ERROR << failed_checks << " checks failed\n";
+        return 1;
+    }
+
+    UND_LOG << "all checks passed\n";
+
+    return 0;
+}
@@ -0,0 +1,48 @@
+#include "destroyed_handles.h"
+
+namespace undicht {
+
+    namespace graphics {
+
+        void DestroyedHandles::add(uint64_t handle) {
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            m_handles.push_back(handle);
+            m_count++;
+
+            if(m_handles.size() > m_max_size)
+                m_handles.pop_front();
+
+        }
+
+        bool DestroyedHandles::getDestroyedSince(uint64_t& checked_count, std::vector<uint64_t>& loadTo) const {
+            /** adds the handles destroyed since the last check to loadTo
+            * @param checked_count: getCount() at the last check, gets set to the current count
+            * @return false, if some of them were forgotten already (then every handle has to be considered outdated) */
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            uint64_t first_known = m_count - m_handles.size();
+
+            bool complete = checked_count >= first_known;
+
+            if(complete)
+                loadTo.insert(loadTo.end(), m_handles.begin() + (checked_count - first_known), m_handles.end());
+
+            checked_count = m_count;
+
+            return complete;
+        }
+
+        uint64_t DestroyedHandles::getCount() const {
+            /** @return the number of handles destroyed so far */
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            return m_count;
+        }
+
+    } // graphics
+
+} // undicht
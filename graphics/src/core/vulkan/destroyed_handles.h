@@ -0,0 +1,46 @@
+#ifndef DESTROYED_HANDLES_H
+#define DESTROYED_HANDLES_H
+
+#include "deque"
+#include "vector"
+#include "mutex"
+#include "cstdint"
+
+namespace undicht {
+
+    namespace graphics {
+
+        class DestroyedHandles {
+            /** remembers the vulkan handles of the last destroyed buffers + image views
+            * so that objects referencing them (i.e. cached descriptor sets) can be updated
+            * (a new buffer / image view might get the handle of a destroyed one)
+            * the readers check which handles were destroyed since they last checked
+            * can be used by multiple threads at the same time */
+
+        protected:
+
+            std::deque<uint64_t> m_handles; // the most recently destroyed handles (oldest first)
+            uint64_t m_count = 0; // the number of handles destroyed so far
+            uint32_t m_max_size = 4096; // older handles are forgotten
+
+            mutable std::mutex m_mutex;
+
+        public:
+
+            void add(uint64_t handle);
+
+            /** adds the handles destroyed since the last check to loadTo
+            * @param checked_count: getCount() at the last check, gets set to the current count
+            * @return false, if some of them were forgotten already (then every handle has to be considered outdated) */
+            bool getDestroyedSince(uint64_t& checked_count, std::vector<uint64_t>& loadTo) const;
+
+            /** @return the number of handles destroyed so far */
+            uint64_t getCount() const;
+
+        };
+
+    } // graphics
+
+} // undicht
+
+#endif // DESTROYED_HANDLES_H
@@ -31,7 +31,8 @@ namespace undicht {
             const char* layers = "VK_LAYER_KHRONOS_validation";
 
             // instance create structs
-            vk::ApplicationInfo app_info("undicht");
+            // vulkan 1.2 is needed to check for optional features (such as descriptor indexing)
+            vk::ApplicationInfo app_info("undicht", 0, nullptr, 0, VK_API_VERSION_1_2);
             vk::InstanceCreateInfo create_info({}, &app_info, layer_count, &layers, ext_count, extns);
 
             // creating the instance
@@ -2,6 +2,7 @@
 
 #include <set>
 #include <vector>
+#include <algorithm>
 
 #include "vulkan/vulkan.hpp"
 
@@ -20,6 +21,7 @@ namespace undicht {
             m_graphics_queue = new vk::Queue;
             m_present_queue = new vk::Queue;
             m_transfer_queue = new vk::Queue;
+            m_queue_mutex = new std::mutex;
 
 			m_graphics_queue_id = queue_families.graphics_queue;
             m_present_queue_id = queue_families.present_queue;
@@ -29,10 +31,19 @@ namespace undicht {
             m_transfer_command_pool = new vk::CommandPool;
 
             initLogicalDevice(extensions);
+
+            m_destroyed_handles = new DestroyedHandles;
+            m_vram_allocator = new VramAllocator(this);
+            m_upload_manager = new UploadManager(this);
 		}
 
         GraphicsDevice::~GraphicsDevice() {
 
+            // all buffers + textures should have been destroyed by now
+            delete m_upload_manager; // may still free buffers that were waiting for their transfers
+            delete m_vram_allocator;
+            delete m_destroyed_handles;
+
             m_device->destroyCommandPool(*m_graphics_command_pool);
             m_device->destroyCommandPool(*m_transfer_command_pool);
 
@@ -42,6 +53,7 @@ namespace undicht {
             delete m_graphics_queue;
             delete m_present_queue;
             delete m_transfer_queue;
+            delete m_queue_mutex;
 
             m_device->destroy();
             delete m_device;
@@ -67,6 +79,7 @@ namespace undicht {
         uint32_t GraphicsDevice::beginFrame() {
 
             m_current_frame = (m_current_frame + 1) % m_max_frames_in_flight;
+            m_frame_count++;
 
             return m_current_frame;
         }
@@ -80,6 +93,11 @@ namespace undicht {
             return m_current_frame;
         }
 
+        uint64_t GraphicsDevice::getFrameCount() const {
+
+            return m_frame_count;
+        }
+
         std::string GraphicsDevice::info() const {
 
             vk::PhysicalDeviceProperties properties;
@@ -91,6 +109,7 @@ namespace undicht {
         void GraphicsDevice::waitForProcessesToFinish() {
 
             // waiting for all processes to stop
+            std::lock_guard<std::mutex> lock(*m_queue_mutex);
             m_device->waitIdle();
 
         }
@@ -100,9 +119,14 @@ namespace undicht {
         void GraphicsDevice::initLogicalDevice(const std::vector<const char*>& extensions) {
 
             std::vector<vk::DeviceQueueCreateInfo> queue_infos = getQueueCreateInfos();
+            // (the indexing features first, they decide which of the other features are needed)
+            vk::PhysicalDeviceDescriptorIndexingFeatures indexing_features = getDescriptorIndexingFeatures();
             vk::PhysicalDeviceFeatures features = getDeviceFeatures();
             vk::DeviceCreateInfo info = getDeviceCreateInfo(&queue_infos, &extensions, &features);
 
+            if(m_bindless_textures_supported)
+                info.pNext = &indexing_features;
+
             // creating the logical device
             *m_device = m_physical_device->createDevice(info);
 
@@ -130,9 +154,53 @@ namespace undicht {
             vk::PhysicalDeviceFeatures features;
             features.samplerAnisotropy = VK_TRUE;
 
+            // the texture array is indexed with the texture id (not a constant)
+            if(m_bindless_textures_supported)
+                features.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
+
             return features;
         }
 
+        vk::PhysicalDeviceDescriptorIndexingFeatures GraphicsDevice::getDescriptorIndexingFeatures() {
+            // descriptor indexing is needed for bindless textures
+            // (optional, only enabled if the device supports vulkan 1.2)
+
+            vk::PhysicalDeviceDescriptorIndexingFeatures enabled;
+
+            vk::PhysicalDeviceProperties properties = m_physical_device->getProperties();
+            if(properties.apiVersion < VK_API_VERSION_1_2)
+                return enabled;
+
+            vk::PhysicalDeviceDescriptorIndexingFeatures supported;
+            vk::PhysicalDeviceFeatures2 features;
+            features.pNext = &supported;
+            m_physical_device->getFeatures2(&features);
+
+            // textures can be added to the array while it is used by frames in flight
+            if(!supported.descriptorBindingPartiallyBound || !supported.descriptorBindingSampledImageUpdateAfterBind || !supported.descriptorBindingUpdateUnusedWhilePending)
+                return enabled;
+
+            // the shaders index the array with the texture id (passed as gl_InstanceIndex)
+            if(!features.features.shaderSampledImageArrayDynamicIndexing)
+                return enabled;
+
+            enabled.descriptorBindingPartiallyBound = VK_TRUE;
+            enabled.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+            enabled.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+
+            // the max size of the texture array
+            vk::PhysicalDeviceDescriptorIndexingProperties indexing_properties;
+            vk::PhysicalDeviceProperties2 properties2;
+            properties2.pNext = &indexing_properties;
+            m_physical_device->getProperties2(&properties2);
+
+            m_max_bindless_textures = std::min(indexing_properties.maxPerStageDescriptorUpdateAfterBindSampledImages, indexing_properties.maxPerStageDescriptorUpdateAfterBindSamplers);
+            m_max_bindless_textures = std::min(m_max_bindless_textures, indexing_properties.maxDescriptorSetUpdateAfterBindSampledImages);
+            m_bindless_textures_supported = true;
+
+            return enabled;
+        }
+
         vk::DeviceCreateInfo GraphicsDevice::getDeviceCreateInfo(std::vector<vk::DeviceQueueCreateInfo>* queue_infos, const std::vector<const char*>* extensions, vk::PhysicalDeviceFeatures* features) {
 
             vk::DeviceCreateInfo info;
@@ -214,8 +282,12 @@ namespace undicht {
             // ending & submitting the command buffer
             cmd_buffer.end();
             vk::SubmitInfo submit_info({},{},cmd_buffer, {});
-            queue.submit(submit_info);
-            queue.waitIdle();
+
+            {
+                std::lock_guard<std::mutex> lock(*m_queue_mutex);
+                queue.submit(submit_info);
+                queue.waitIdle();
+            }
 
             m_device->freeCommandBuffers(cmd_pool, cmd_buffer);
 
@@ -229,6 +301,50 @@ namespace undicht {
             return properties.limits.maxSamplerAnisotropy;
         }
 
+        uint32_t GraphicsDevice::getMinUniformBufferOffsetAlignment() const {
+            // dynamic offsets into uniform buffers have to be a multiple of this
+
+            vk::PhysicalDeviceProperties properties;
+            properties = m_physical_device->getProperties();
+
+            return std::max(properties.limits.minUniformBufferOffsetAlignment, vk::DeviceSize(1));
+        }
+
+        uint32_t GraphicsDevice::getMaxPushConstantSize() const {
+            // in bytes (at least 128)
+
+            vk::PhysicalDeviceProperties properties;
+            properties = m_physical_device->getProperties();
+
+            return properties.limits.maxPushConstantsSize;
+        }
+
+        bool GraphicsDevice::supportsBindlessTextures() const {
+            // whether the device supports big arrays of textures that are all bound at once
+
+            return m_bindless_textures_supported;
+        }
+
+        uint32_t GraphicsDevice::getMaxBindlessTextures() const {
+
+            return m_max_bindless_textures;
+        }
+
+        VramAllocator* GraphicsDevice::getVramAllocator() const {
+
+            return m_vram_allocator;
+        }
+
+        UploadManager* GraphicsDevice::getUploadManager() const {
+
+            return m_upload_manager;
+        }
+
+        DestroyedHandles* GraphicsDevice::getDestroyedHandles() const {
+
+            return m_destroyed_handles;
+        }
+
     }
 
 } // namespace undicht
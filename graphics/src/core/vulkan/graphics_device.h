@@ -4,13 +4,19 @@
 #include "string"
 #include "vector"
 #include "set"
+#include "mutex"
 
 #include "vulkan_declaration.h"
+#include "vram_allocator.h"
+#include "upload_manager.h"
+#include "destroyed_handles.h"
 
 #include "graphics_pipeline/vulkan/shader.h"
 #include "graphics_pipeline/vulkan/renderer.h"
 #include "graphics_pipeline/vulkan/vertex_buffer.h"
+#include "graphics_pipeline/vulkan/geometry_pool.h"
 #include "graphics_pipeline/vulkan/uniform_buffer.h"
+#include "graphics_pipeline/vulkan/dynamic_uniform_buffer.h"
 #include "graphics_pipeline/vulkan/texture.h"
 
 namespace undicht {
@@ -43,6 +49,7 @@ namespace undicht {
             // max frames in flight
             uint32_t m_max_frames_in_flight = 2;
             uint32_t m_current_frame = 0;
+            uint64_t m_frame_count = 0; // the number of frames that were started
 
             // queues
             float m_queue_priority = 1.0f;
@@ -55,10 +62,27 @@ namespace undicht {
 
 			std::set<uint32_t> m_unique_queue_family_ids;
 
+            // submitting to / presenting on a queue has to be externally synchronized
+            // (taken by every submit + present, they can happen from multiple threads)
+            std::mutex* m_queue_mutex = 0;
+
             // command pools
             vk::CommandPool* m_graphics_command_pool = 0; // commands for the graphics queue
             vk::CommandPool* m_transfer_command_pool = 0; // commands for the transfer queue
 
+            // optional features
+            bool m_bindless_textures_supported = false; // descriptor indexing
+            uint32_t m_max_bindless_textures = 0;
+
+            // the memory of buffers + textures is sub allocated from bigger blocks
+            VramAllocator* m_vram_allocator = 0;
+
+            // transfer commands get recorded + submitted in batches
+            UploadManager* m_upload_manager = 0;
+
+            // buffers + image views that were destroyed (descriptor sets referencing them are outdated)
+            DestroyedHandles* m_destroyed_handles = 0;
+
             // only the graphics api can create GraphicsDevice objects
             GraphicsDevice(vk::PhysicalDevice device, vk::SurfaceKHR* surface, QueueFamilyIDs queue_families, const std::vector<const char*>& extensions);
             ~GraphicsDevice();
@@ -74,6 +98,7 @@ namespace undicht {
             void endFrame();
 
             uint32_t getCurrentFrameID() const;
+            uint64_t getFrameCount() const;
 
             std::string info() const;
             void waitForProcessesToFinish();
@@ -85,6 +110,7 @@ namespace undicht {
 
             std::vector<vk::DeviceQueueCreateInfo> getQueueCreateInfos();
             vk::PhysicalDeviceFeatures getDeviceFeatures();
+            vk::PhysicalDeviceDescriptorIndexingFeatures getDescriptorIndexingFeatures();
             vk::DeviceCreateInfo getDeviceCreateInfo(std::vector<vk::DeviceQueueCreateInfo>* queue_infos, const std::vector<const char*>* extensions, vk::PhysicalDeviceFeatures* features);
 
             void initQueueHandles();
@@ -100,6 +126,16 @@ namespace undicht {
             void endSingleTimeCommand(vk::CommandBuffer cmd_buffer, vk::CommandPool cmd_pool, vk::Queue queue) const;
 
             uint32_t getAnisotropyLimit() const;
+            uint32_t getMinUniformBufferOffsetAlignment() const;
+            uint32_t getMaxPushConstantSize() const;
+
+            // whether the device supports big arrays of textures that are all bound at once
+            bool supportsBindlessTextures() const;
+            uint32_t getMaxBindlessTextures() const;
+
+            VramAllocator* getVramAllocator() const;
+            UploadManager* getUploadManager() const;
+            DestroyedHandles* getDestroyedHandles() const;
 
         public:
             // creating objects on the gpu
@@ -317,6 +317,7 @@ namespace undicht {
 			vk::PresentInfoKHR present_info(wait_signals, swap_chains, image_indices);
 
             try {
+                std::lock_guard<std::mutex> lock(*m_device_handle->m_queue_mutex);
                 m_device_handle->m_present_queue->presentKHR(present_info);
             } catch(const vk::OutOfDateKHRError& error) {
                 // most likely the window was resized
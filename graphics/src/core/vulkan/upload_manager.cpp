@@ -0,0 +1,522 @@
+#include "upload_manager.h"
+
+#include "vulkan/vulkan.hpp"
+
+#include "debug.h"
+#include "core/vulkan/graphics_device.h"
+#include "graphics_pipeline/vulkan/vram_buffer.h"
+
+namespace undicht {
+
+    namespace graphics {
+
+        struct UploadBatch {
+            /// commands that get submitted together
+
+            vk::CommandBuffer cmd;
+            vk::Fence fence; // signaled once the commands have finished
+
+            UploadTicket ticket = 0;
+            uint32_t command_count = 0;
+
+            // buffers that get destroyed once the batch has finished
+            std::vector<std::pair<vk::Buffer, VramAllocation>> released_buffers;
+        };
+
+        // the default size of the staging ring
+        const uint64_t STAGING_RING_SIZE = 32 * 1024 * 1024;
+
+        static void recordTransferBarrier(vk::CommandBuffer& cmd) {
+            // transfers that use the same buffer + were recorded into the same batch have to wait for each other
+
+            vk::MemoryBarrier barrier(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eTransferRead | vk::AccessFlagBits::eTransferWrite);
+            cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer, {}, barrier, {}, {});
+        }
+
+        ///////////////////////////////////////////////// StagingRing /////////////////////////////////////////////////
+
+        StagingRing::StagingRing(uint64_t size) {
+
+            m_size = size;
+        }
+
+        bool StagingRing::allocate(uint64_t byte_size, uint64_t alignment, UploadTicket ticket, uint64_t& offset) {
+            /** @return false if there is not enough continuous space left until older regions get freed */
+
+            if(!alignment)
+                alignment = 1;
+
+            if(!m_used)
+                m_head = m_tail = 0; // starting at the beginning of the empty ring
+
+            uint64_t aligned_head = (m_head + alignment - 1) / alignment * alignment;
+            bool wrapped = m_used && (m_head <= m_tail); // the free space is between the head and the tail
+
+            if(wrapped) {
+
+                if(aligned_head + byte_size > m_tail)
+                    return false;
+
+                offset = aligned_head;
+            } else if(aligned_head + byte_size <= m_size) {
+                // fits between the head and the end of the ring
+                offset = aligned_head;
+            } else if(byte_size <= m_tail) {
+                // wrapping around, the rest of the ring stays unused until the region is freed
+                offset = 0;
+            } else {
+                return false;
+            }
+
+            uint64_t region_size = (offset >= m_head) ? (offset + byte_size - m_head) : (m_size - m_head + offset + byte_size);
+
+            // regions of the same ticket get merged
+            if(m_regions.size() && (m_regions.back().ticket == ticket)) {
+                m_regions.back().end = offset + byte_size;
+                m_regions.back().size += region_size;
+            } else {
+                m_regions.push_back({offset + byte_size, region_size, ticket});
+            }
+
+            m_head = offset + byte_size;
+            m_used += region_size;
+
+            return true;
+        }
+
+        void StagingRing::free(UploadTicket finished_ticket) {
+            /** gives back the regions of all tickets up to the finished one */
+
+            while(m_regions.size() && (m_regions.front().ticket <= finished_ticket)) {
+
+                m_tail = m_regions.front().end;
+                m_used -= m_regions.front().size;
+                m_regions.pop_front();
+            }
+
+        }
+
+        UploadTicket StagingRing::getOldestTicket() const {
+
+            return m_regions.size() ? m_regions.front().ticket : 0;
+        }
+
+        //////////////////////////////////////////////// UploadManager ////////////////////////////////////////////////
+
+        UploadManager::UploadManager(const GraphicsDevice* device) {
+
+            m_device_handle = device;
+
+            // the command buffers of finished batches get reset + reused
+            vk::CommandPoolCreateInfo cmd_pool_info;
+            cmd_pool_info.setFlags(vk::CommandPoolCreateFlagBits::eResetCommandBuffer);
+            cmd_pool_info.setQueueFamilyIndex(m_device_handle->m_graphics_queue_id);
+
+            m_cmd_pool = new vk::CommandPool;
+            *m_cmd_pool = m_device_handle->m_device->createCommandPool(cmd_pool_info);
+
+            m_staging_buffer = new vk::Buffer;
+            initStagingBuffer(STAGING_RING_SIZE);
+        }
+
+        UploadManager::~UploadManager() {
+
+            cleanUp();
+
+            delete m_cmd_pool;
+            delete m_staging_buffer;
+        }
+
+        void UploadManager::cleanUp() {
+
+            waitForAll();
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if(m_recording) { // a batch without commands
+                m_recording->cmd.end();
+                m_free_batches.push_back(m_recording);
+                m_recording = 0;
+            }
+
+            for(UploadBatch* batch : m_free_batches)
+                destroyBatch(batch);
+
+            m_free_batches.clear();
+
+            destroyStagingBuffer();
+            m_device_handle->m_device->destroyCommandPool(*m_cmd_pool);
+        }
+
+        void UploadManager::setMaxBatchSize(uint32_t command_count) {
+            /** the number of commands after which a batch gets submitted */
+
+            m_max_batch_size = std::max(command_count, 1u);
+        }
+
+        void UploadManager::setStagingSize(uint64_t byte_size) {
+            /** recreates the staging ring with the size (waits for all uploads to finish) */
+
+            waitForAll();
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            destroyStagingBuffer();
+            initStagingBuffer(byte_size);
+        }
+
+        //////////////////////////////////////////////// recording commands ////////////////////////////////////////////////
+
+        UploadTicket UploadManager::copyBuffer(const VramBuffer& src, const VramBuffer& dst, uint64_t byte_size, uint64_t src_offset, uint64_t dst_offset) {
+            /** records a copy between two buffers (the buffers have to exist until the copy has finished) */
+
+            vk::BufferCopy copy_info(src_offset, dst_offset, byte_size);
+
+            return record([&](vk::CommandBuffer& cmd) {
+
+                // (checked while recording, an other thread could submit the batch before the mutex is locked)
+                if((src.m_last_upload == m_recording->ticket) || (dst.m_last_upload == m_recording->ticket))
+                    recordTransferBarrier(cmd);
+
+                cmd.copyBuffer(*src.m_buffer, *dst.m_buffer, copy_info);
+            });
+        }
+
+        UploadTicket UploadManager::uploadBuffer(const void* data, uint64_t byte_size, const VramBuffer& dst, uint64_t dst_offset) {
+            /** copies the data into the staging ring and records a copy from there into the buffer */
+
+            return upload(data, byte_size, 16, [&](vk::CommandBuffer& cmd, const vk::Buffer& staging_buffer, uint64_t staging_offset) {
+
+                // (checked while recording, an other thread could submit the batch before the mutex is locked)
+                if(dst.m_last_upload == m_recording->ticket)
+                    recordTransferBarrier(cmd);
+
+                cmd.copyBuffer(staging_buffer, *dst.m_buffer, vk::BufferCopy(staging_offset, dst_offset, byte_size));
+            });
+        }
+
+        UploadTicket UploadManager::upload(const void* data, uint64_t byte_size, uint64_t alignment, const std::function<void(vk::CommandBuffer& cmd, const vk::Buffer& staging_buffer, uint64_t staging_offset)>& commands) {
+            /** copies the data into the staging ring and records the commands, which should read the data from the staging buffer
+            * @param alignment: of the data in the staging buffer */
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            // giving back the staging memory of finished batches
+            retireFinishedBatches(false, 0);
+
+            UploadBatch* batch = beginBatch();
+            vk::Buffer staging_buffer = *m_staging_buffer;
+            VramAllocation staging_memory = m_staging_memory;
+            uint64_t staging_offset = 0;
+
+            if(byte_size > m_staging_ring.m_size) {
+                // the upload gets its own staging buffer, which is destroyed once the batch has finished
+                m_oversized_uploads++;
+
+                vk::BufferCreateInfo buffer_info({}, byte_size, vk::BufferUsageFlagBits::eTransferSrc, vk::SharingMode::eExclusive);
+                staging_buffer = m_device_handle->m_device->createBuffer(buffer_info);
+
+                vk::MemoryRequirements requirements = m_device_handle->m_device->getBufferMemoryRequirements(staging_buffer);
+                staging_memory = m_device_handle->getVramAllocator()->allocate(requirements, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+                m_device_handle->m_device->bindBufferMemory(staging_buffer, *staging_memory.memory, staging_memory.offset);
+
+                batch->released_buffers.push_back({staging_buffer, staging_memory});
+            } else {
+
+                while(!m_staging_ring.allocate(byte_size, alignment, batch->ticket, staging_offset)) {
+                    // the uploads outrun the gpu, waiting for the oldest staging memory to be freed
+                    m_staging_stalls++;
+
+                    if(batch->command_count)
+                        submitBatch(batch);
+
+                    retireFinishedBatches(true, m_staging_ring.getOldestTicket());
+                    batch = beginBatch();
+                }
+
+                m_staging_peak = std::max(m_staging_peak, m_staging_ring.m_used);
+            }
+
+            // storing the data in the staging memory
+            std::memcpy(staging_memory.mapped + staging_offset, data, byte_size);
+            m_device_handle->getVramAllocator()->flush(staging_memory, staging_offset, byte_size);
+
+            commands(batch->cmd, staging_buffer, staging_offset);
+            batch->command_count++;
+
+            UploadTicket ticket = batch->ticket;
+
+            if(batch->command_count >= m_max_batch_size)
+                submitBatch(batch);
+
+            return ticket;
+        }
+
+        UploadTicket UploadManager::record(const std::function<void(vk::CommandBuffer& cmd)>& commands) {
+            /** records custom transfer commands into the current batch */
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            // reusing the batches that finished in the meantime
+            retireFinishedBatches(false, 0);
+
+            UploadBatch* batch = beginBatch();
+            commands(batch->cmd);
+            batch->command_count++;
+
+            UploadTicket ticket = batch->ticket;
+
+            if(batch->command_count >= m_max_batch_size)
+                submitBatch(batch);
+
+            return ticket;
+        }
+
+        void UploadManager::releaseBuffer(UploadTicket ticket, const vk::Buffer& buffer, const VramAllocation& memory) {
+            /** destroys the buffer + frees its memory once the commands up to the ticket have finished */
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            retireFinishedBatches(false, 0);
+
+            // finding the batch the buffer is used by
+            // (the batches finish in order, so the first one with the ticket or a later one can be used)
+            UploadBatch* batch = 0;
+
+            if(ticket > m_finished_ticket) {
+
+                for(UploadBatch* submitted : m_submitted)
+                    if(!batch && (submitted->ticket >= ticket))
+                        batch = submitted;
+
+                if(!batch)
+                    batch = m_recording;
+            }
+
+            if(batch) {
+                batch->released_buffers.push_back({buffer, memory});
+                return;
+            }
+
+            // the buffer is no longer used
+            VramAllocation allocation = memory;
+            m_device_handle->m_device->destroyBuffer(buffer);
+            m_device_handle->getDestroyedHandles()->add((uint64_t)(VkBuffer)buffer);
+            m_device_handle->getVramAllocator()->free(allocation);
+        }
+
+        /////////////////////////////////////////////// submitting / waiting ///////////////////////////////////////////////
+
+        void UploadManager::submit() {
+            /** submits the batch that is currently recorded (if it contains any commands) */
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if(m_recording && m_recording->command_count)
+                submitBatch(m_recording);
+
+        }
+
+        bool UploadManager::isFinished(UploadTicket ticket) {
+            /** @return whether the commands recorded with the ticket have finished on the gpu (doesnt block) */
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if(ticket <= m_finished_ticket)
+                return true;
+
+            retireFinishedBatches(false, 0);
+
+            return ticket <= m_finished_ticket;
+        }
+
+        void UploadManager::wait(UploadTicket ticket) {
+            /** blocks until the commands recorded with the ticket have finished (submits the ticket's batch, if necessary) */
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            if(ticket <= m_finished_ticket)
+                return;
+
+            if(m_recording && (m_recording->ticket <= ticket) && m_recording->command_count)
+                submitBatch(m_recording);
+
+            retireFinishedBatches(true, ticket);
+        }
+
+        void UploadManager::waitForAll() {
+
+            submit();
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            retireFinishedBatches(true, m_next_ticket - 1);
+        }
+
+        UploadTicket UploadManager::getCurrentTicket() const {
+            /** @return the ticket of the batch that is currently recorded */
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            return m_recording ? m_recording->ticket : m_next_ticket - 1;
+        }
+
+        /////////////////////////////////////////////// staging statistics ///////////////////////////////////////////////
+
+        uint64_t UploadManager::getStagingSize() const {
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            return m_staging_ring.m_size;
+        }
+
+        uint64_t UploadManager::getStagingUsage() const {
+            /** @return the bytes of the staging ring that are still waiting for the gpu */
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            return m_staging_ring.m_used;
+        }
+
+        uint64_t UploadManager::getPeakStagingUsage() const {
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            return m_staging_peak;
+        }
+
+        uint32_t UploadManager::getStagingStalls() const {
+            /** @return how often an upload had to wait, because the gpu did not yet finish the uploads using the staging ring */
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            return m_staging_stalls;
+        }
+
+        uint32_t UploadManager::getOversizedUploads() const {
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            return m_oversized_uploads;
+        }
+
+        /////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+        void UploadManager::initStagingBuffer(uint64_t byte_size) {
+
+            m_staging_ring = StagingRing(byte_size);
+
+            // the buffer is only used by the graphics queue, which executes the uploads
+            vk::BufferCreateInfo buffer_info({}, byte_size, vk::BufferUsageFlagBits::eTransferSrc, vk::SharingMode::eExclusive);
+            *m_staging_buffer = m_device_handle->m_device->createBuffer(buffer_info);
+
+            // host visible memory stays mapped
+            vk::MemoryRequirements requirements = m_device_handle->m_device->getBufferMemoryRequirements(*m_staging_buffer);
+            m_staging_memory = m_device_handle->getVramAllocator()->allocate(requirements, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+            m_device_handle->m_device->bindBufferMemory(*m_staging_buffer, *m_staging_memory.memory, m_staging_memory.offset);
+        }
+
+        void UploadManager::destroyStagingBuffer() {
+
+            m_device_handle->m_device->destroyBuffer(*m_staging_buffer);
+            m_device_handle->getVramAllocator()->free(m_staging_memory);
+        }
+
+        UploadBatch* UploadManager::beginBatch() {
+
+            if(m_recording)
+                return m_recording;
+
+            UploadBatch* batch = 0;
+
+            if(m_free_batches.size()) {
+                // reusing a finished batch
+                batch = m_free_batches.back();
+                m_free_batches.pop_back();
+            } else {
+                // creating a new batch
+                batch = new UploadBatch;
+
+                vk::CommandBufferAllocateInfo allocate_info(*m_cmd_pool, vk::CommandBufferLevel::ePrimary, 1);
+                batch->cmd = m_device_handle->m_device->allocateCommandBuffers(allocate_info).at(0);
+                batch->fence = m_device_handle->m_device->createFence(vk::FenceCreateInfo());
+            }
+
+            batch->ticket = m_next_ticket++;
+            batch->command_count = 0;
+
+            vk::CommandBufferBeginInfo begin_info(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+            batch->cmd.begin(begin_info);
+
+            m_recording = batch;
+
+            return batch;
+        }
+
+        void UploadManager::submitBatch(UploadBatch* batch) {
+
+            // making the transferred data visible to all commands submitted later to the graphics queue
+            vk::MemoryBarrier barrier(vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eMemoryRead | vk::AccessFlagBits::eMemoryWrite);
+            batch->cmd.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eAllCommands, {}, barrier, {}, {});
+
+            batch->cmd.end();
+
+            vk::SubmitInfo submit_info({}, {}, batch->cmd, {});
+
+            {
+                std::lock_guard<std::mutex> lock(*m_device_handle->m_queue_mutex);
+                m_device_handle->m_graphics_queue->submit(submit_info, batch->fence);
+            }
+
+            m_submitted.push_back(batch);
+
+            if(batch == m_recording)
+                m_recording = 0;
+
+        }
+
+        void UploadManager::retireFinishedBatches(bool wait_for_ticket, UploadTicket ticket) {
+            // the batches finish in the order they were submitted
+
+            while(m_submitted.size()) {
+
+                UploadBatch* batch = m_submitted.front();
+
+                if(wait_for_ticket && (batch->ticket <= ticket)) {
+                    m_device_handle->m_device->waitForFences(batch->fence, VK_TRUE, UINT64_MAX);
+                } else if(m_device_handle->m_device->getFenceStatus(batch->fence) != vk::Result::eSuccess) {
+                    break; // still in use
+                }
+
+                // destroying the buffers that were waiting for the batch
+                for(std::pair<vk::Buffer, VramAllocation>& released : batch->released_buffers) {
+                    m_device_handle->m_device->destroyBuffer(released.first);
+                    m_device_handle->getDestroyedHandles()->add((uint64_t)(VkBuffer)released.first);
+                    m_device_handle->getVramAllocator()->free(released.second);
+                }
+
+                batch->released_buffers.clear();
+
+                m_device_handle->m_device->resetFences(batch->fence);
+                batch->cmd.reset();
+
+                m_finished_ticket = batch->ticket;
+                m_free_batches.push_back(batch);
+                m_submitted.erase(m_submitted.begin());
+            }
+
+            // the staging memory used by the finished batches can be reused
+            m_staging_ring.free(m_finished_ticket);
+
+        }
+
+        void UploadManager::destroyBatch(UploadBatch* batch) {
+
+            m_device_handle->m_device->freeCommandBuffers(*m_cmd_pool, batch->cmd);
+            m_device_handle->m_device->destroyFence(batch->fence);
+
+            delete batch;
+        }
+
+    } // graphics
+
+} // undicht
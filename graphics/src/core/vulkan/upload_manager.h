@@ -0,0 +1,169 @@
+#ifndef UPLOAD_MANAGER_H
+#define UPLOAD_MANAGER_H
+
+#include "vulkan_declaration.h"
+#include "vram_allocator.h"
+
+#include "vector"
+#include "deque"
+#include "mutex"
+#include "functional"
+#include "cstdint"
+
+namespace undicht {
+
+    namespace graphics {
+
+        class GraphicsDevice;
+        class VramBuffer;
+        struct UploadBatch;
+
+        // identifies the batch a transfer command was recorded into (0: nothing to wait for)
+        typedef uint64_t UploadTicket;
+
+        struct StagingRegion {
+            uint64_t end; // the offset after the region
+            uint64_t size; // including the padding + the unused space at the end of the ring, when the region wrapped around
+            UploadTicket ticket; // the region can be reused once the ticket has finished
+        };
+
+        class StagingRing {
+            /** bookkeeping of the staging ring buffer (doesnt own any memory)
+            * space is taken at the head, the regions are given back at the tail once the ticket they were used with has finished */
+        public:
+
+            uint64_t m_size = 0;
+            uint64_t m_head = 0; // where the next region starts
+            uint64_t m_tail = 0; // where the oldest region starts
+            uint64_t m_used = 0;
+
+            std::deque<StagingRegion> m_regions; // oldest first
+
+            StagingRing(uint64_t size = 0);
+
+            /** @return false if there is not enough continuous space left until older regions get freed */
+            bool allocate(uint64_t byte_size, uint64_t alignment, UploadTicket ticket, uint64_t& offset);
+
+            /** gives back the regions of all tickets up to the finished one */
+            void free(UploadTicket finished_ticket);
+
+            UploadTicket getOldestTicket() const;
+
+        };
+
+        class UploadManager {
+            /** records transfer commands (buffer copies, texture uploads + layout transitions) into batches
+            * instead of submitting + waiting for every single command
+            * a batch is submitted once it is full or when something has to wait for it, its completion is tracked with a fence
+            * the commands are executed on the graphics queue, each batch ends with a memory barrier,
+            * so that draw calls submitted later to the graphics queue see the transferred data without the cpu waiting for it
+            * data from the cpu is copied into one staging ring buffer shared by all uploads,
+            * the space gets reused once the batch that read from it has finished (if the ring is full, the upload has to wait for the gpu)
+            * can be used by multiple threads at the same time (the batches are submitted under the queue mutex of the device) */
+
+        protected:
+
+            const GraphicsDevice* m_device_handle = 0;
+
+            vk::CommandPool* m_cmd_pool = 0;
+
+            UploadBatch* m_recording = 0; // the batch commands are currently recorded into
+            std::vector<UploadBatch*> m_submitted; // in the order they were submitted
+            std::vector<UploadBatch*> m_free_batches; // finished batches that can be reused
+
+            UploadTicket m_next_ticket = 1;
+            UploadTicket m_finished_ticket = 0; // all batches up to this one have finished
+
+            uint32_t m_max_batch_size = 256; // commands per batch
+
+            // staging memory shared by all uploads from the cpu
+            StagingRing m_staging_ring;
+            vk::Buffer* m_staging_buffer = 0;
+            VramAllocation m_staging_memory;
+
+            // staging statistics
+            uint64_t m_staging_peak = 0;
+            uint32_t m_staging_stalls = 0; // the number of times an upload had to wait for the gpu to free staging memory
+            uint32_t m_oversized_uploads = 0; // uploads that were bigger than the ring (they got their own staging buffer)
+
+            mutable std::mutex m_mutex;
+
+        public:
+
+            UploadManager(const GraphicsDevice* device);
+            virtual ~UploadManager();
+
+            void cleanUp();
+
+            /** the number of commands after which a batch gets submitted */
+            void setMaxBatchSize(uint32_t command_count);
+
+            /** recreates the staging ring with the size (waits for all uploads to finish) */
+            void setStagingSize(uint64_t byte_size);
+
+        public:
+            // recording commands
+
+            /** records a copy between two buffers (the buffers have to exist until the copy has finished) */
+            UploadTicket copyBuffer(const VramBuffer& src, const VramBuffer& dst, uint64_t byte_size, uint64_t src_offset, uint64_t dst_offset);
+
+            /** copies the data into the staging ring and records a copy from there into the buffer */
+            UploadTicket uploadBuffer(const void* data, uint64_t byte_size, const VramBuffer& dst, uint64_t dst_offset);
+
+            /** copies the data into the staging ring and records the commands, which should read the data from the staging buffer
+            * @param alignment: of the data in the staging buffer */
+            UploadTicket upload(const void* data, uint64_t byte_size, uint64_t alignment, const std::function<void(vk::CommandBuffer& cmd, const vk::Buffer& staging_buffer, uint64_t staging_offset)>& commands);
+
+            /** records custom transfer commands into the current batch */
+            UploadTicket record(const std::function<void(vk::CommandBuffer& cmd)>& commands);
+
+            /** destroys the buffer + frees its memory once the commands up to the ticket have finished */
+            void releaseBuffer(UploadTicket ticket, const vk::Buffer& buffer, const VramAllocation& memory);
+
+        public:
+            // submitting / waiting
+
+            /** submits the batch that is currently recorded (if it contains any commands) */
+            void submit();
+
+            /** @return whether the commands recorded with the ticket have finished on the gpu (doesnt block) */
+            bool isFinished(UploadTicket ticket);
+
+            /** blocks until the commands recorded with the ticket have finished (submits the ticket's batch, if necessary) */
+            void wait(UploadTicket ticket);
+
+            void waitForAll();
+
+            /** @return the ticket of the batch that is currently recorded */
+            UploadTicket getCurrentTicket() const;
+
+        public:
+            // staging statistics
+
+            uint64_t getStagingSize() const;
+
+            /** @return the bytes of the staging ring that are still waiting for the gpu */
+            uint64_t getStagingUsage() const;
+            uint64_t getPeakStagingUsage() const;
+
+            /** @return how often an upload had to wait, because the gpu did not yet finish the uploads using the staging ring */
+            uint32_t getStagingStalls() const;
+            uint32_t getOversizedUploads() const;
+
+        protected:
+
+            void initStagingBuffer(uint64_t byte_size);
+            void destroyStagingBuffer();
+
+            UploadBatch* beginBatch();
+            void submitBatch(UploadBatch* batch);
+            void retireFinishedBatches(bool wait_for_ticket, UploadTicket ticket);
+            void destroyBatch(UploadBatch* batch);
+
+        };
+
+    } // graphics
+
+} // undicht
+
+#endif // UPLOAD_MANAGER_H
@@ -0,0 +1,405 @@
+#include "vram_allocator.h"
+
+#include "vulkan/vulkan.hpp"
+
+#include "algorithm"
+#include "sstream"
+
+#include "debug.h"
+#include "core/vulkan/graphics_device.h"
+
+namespace undicht {
+
+    namespace graphics {
+
+        ///////////////////////////////////////////////// VramBlock /////////////////////////////////////////////////
+
+        VramBlock::VramBlock(uint64_t size) {
+
+            m_size = size;
+            m_free_ranges.push_back({0, size});
+        }
+
+        bool VramBlock::allocate(uint64_t size, uint64_t alignment, uint64_t& offset) {
+            /** finds the smallest free range that can hold the allocation (best fit)
+            * @return false if there is not enough continuous space left */
+
+            if(!alignment)
+                alignment = 1;
+
+            std::vector<VramRange>::iterator best_range = m_free_ranges.end();
+            uint64_t best_offset = 0;
+
+            for(std::vector<VramRange>::iterator range = m_free_ranges.begin(); range != m_free_ranges.end(); range++) {
+
+                uint64_t aligned_offset = (range->offset + alignment - 1) / alignment * alignment;
+                uint64_t padding = aligned_offset - range->offset;
+
+                if(range->size < padding + size)
+                    continue; // too small
+
+                if((best_range == m_free_ranges.end()) || (range->size < best_range->size)) {
+                    best_range = range;
+                    best_offset = aligned_offset;
+                }
+
+            }
+
+            if(best_range == m_free_ranges.end())
+                return false;
+
+            // splitting the free range into the padding before and the space after the allocation
+            VramRange before = {best_range->offset, best_offset - best_range->offset};
+            VramRange after = {best_offset + size, best_range->offset + best_range->size - best_offset - size};
+
+            best_range = m_free_ranges.erase(best_range);
+
+            if(after.size)
+                best_range = m_free_ranges.insert(best_range, after);
+
+            if(before.size)
+                m_free_ranges.insert(best_range, before);
+
+            m_used += size;
+            m_allocation_count++;
+            offset = best_offset;
+
+            return true;
+        }
+
+        void VramBlock::free(uint64_t offset, uint64_t size) {
+
+            // finding the position of the range (sorted by offset)
+            std::vector<VramRange>::iterator next = m_free_ranges.begin();
+            while((next != m_free_ranges.end()) && (next->offset < offset))
+                next++;
+
+            next = m_free_ranges.insert(next, {offset, size});
+
+            // merging with the next range
+            if(((next + 1) != m_free_ranges.end()) && ((next + 1)->offset == offset + size)) {
+                next->size += (next + 1)->size;
+                m_free_ranges.erase(next + 1);
+            }
+
+            // merging with the previous range
+            if((next != m_free_ranges.begin()) && ((next - 1)->offset + (next - 1)->size == offset)) {
+                (next - 1)->size += next->size;
+                m_free_ranges.erase(next);
+            }
+
+            m_used -= size;
+            m_allocation_count--;
+        }
+
+        uint64_t VramBlock::getLargestFreeRange() const {
+
+            uint64_t largest = 0;
+
+            for(const VramRange& range : m_free_ranges)
+                largest = std::max(largest, range.size);
+
+            return largest;
+        }
+
+        ///////////////////////////////////////////////// VramAllocator /////////////////////////////////////////////////
+
+        VramAllocator::VramAllocator(const GraphicsDevice* device) {
+
+            m_device_handle = device;
+
+            // memory types + limits that are needed to map memory
+            vk::PhysicalDeviceMemoryProperties memory_properties = m_device_handle->m_physical_device->getMemoryProperties();
+            for(uint32_t i = 0; i < memory_properties.memoryTypeCount; i++)
+                m_memory_type_flags.push_back(VkMemoryPropertyFlags(memory_properties.memoryTypes[i].propertyFlags));
+
+            vk::PhysicalDeviceProperties device_properties = m_device_handle->m_physical_device->getProperties();
+            m_non_coherent_atom_size = std::max(device_properties.limits.nonCoherentAtomSize, vk::DeviceSize(1));
+        }
+
+        VramAllocator::~VramAllocator() {
+
+            cleanUp();
+        }
+
+        void VramAllocator::cleanUp() {
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            for(VramBlock* block : m_blocks) {
+
+                if(block->m_allocation_count)
+                    UND_WARNING << "vram allocator: freeing a memory block that is still in use (" << block->m_allocation_count << " allocations)\n";
+
+                if(block->m_mapped)
+                    m_device_handle->m_device->unmapMemory(*block->m_memory);
+
+                m_device_handle->m_device->freeMemory(*block->m_memory);
+                delete block->m_memory;
+                delete block;
+            }
+
+            m_blocks.clear();
+        }
+
+        void VramAllocator::setBlockSize(uint64_t byte_size) {
+            /** the size of the memory blocks allocated from now on (should be set before allocating memory) */
+
+            m_block_size = byte_size;
+        }
+
+        //////////////////////////////////////////////// allocating memory ////////////////////////////////////////////////
+
+        VramAllocation VramAllocator::allocate(const vk::MemoryRequirements& requirements, const vk::MemoryPropertyFlags& properties, bool linear) {
+            /** @param requirements: the size, alignment and memory types returned by getBufferMemoryRequirements() / getImageMemoryRequirements()
+            * @param linear: true for buffers, false for images with optimal tiling */
+
+            // finding the memory type
+            vk::MemoryType memory_type;
+            memory_type.heapIndex = requirements.memoryTypeBits; // bitfield specifying which memory types can be used
+            memory_type.propertyFlags = properties;
+            uint32_t memory_type_id = m_device_handle->findMemory(memory_type);
+
+            // flushed ranges of non coherent memory should not reach into other allocations
+            uint64_t alignment = requirements.alignment;
+            VkMemoryPropertyFlags type_flags = m_memory_type_flags.at(memory_type_id);
+
+            if((type_flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) && !(type_flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT))
+                alignment = std::max(alignment, m_non_coherent_atom_size);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            VramAllocation allocation;
+            allocation.size = requirements.size;
+
+            if(requirements.size > m_block_size / 2) {
+                // big allocations get their own block
+                allocation.block = allocateBlock(requirements.size, memory_type_id, linear, true);
+                allocation.block->allocate(requirements.size, alignment, allocation.offset);
+            } else {
+                // searching for a block with enough space left
+                for(VramBlock* block : m_blocks) {
+
+                    if(block->m_dedicated || (block->m_memory_type != memory_type_id) || (block->m_linear != linear))
+                        continue;
+
+                    if(block->allocate(requirements.size, alignment, allocation.offset)) {
+                        allocation.block = block;
+                        break;
+                    }
+
+                }
+
+                // all blocks are full
+                if(!allocation.block) {
+                    allocation.block = allocateBlock(m_block_size, memory_type_id, linear, false);
+                    allocation.block->allocate(requirements.size, alignment, allocation.offset);
+                }
+
+            }
+
+            allocation.memory = allocation.block->m_memory;
+
+            if(allocation.block->m_mapped)
+                allocation.mapped = allocation.block->m_mapped + allocation.offset;
+
+            return allocation;
+        }
+
+        void VramAllocator::free(VramAllocation& allocation) {
+            /** gives the memory back to its block (the allocation is reset) */
+
+            if(!allocation.block)
+                return; // nothing allocated
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            VramBlock* block = allocation.block;
+            block->free(allocation.offset, allocation.size);
+            allocation = VramAllocation();
+            m_free_count++;
+
+            if(block->m_allocation_count)
+                return;
+
+            // one empty block per memory type is kept, so that buffers that get resized dont allocate a new block every time
+            bool keep_block = !block->m_dedicated;
+
+            for(VramBlock* other : m_blocks)
+                if((other != block) && !other->m_dedicated && !other->m_allocation_count && (other->m_memory_type == block->m_memory_type) && (other->m_linear == block->m_linear))
+                    keep_block = false;
+
+            if(!keep_block)
+                freeBlock(block);
+
+        }
+
+        void VramAllocator::flush(const VramAllocation& allocation, uint64_t offset, uint64_t byte_size) const {
+            /** makes cpu writes to the mapped range visible to the gpu (only does something for non coherent memory)
+            * @param offset: relative to the start of the allocation */
+
+            if(!allocation.block || !allocation.block->m_mapped || allocation.block->m_coherent || !byte_size)
+                return;
+
+            // the flushed range has to be aligned to the nonCoherentAtomSize (or reach to the end of the memory)
+            uint64_t begin = (allocation.offset + offset) / m_non_coherent_atom_size * m_non_coherent_atom_size;
+            uint64_t end = (allocation.offset + offset + byte_size + m_non_coherent_atom_size - 1) / m_non_coherent_atom_size * m_non_coherent_atom_size;
+            end = std::min(end, allocation.block->m_size);
+
+            vk::MappedMemoryRange range(*allocation.memory, begin, end - begin);
+            m_device_handle->m_device->flushMappedMemoryRanges(range);
+        }
+
+        void VramAllocator::countReallocation(uint64_t bytes_copied) {
+            /** called by buffers that moved their data to a new allocation */
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            m_reallocation_count++;
+            m_reallocated_bytes += bytes_copied;
+        }
+
+        /////////////////////////////////////////////////// statistics ///////////////////////////////////////////////////
+
+        uint32_t VramAllocator::getBlockCount() const {
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            return m_blocks.size();
+        }
+
+        uint32_t VramAllocator::getAllocationCount() const {
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            uint32_t count = 0;
+            for(const VramBlock* block : m_blocks)
+                count += block->m_allocation_count;
+
+            return count;
+        }
+
+        uint64_t VramAllocator::getUsedSize() const {
+            /** @return the bytes given to buffers / images */
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            uint64_t used = 0;
+            for(const VramBlock* block : m_blocks)
+                used += block->m_used;
+
+            return used;
+        }
+
+        uint64_t VramAllocator::getReservedSize() const {
+            /** @return the bytes allocated from the driver */
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            uint64_t reserved = 0;
+            for(const VramBlock* block : m_blocks)
+                reserved += block->m_size;
+
+            return reserved;
+        }
+
+        float VramAllocator::getFragmentation() const {
+            /** @return 0 if the free memory of each block is in one piece, close to 1 if it is split into many small pieces
+            * (1 - largest free range / free memory, averaged over the blocks weighted by their free memory) */
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            uint64_t free_memory = 0;
+            uint64_t largest_free_ranges = 0;
+
+            for(const VramBlock* block : m_blocks) {
+                free_memory += block->m_size - block->m_used;
+                largest_free_ranges += block->getLargestFreeRange();
+            }
+
+            if(!free_memory)
+                return 0.0f;
+
+            return 1.0f - float(largest_free_ranges) / float(free_memory);
+        }
+
+        uint32_t VramAllocator::getReallocationCount() const {
+            /** @return how often buffers were moved to a new allocation because they changed their size */
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            return m_reallocation_count;
+        }
+
+        uint64_t VramAllocator::getReallocatedBytes() const {
+            /** @return the bytes copied when buffers were moved to a new allocation */
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            return m_reallocated_bytes;
+        }
+
+        uint64_t VramAllocator::getFreeCount() const {
+            /** @return the number of allocations that were freed so far */
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+
+            return m_free_count;
+        }
+
+        std::string VramAllocator::info() const {
+
+            std::stringstream info;
+            info << getBlockCount() << " memory blocks, " << getAllocationCount() << " allocations, ";
+            info << getUsedSize() / 1024 << " of " << getReservedSize() / 1024 << " kb used, ";
+            info << "fragmentation: " << getFragmentation() << ", ";
+            info << getReallocationCount() << " buffer reallocations (" << getReallocatedBytes() / 1024 << " kb copied)";
+
+            return info.str();
+        }
+
+        ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+        VramBlock* VramAllocator::allocateBlock(uint64_t byte_size, uint32_t memory_type, bool linear, bool dedicated) {
+
+            VramBlock* block = new VramBlock(byte_size);
+            block->m_memory_type = memory_type;
+            block->m_linear = linear;
+            block->m_dedicated = dedicated;
+
+            // allocating the memory
+            vk::MemoryAllocateInfo allocate_info;
+            allocate_info.allocationSize = byte_size;
+            allocate_info.memoryTypeIndex = memory_type;
+
+            block->m_memory = new vk::DeviceMemory;
+            *block->m_memory = m_device_handle->m_device->allocateMemory(allocate_info);
+
+            // mapping host visible memory for the lifetime of the block
+            VkMemoryPropertyFlags type_flags = m_memory_type_flags.at(memory_type);
+
+            if(type_flags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+                block->m_mapped = (char*)m_device_handle->m_device->mapMemory(*block->m_memory, 0, VK_WHOLE_SIZE);
+                block->m_coherent = type_flags & VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+            }
+
+            m_blocks.push_back(block);
+
+            return block;
+        }
+
+        void VramAllocator::freeBlock(VramBlock* block) {
+
+            m_blocks.erase(std::find(m_blocks.begin(), m_blocks.end(), block));
+
+            if(block->m_mapped)
+                m_device_handle->m_device->unmapMemory(*block->m_memory);
+
+            m_device_handle->m_device->freeMemory(*block->m_memory);
+            delete block->m_memory;
+            delete block;
+        }
+
+    } // graphics
+
+} // undicht
@@ -0,0 +1,157 @@
+#ifndef VRAM_ALLOCATOR_H
+#define VRAM_ALLOCATOR_H
+
+#include "vulkan_declaration.h"
+
+#include "vector"
+#include "string"
+#include "mutex"
+#include "cstdint"
+
+namespace undicht {
+
+    namespace graphics {
+
+        class GraphicsDevice;
+        class VramBlock;
+
+        struct VramAllocation {
+            /** a part of a memory block, given to a buffer / image */
+
+            vk::DeviceMemory* memory = 0; // the memory of the block (dont free it)
+            uint64_t offset = 0; // in bytes from the start of the memory
+            uint64_t size = 0;
+            char* mapped = 0; // the allocation in cpu address space (only for host visible memory)
+
+            VramBlock* block = 0; // 0, if nothing is allocated
+        };
+
+        struct VramRange {
+            uint64_t offset;
+            uint64_t size;
+        };
+
+        class VramBlock {
+            /** one vkAllocateMemory, which gets divided into smaller allocations
+            * the free parts of the block are stored as a list of ranges (sorted by offset, neighbouring ranges get merged) */
+        public:
+
+            vk::DeviceMemory* m_memory = 0;
+            uint32_t m_memory_type = 0;
+            bool m_linear = true; // whether the block is used for buffers / linear images or optimal images
+            bool m_dedicated = false; // holds only one allocation, freed once it is no longer used
+
+            // host visible blocks stay mapped for their whole lifetime
+            char* m_mapped = 0;
+            bool m_coherent = true; // if not, writes from the cpu have to be flushed
+
+            uint64_t m_size = 0;
+            uint64_t m_used = 0;
+            uint32_t m_allocation_count = 0;
+
+            std::vector<VramRange> m_free_ranges;
+
+            VramBlock(uint64_t size);
+
+            /** finds the smallest free range that can hold the allocation (best fit)
+            * @return false if there is not enough continuous space left */
+            bool allocate(uint64_t size, uint64_t alignment, uint64_t& offset);
+
+            void free(uint64_t offset, uint64_t size);
+
+            uint64_t getLargestFreeRange() const;
+
+        };
+
+        class VramAllocator {
+            /** sub allocates the memory of buffers and images from big memory blocks (one block list per memory type)
+            * this way only a few vkAllocateMemory calls are needed (they are slow and their number is limited by the driver)
+            * allocations bigger than half the block size get their own (dedicated) block
+            * buffers and optimal images are kept in different blocks, so that bufferImageGranularity does not have to be considered
+            * host visible blocks are mapped once when they are allocated (a memory object can only be mapped once at a time)
+            * can be used by multiple threads at the same time */
+
+        protected:
+
+            const GraphicsDevice* m_device_handle = 0;
+
+            std::vector<VramBlock*> m_blocks;
+            uint64_t m_block_size = 64 * 1024 * 1024;
+
+            std::vector<uint32_t> m_memory_type_flags; // vk::MemoryPropertyFlags of each memory type
+            uint64_t m_non_coherent_atom_size = 1; // alignment of flushed ranges
+
+            // buffers that had to be moved to a new allocation (when they grew or were shrunk)
+            uint32_t m_reallocation_count = 0;
+            uint64_t m_reallocated_bytes = 0; // the bytes copied to the new allocations
+
+            uint64_t m_free_count = 0; // the number of allocations that were freed
+
+            mutable std::mutex m_mutex;
+
+        public:
+
+            VramAllocator(const GraphicsDevice* device);
+            virtual ~VramAllocator();
+
+            void cleanUp();
+
+            /** the size of the memory blocks allocated from now on (should be set before allocating memory) */
+            void setBlockSize(uint64_t byte_size);
+
+        public:
+            // allocating memory
+
+            /** @param requirements: the size, alignment and memory types returned by getBufferMemoryRequirements() / getImageMemoryRequirements()
+            * @param linear: true for buffers, false for images with optimal tiling */
+            VramAllocation allocate(const vk::MemoryRequirements& requirements, const vk::MemoryPropertyFlags& properties, bool linear = true);
+
+            /** gives the memory back to its block (the allocation is reset) */
+            void free(VramAllocation& allocation);
+
+            /** makes cpu writes to the mapped range visible to the gpu (only does something for non coherent memory)
+            * @param offset: relative to the start of the allocation */
+            void flush(const VramAllocation& allocation, uint64_t offset, uint64_t byte_size) const;
+
+            /** called by buffers that moved their data to a new allocation */
+            void countReallocation(uint64_t bytes_copied);
+
+        public:
+            // statistics
+
+            uint32_t getBlockCount() const;
+            uint32_t getAllocationCount() const;
+
+            /** @return the bytes given to buffers / images */
+            uint64_t getUsedSize() const;
+
+            /** @return the bytes allocated from the driver */
+            uint64_t getReservedSize() const;
+
+            /** @return 0 if the free memory of each block is in one piece, close to 1 if it is split into many small pieces
+            * (1 - largest free range / free memory, averaged over the blocks weighted by their free memory) */
+            float getFragmentation() const;
+
+            /** @return how often buffers were moved to a new allocation because they changed their size */
+            uint32_t getReallocationCount() const;
+
+            /** @return the bytes copied when buffers were moved to a new allocation */
+            uint64_t getReallocatedBytes() const;
+
+            /** @return the number of allocations that were freed so far */
+            uint64_t getFreeCount() const;
+
+            std::string info() const;
+
+        protected:
+
+            VramBlock* allocateBlock(uint64_t byte_size, uint32_t memory_type, bool linear, bool dedicated);
+            void freeBlock(VramBlock* block);
+
+        };
+
+    } // graphics
+
+} // undicht
+
+#endif // VRAM_ALLOCATOR_H
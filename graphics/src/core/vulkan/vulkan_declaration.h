@@ -41,12 +41,15 @@ namespace vk {
     class Buffer;
     class DeviceMemory;
     class MemoryType;
+    class MemoryRequirements;
     class Viewport;
     class DescriptorSetLayout;
     class DescriptorPool;
     class DescriptorSet;
+    class PushConstantRange;
     class ImageCreateInfo;
     class Sampler;
+    class PhysicalDeviceDescriptorIndexingFeatures;
 
     // flags
     template<typename T> class Flags;
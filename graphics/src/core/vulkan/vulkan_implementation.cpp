@@ -16,16 +16,22 @@
 // core files
 #include "core/vulkan/graphics_api.cpp"
 #include "core/vulkan/graphics_device.cpp"
+#include "core/vulkan/vram_allocator.cpp"
+#include "core/vulkan/upload_manager.cpp"
 #include "core/vulkan/graphics_surface.cpp"
 #include "core/vulkan/swap_chain.cpp"
 
 // graphics pipeline files
 #include "graphics_pipeline/vulkan/shader.cpp"
 #include "graphics_pipeline/vulkan/renderer.cpp"
+#include "graphics_pipeline/vulkan/draw_recorder.cpp"
 #include "graphics_pipeline/vulkan/vram_buffer.cpp"
 #include "graphics_pipeline/vulkan/vertex_buffer.cpp"
+#include "graphics_pipeline/vulkan/geometry_pool.cpp"
 #include "graphics_pipeline/vulkan/uniform_buffer.cpp"
+#include "graphics_pipeline/vulkan/dynamic_uniform_buffer.cpp"
 #include "graphics_pipeline/vulkan/texture.cpp"
 #include "graphics_pipeline/vulkan/pipeline.cpp"
+#include "graphics_pipeline/vulkan/descriptor_allocator.cpp"
 #include "graphics_pipeline/vulkan/framebuffer.cpp"
 #include "graphics_pipeline/vulkan/render_pass.cpp"
@@ -0,0 +1,141 @@
+#include "descriptor_allocator.h"
+#include "debug.h"
+
+#include "vulkan/vulkan.hpp"
+
+#include "algorithm"
+
+#include "core/vulkan/graphics_device.h"
+
+namespace undicht {
+
+    namespace graphics {
+
+        DescriptorAllocator::DescriptorAllocator(const GraphicsDevice* device) {
+
+            m_device_handle = device;
+
+            m_pools = new std::vector<vk::DescriptorPool>;
+            m_sets = new std::vector<std::vector<vk::DescriptorSet>>;
+        }
+
+        DescriptorAllocator::~DescriptorAllocator() {
+
+            cleanUp();
+
+            delete m_pools;
+            delete m_sets;
+        }
+
+        void DescriptorAllocator::cleanUp() {
+            // the sets are freed together with their pools
+
+            for(vk::DescriptorPool& pool : *m_pools)
+                m_device_handle->m_device->destroyDescriptorPool(pool);
+
+            m_pools->clear();
+            m_sets->clear();
+            m_used_sets.clear();
+        }
+
+        void DescriptorAllocator::setLayout(const vk::DescriptorSetLayout* layout, uint32_t ubo_count, uint32_t tex_count, uint32_t dynamic_ubo_count) {
+            /** destroys all pools + sets, new sets will be allocated with the layout
+            * @param layout: has to exist as long as sets are allocated from it */
+
+            cleanUp();
+
+            m_layout = layout;
+            m_ubo_count = ubo_count;
+            m_tex_count = tex_count;
+            m_dynamic_ubo_count = dynamic_ubo_count;
+
+            m_sets->resize(m_device_handle->getMaxFramesInFlight());
+            m_used_sets.resize(m_device_handle->getMaxFramesInFlight(), 0);
+        }
+
+        void DescriptorAllocator::setMinPoolSize(uint32_t set_count) {
+            /** the number of sets in the first pool of a frame (should be set before sets are allocated) */
+
+            m_min_pool_size = std::max(set_count, 1u);
+        }
+
+        ///////////////////////////////////////// getting descriptor sets /////////////////////////////////////////
+
+        vk::DescriptorSet* DescriptorAllocator::getDescriptorSet(uint32_t frame_id, uint32_t set_id) {
+            /** the set with the id, allocates new sets (+ pools) if necessary
+            * the contents of sets that were used before are kept */
+
+            std::vector<vk::DescriptorSet>& sets = m_sets->at(frame_id);
+
+            // the new pool is as big as the previous pools together
+            if(set_id >= sets.size())
+                addPool(frame_id, std::max(std::max(uint32_t(sets.size()), m_min_pool_size), set_id + 1 - uint32_t(sets.size())));
+
+            m_used_sets.at(frame_id) = std::max(m_used_sets.at(frame_id), set_id + 1);
+            m_peak_used_sets = std::max(m_peak_used_sets, m_used_sets.at(frame_id));
+
+            return &sets.at(set_id);
+        }
+
+        void DescriptorAllocator::reset(uint32_t frame_id) {
+            /** starts counting the sets used by the frame again (the sets get reused, they are not freed) */
+
+            m_used_sets.at(frame_id) = 0;
+        }
+
+        ///////////////////////////////////////////////// statistics /////////////////////////////////////////////////
+
+        uint32_t DescriptorAllocator::getPoolCount() const {
+
+            return m_pools->size();
+        }
+
+        uint32_t DescriptorAllocator::getSetCount(uint32_t frame_id) const {
+            /** @return the number of sets allocated for the frame */
+
+            return m_sets->at(frame_id).size();
+        }
+
+        uint32_t DescriptorAllocator::getPeakUsedSets() const {
+            /** @return the max number of sets used by one frame */
+
+            return m_peak_used_sets;
+        }
+
+        //////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+        void DescriptorAllocator::addPool(uint32_t frame_id, uint32_t set_count) {
+
+            // determining the size of the descriptor pool
+            std::vector<vk::DescriptorPoolSize> pool_sizes;
+
+            if(m_ubo_count)
+                pool_sizes.push_back(vk::DescriptorPoolSize(vk::DescriptorType::eUniformBuffer, set_count * m_ubo_count));
+
+            if(m_tex_count)
+                pool_sizes.push_back(vk::DescriptorPoolSize(vk::DescriptorType::eCombinedImageSampler, set_count * m_tex_count));
+
+            if(m_dynamic_ubo_count)
+                pool_sizes.push_back(vk::DescriptorPoolSize(vk::DescriptorType::eUniformBufferDynamic, set_count * m_dynamic_ubo_count));
+
+            if(!pool_sizes.size()) {
+                UND_ERROR << "failed to allocate descriptor sets: the layout has no bindings\n";
+                return;
+            }
+
+            vk::DescriptorPoolCreateInfo info({}, set_count, pool_sizes, nullptr);
+            m_pools->push_back(m_device_handle->m_device->createDescriptorPool(info));
+
+            // allocating all sets of the pool (they get freed when the pool is destroyed)
+            std::vector<vk::DescriptorSetLayout> layouts(set_count, *m_layout);
+            vk::DescriptorSetAllocateInfo allocate_info(m_pools->back(), layouts);
+
+            std::vector<vk::DescriptorSet> new_sets = m_device_handle->m_device->allocateDescriptorSets(allocate_info);
+
+            std::vector<vk::DescriptorSet>& sets = m_sets->at(frame_id);
+            sets.insert(sets.end(), new_sets.begin(), new_sets.end());
+        }
+
+    } // graphics
+
+} // undicht
@@ -0,0 +1,86 @@
+#ifndef DESCRIPTOR_ALLOCATOR_H
+#define DESCRIPTOR_ALLOCATOR_H
+
+#include "core/vulkan/vulkan_declaration.h"
+
+#include "vector"
+#include "cstdint"
+
+namespace undicht {
+
+    namespace graphics {
+
+        class GraphicsDevice;
+
+        class DescriptorAllocator {
+            /** allocates the descriptor sets of one layout for each frame in flight
+            * the sets come from a chain of descriptor pools, when all sets of a frame are used a new pool gets added
+            * (each new pool is as big as all previous pools of the frame together, so the number of pools stays small)
+            * the sets of a frame are reused once the frame is started again,
+            * so new pools are only created while the number of sets needed per frame grows */
+
+        protected:
+
+            const GraphicsDevice* m_device_handle = 0;
+
+            const vk::DescriptorSetLayout* m_layout = 0; // owned by the pipeline
+
+            // descriptors per set
+            uint32_t m_ubo_count = 0;
+            uint32_t m_dynamic_ubo_count = 0;
+            uint32_t m_tex_count = 0;
+
+            uint32_t m_min_pool_size = 64; // sets in the first pool of a frame
+
+            std::vector<vk::DescriptorPool>* m_pools = 0; // the pools of all frames
+            std::vector<std::vector<vk::DescriptorSet>>* m_sets = 0; // frame_id -> sets allocated for the frame
+
+            std::vector<uint32_t> m_used_sets; // frame_id -> sets used since the frame was reset
+            uint32_t m_peak_used_sets = 0;
+
+        public:
+
+            DescriptorAllocator(const GraphicsDevice* device);
+            virtual ~DescriptorAllocator();
+
+            void cleanUp();
+
+            /** destroys all pools + sets, new sets will be allocated with the layout
+            * @param layout: has to exist as long as sets are allocated from it */
+            void setLayout(const vk::DescriptorSetLayout* layout, uint32_t ubo_count, uint32_t tex_count, uint32_t dynamic_ubo_count);
+
+            /** the number of sets in the first pool of a frame (should be set before sets are allocated) */
+            void setMinPoolSize(uint32_t set_count);
+
+        public:
+            // getting descriptor sets
+
+            /** the set with the id, allocates new sets (+ pools) if necessary
+            * the contents of sets that were used before are kept */
+            vk::DescriptorSet* getDescriptorSet(uint32_t frame_id, uint32_t set_id);
+
+            /** starts counting the sets used by the frame again (the sets get reused, they are not freed) */
+            void reset(uint32_t frame_id);
+
+        public:
+            // statistics
+
+            uint32_t getPoolCount() const;
+
+            /** @return the number of sets allocated for the frame */
+            uint32_t getSetCount(uint32_t frame_id) const;
+
+            /** @return the max number of sets used by one frame */
+            uint32_t getPeakUsedSets() const;
+
+        protected:
+
+            void addPool(uint32_t frame_id, uint32_t set_count);
+
+        };
+
+    } // graphics
+
+} // undicht
+
+#endif // DESCRIPTOR_ALLOCATOR_H
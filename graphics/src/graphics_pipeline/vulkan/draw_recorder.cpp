@@ -0,0 +1,213 @@
+#include "draw_recorder.h"
+#include "renderer.h"
+#include "debug.h"
+
+#include "vulkan/vulkan.hpp"
+
+#include "core/vulkan/graphics_device.h"
+
+namespace undicht {
+
+    namespace graphics {
+
+        DrawRecorder::DrawRecorder(Renderer* renderer) {
+
+            m_renderer = renderer;
+            m_bound_set = new vk::DescriptorSet;
+        }
+
+        DrawRecorder::~DrawRecorder() {
+
+            delete m_bound_set;
+        }
+
+        void DrawRecorder::setShaderInput(uint32_t ubo_count, uint32_t tex_count, uint32_t dynamic_ubo_count) {
+            // the bindings are: ubos, dynamic ubos, textures
+
+            m_ubos.assign(ubo_count, 0);
+            m_textures.assign(tex_count, 0);
+            m_dynamic_ubos.assign(dynamic_ubo_count, 0);
+            m_dynamic_offsets.assign(dynamic_ubo_count, 0);
+            m_dynamic_ubo_offsets.assign(dynamic_ubo_count, 0);
+
+            m_shader_input.assign(ubo_count + dynamic_ubo_count + tex_count, 0);
+            m_shader_input_changed = true;
+        }
+
+        void DrawRecorder::beginRecording(RenderPass* render_pass) {
+            // starts recording into the command buffers of the render pass
+
+            m_render_pass = render_pass;
+
+            m_draw_calls = 0;
+            m_updated_ubos.clear();
+            m_vbo = 0; // nothing is bound in the new command buffer
+            m_bound_descriptor = -1;
+            m_shader_input_changed = true;
+        }
+
+        /////////////////////////////////////// drawing /////////////////////////////////////
+
+        void DrawRecorder::submit(UniformBuffer* ubo, uint32_t index) {
+
+            if(m_ubos.size() <= index) {
+                UND_ERROR << "failed to submit ubo: the index was is to big for this renderer\n";
+                return;
+            }
+
+            m_ubos.at(index) = ubo;
+
+            uint32_t current_frame = m_renderer->m_device_handle->getCurrentFrameID();
+            submitShaderInput(index, (uint64_t)(VkBuffer)*ubo->m_buffers.at(current_frame).m_buffer);
+
+            // the buffer of the frame only has to be updated once per render pass
+            // (unless the data was changed since then), so the mutex of the renderer is not taken for every draw call
+            for(std::pair<const UniformBuffer*, uint64_t>& updated : m_updated_ubos) {
+                if(updated.first != ubo)
+                    continue;
+
+                if(updated.second == ubo->m_data_version)
+                    return;
+
+                m_renderer->updateUniformBuffer(ubo, current_frame);
+                updated.second = ubo->m_data_version;
+                return;
+            }
+
+            m_renderer->updateUniformBuffer(ubo, current_frame);
+            m_updated_ubos.push_back(std::pair<const UniformBuffer*, uint64_t>(ubo, ubo->m_data_version));
+        }
+
+        void DrawRecorder::submit(const DynamicUniformBuffer* ubo, uint32_t index, uint32_t offset) {
+            // offset: returned when pushing the data to the dynamic ubo (the index starts after the last ubo index)
+
+            uint32_t binding = index;
+            index -= m_ubos.size();
+
+            if(m_dynamic_ubos.size() <= index) {
+                UND_ERROR << "failed to submit dynamic ubo: the index is not used for a dynamic ubo by this renderer\n";
+                return;
+            }
+
+            m_dynamic_ubos.at(index) = ubo;
+            m_dynamic_ubo_offsets.at(index) = offset;
+            m_dynamic_offsets.at(index) = ubo->getDynamicOffset(offset);
+
+            // the descriptor only changes if the data is stored in a different chunk of the arena
+            uint32_t current_frame = m_renderer->m_device_handle->getCurrentFrameID();
+            submitShaderInput(binding, (uint64_t)(VkBuffer)*ubo->getChunk(current_frame, offset)->m_buffer);
+
+        }
+
+        void DrawRecorder::submit(const Texture* tex, uint32_t index) {
+
+            // in the shader the texture is accessed by an index
+            // that comes after the uniform buffers
+            // calculating the actual index of the texture
+            uint32_t binding = index;
+            index -= m_ubos.size() + m_dynamic_ubos.size();
+
+            if(m_textures.size() <= index) {
+                UND_ERROR << "failed to submit texture: the index is to big for this renderer\n";
+                return;
+            }
+
+            m_textures.at(index) = tex;
+            submitShaderInput(binding, (uint64_t)(VkImageView)*tex->m_image_view);
+
+        }
+
+        void DrawRecorder::selectTexture(uint32_t texture_id) {
+
+            m_texture_id = texture_id;
+        }
+
+        void DrawRecorder::pushConstants(const void* data, uint32_t byte_size, uint32_t offset) {
+
+            if(offset + byte_size > m_renderer->m_pipeline.m_push_constant_size) {
+                UND_ERROR << "failed to push constants: the data does not fit into the push constant range of the renderer\n";
+                return;
+            }
+
+            if((offset % 4) || (byte_size % 4)) {
+                UND_ERROR << "failed to push constants: the offset + size have to be multiples of 4\n";
+                return;
+            }
+
+            m_render_pass->pushConstants(m_renderer->m_pipeline.m_layout, data, byte_size, offset);
+        }
+
+        void DrawRecorder::draw(const VertexBuffer* vbo) {
+
+            m_vbo = vbo;
+
+            m_render_pass->bindVertexBuffer(m_vbo);
+            bindShaderInput();
+            uint32_t first_instance = m_vbo->usesInstancing() ? 0 : m_texture_id;
+            m_render_pass->draw(m_vbo->getVertexCount(), m_vbo->usesIndices(), m_vbo->getInstanceCount(), 0, 0, first_instance);
+
+            m_draw_calls++;
+        }
+
+        void DrawRecorder::draw(const GeometryPool* pool, uint32_t mesh_id) {
+
+            const GeometryPoolMesh& mesh = pool->getMesh(mesh_id);
+
+            if(m_vbo != &pool->m_vbo) {
+                m_vbo = &pool->m_vbo;
+                m_render_pass->bindVertexBuffer(m_vbo);
+            }
+
+            bindShaderInput();
+            m_render_pass->draw(mesh.index_count, true, 1, mesh.first_index, mesh.vertex_offset, m_texture_id);
+
+            m_draw_calls++;
+        }
+
+        /////////////////////////////////////// statistics /////////////////////////////////////
+
+        uint32_t DrawRecorder::getDrawCalls() const {
+            // the number of draw calls recorded in the current render pass
+
+            return m_draw_calls;
+        }
+
+        /////////////////////////////////// binding the shader input ///////////////////////////////////
+
+        void DrawRecorder::bindShaderInput() {
+            // binds the descriptor set for the submitted resources (taken from the cache of the renderer, if possible)
+
+            if(!m_shader_input.size())
+                return; // no shader input
+
+            if(m_shader_input_changed) {
+
+                int32_t descriptor_id = m_renderer->getShaderInputDescriptor(this, m_bound_set);
+                m_shader_input_changed = false;
+
+                if(descriptor_id != m_bound_descriptor) {
+                    m_bound_descriptor = descriptor_id;
+                    m_render_pass->bindDescriptorSets(m_renderer->m_pipeline.m_layout, m_bound_set, m_dynamic_offsets);
+                    return;
+                }
+
+            }
+
+            // the dynamic offsets are set when binding the descriptor set
+            if(m_dynamic_offsets.size())
+                m_render_pass->bindDescriptorSets(m_renderer->m_pipeline.m_layout, m_bound_set, m_dynamic_offsets);
+
+        }
+
+        void DrawRecorder::submitShaderInput(uint32_t binding, uint64_t resource) {
+
+            if(m_shader_input.at(binding) == resource)
+                return;
+
+            m_shader_input.at(binding) = resource;
+            m_shader_input_changed = true;
+        }
+
+    } // graphics
+
+} // undicht
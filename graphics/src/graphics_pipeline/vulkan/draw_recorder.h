@@ -0,0 +1,103 @@
+#ifndef DRAW_RECORDER_H
+#define DRAW_RECORDER_H
+
+#include "core/vulkan/vulkan_declaration.h"
+
+#include "vector"
+#include "utility"
+#include "cstdint"
+
+namespace undicht {
+
+    namespace graphics {
+
+        class Renderer;
+        class RenderPass;
+        class VertexBuffer;
+        class GeometryPool;
+        class UniformBuffer;
+        class DynamicUniformBuffer;
+        class Texture;
+
+        class DrawRecorder {
+            /** records the draw calls of a render pass of the renderer
+            * either directly into the command buffer of the render pass or into a secondary command buffer
+            * the recorders of a render pass can be used by different threads at the same time
+            * (one thread per recorder, see Renderer::beginRenderPass())
+            * the descriptor sets are shared with the other recorders of the renderer,
+            * but a dynamic uniform buffer should only be pushed to by one thread at a time */
+
+        protected:
+
+            Renderer* m_renderer = 0;
+            RenderPass* m_render_pass = 0; // the command buffers the draw calls get recorded into (owned by the renderer)
+
+            // currently submitted objects
+            const VertexBuffer* m_vbo = 0; // the vertex buffer bound by the last draw call
+            std::vector<const UniformBuffer*> m_ubos;
+            std::vector<std::pair<const UniformBuffer*, uint64_t>> m_updated_ubos; // ubos updated in the current render pass + their data version
+            std::vector<const DynamicUniformBuffer*> m_dynamic_ubos;
+            std::vector<uint32_t> m_dynamic_ubo_offsets; // the offsets returned by the dynamic ubos
+            std::vector<uint32_t> m_dynamic_offsets; // offsets into the dynamic ubos used by the next draw call
+            std::vector<const Texture*> m_textures;
+
+            std::vector<uint64_t> m_shader_input; // the resources submitted for the next draw call (one vulkan handle per binding)
+            bool m_shader_input_changed = true;
+            int32_t m_bound_descriptor = -1; // the id of the descriptor set bound by the last draw call
+            vk::DescriptorSet* m_bound_set = 0;
+
+            uint32_t m_texture_id = 0; // bindless texture used by the next draw calls
+            uint32_t m_draw_calls = 0; // recorded in the current render pass
+
+            friend Renderer;
+
+            DrawRecorder(Renderer* renderer);
+
+            // the bindings are: ubos, dynamic ubos, textures
+            void setShaderInput(uint32_t ubo_count, uint32_t tex_count, uint32_t dynamic_ubo_count);
+
+            // starts recording into the command buffers of the render pass
+            void beginRecording(RenderPass* render_pass);
+
+        public:
+
+            virtual ~DrawRecorder();
+
+        public:
+            // drawing (see the functions of the renderer)
+
+            void submit(UniformBuffer* ubo, uint32_t index);
+            void submit(const DynamicUniformBuffer* ubo, uint32_t index, uint32_t offset);
+            void submit(const Texture* tex, uint32_t index);
+            void selectTexture(uint32_t texture_id);
+            void pushConstants(const void* data, uint32_t byte_size, uint32_t offset = 0);
+
+            template<typename T>
+            void pushConstants(const T& data, uint32_t offset = 0) {
+                pushConstants(&data, sizeof(T), offset);
+            }
+
+            void draw(const VertexBuffer* vbo);
+            void draw(const GeometryPool* pool, uint32_t mesh_id);
+
+        public:
+            // statistics
+
+            // the number of draw calls recorded in the current render pass
+            uint32_t getDrawCalls() const;
+
+        protected:
+            // binding the shader input
+
+            // binds the descriptor set for the submitted resources (taken from the cache of the renderer, if possible)
+            void bindShaderInput();
+
+            void submitShaderInput(uint32_t binding, uint64_t resource);
+
+        };
+
+    } // graphics
+
+} // undicht
+
+#endif // DRAW_RECORDER_H
@@ -0,0 +1,218 @@
+#include "dynamic_uniform_buffer.h"
+#include "uniform_buffer.h"
+#include "debug.h"
+
+#include "algorithm"
+
+namespace undicht {
+
+    namespace graphics {
+
+        DynamicUniformBuffer::DynamicUniformBuffer(const GraphicsDevice* device) {
+
+            m_device_handle = device;
+
+        }
+
+        DynamicUniformBuffer::~DynamicUniformBuffer() {
+
+            cleanUp();
+        }
+
+        void DynamicUniformBuffer::cleanUp() {
+
+            for(std::vector<VramBuffer*>& frame_chunks : m_chunks)
+                for(VramBuffer* chunk : frame_chunks)
+                    delete chunk;
+
+            m_chunks.clear();
+        }
+
+        ////////////////////////////////////////// used by the renderer //////////////////////////////////////////
+
+        void DynamicUniformBuffer::writeDescriptorSet(vk::DescriptorSet* shader_descriptor, uint32_t index, uint32_t frame_id, uint32_t offset) const {
+            // binds the chunk the element at the offset is stored in
+            // (the offset within the chunk is passed when binding the descriptor set)
+
+            vk::DescriptorBufferInfo buffer_info;
+            buffer_info.offset = 0;
+            buffer_info.range = m_element_size;
+            buffer_info.buffer = *getChunk(frame_id, offset)->m_buffer;
+
+            vk::WriteDescriptorSet descriptor_write;
+            descriptor_write.dstBinding = index;
+            descriptor_write.pBufferInfo = &buffer_info;
+            descriptor_write.dstArrayElement = 0;
+            descriptor_write.descriptorType = vk::DescriptorType::eUniformBufferDynamic;
+            descriptor_write.descriptorCount = 1;
+            descriptor_write.pImageInfo = nullptr;
+            descriptor_write.pTexelBufferView = nullptr;
+            descriptor_write.dstSet = *shader_descriptor;
+
+            m_device_handle->m_device->updateDescriptorSets(descriptor_write, nullptr);
+
+        }
+
+        uint32_t DynamicUniformBuffer::getDynamicOffset(uint32_t offset) const {
+            // the offset within the chunk the element is stored in
+
+            return offset % m_chunk_size;
+        }
+
+        const VramBuffer* DynamicUniformBuffer::getChunk(uint32_t frame_id, uint32_t offset) const {
+            // the buffer the element at the offset is stored in
+
+            return m_chunks.at(frame_id).at(offset / m_chunk_size);
+        }
+
+        VramBuffer* DynamicUniformBuffer::createChunk() const {
+
+            // queue families this buffer is going to be accessed from
+            std::vector<uint32_t> queue_ids;
+            queue_ids.push_back(m_device_handle->m_graphics_queue_id);
+
+            // memory properties
+            vk::MemoryPropertyFlags mem_properties; // needs to be directly accessible by the cpu
+            mem_properties |= vk::MemoryPropertyFlagBits::eHostCoherent;
+            mem_properties |= vk::MemoryPropertyFlagBits::eHostVisible;
+
+            // usage
+            vk::BufferUsageFlags usage_flags = {};
+            usage_flags |= vk::BufferUsageFlagBits::eUniformBuffer;
+
+            VramBuffer* chunk = new VramBuffer(m_device_handle);
+            chunk->setUsage(usage_flags, mem_properties, queue_ids);
+            chunk->setData(0, 0, m_chunk_size);
+
+            return chunk;
+        }
+
+        /////////////////////////////////// specifying memory layout ////////////////////////////////////////
+
+        void DynamicUniformBuffer::setAttribute(uint32_t index, const FixedType& type) {
+
+            m_buffer_layout.setType(index, type);
+
+            m_element_size = UniformBuffer::calcMemoryOffsets(m_buffer_layout, m_offsets);
+            m_tmp_buffer.resize(m_element_size);
+        }
+
+        void DynamicUniformBuffer::setAttributes(const BufferLayout& layout) {
+
+            m_buffer_layout = layout;
+
+            m_element_size = UniformBuffer::calcMemoryOffsets(m_buffer_layout, m_offsets);
+            m_tmp_buffer.resize(m_element_size);
+        }
+
+        void DynamicUniformBuffer::setChunkSize(uint32_t byte_size) {
+            // the size of the buffers the elements are stored in (call before finalizeLayout())
+
+            m_chunk_size = byte_size;
+        }
+
+        void DynamicUniformBuffer::finalizeLayout() {
+            // call this after the layout + max frames in flight have been set
+            // and before pushing any data
+
+            // the dynamic offsets have to be multiples of the alignment
+            uint32_t alignment = m_device_handle->getMinUniformBufferOffsetAlignment();
+            m_element_stride = (m_element_size + alignment - 1) / alignment * alignment;
+
+            // chunks need to hold at least one element
+            m_chunk_size = std::max(m_chunk_size, m_element_stride);
+            m_chunk_size = m_chunk_size / m_element_stride * m_element_stride;
+
+            cleanUp();
+
+            uint32_t max_frames = m_device_handle->getMaxFramesInFlight();
+            m_chunks.resize(max_frames);
+            m_used_size.resize(max_frames, 0);
+            m_frame_numbers.resize(max_frames, 0);
+        }
+
+        /////////////////////////////////////// setting data ///////////////////////////////////////
+
+        void DynamicUniformBuffer::setData(uint32_t index, const void* data, uint32_t byte_size) {
+            // storing data in the element that gets pushed next
+
+            std::copy((const char*)data, (const char*)data + byte_size, m_tmp_buffer.begin() + m_offsets.at(index));
+        }
+
+        uint32_t DynamicUniformBuffer::push() {
+            // appends the element to the arena of the current frame
+            // @return the offset to submit to the renderer together with the buffer
+
+            return push(m_tmp_buffer.data(), m_tmp_buffer.size());
+        }
+
+        uint32_t DynamicUniformBuffer::push(const void* data, uint32_t byte_size) {
+
+            if(!m_element_stride) {
+                UND_ERROR << "failed to push data to the dynamic uniform buffer: finalizeLayout() has to be called first\n";
+                return 0;
+            }
+
+            if(byte_size > m_element_size) {
+                UND_WARNING << "dynamic uniform buffer: the pushed data is bigger than an element (the rest gets cut off)\n";
+                byte_size = m_element_size;
+            }
+
+            uint32_t frame = m_device_handle->getCurrentFrameID();
+
+            // the arena is reset the first time data gets pushed in a new frame
+            if(m_frame_numbers.at(frame) != m_device_handle->getFrameCount()) {
+                m_frame_numbers.at(frame) = m_device_handle->getFrameCount();
+                m_used_size.at(frame) = 0;
+            }
+
+            // finding the chunk to store the element in
+            uint32_t offset = m_used_size.at(frame);
+            uint32_t chunk_id = offset / m_chunk_size;
+
+            if(offset % m_chunk_size + m_element_stride > m_chunk_size) {
+                // continuing with the next chunk
+                chunk_id++;
+                offset = chunk_id * m_chunk_size;
+            }
+
+            std::vector<VramBuffer*>& frame_chunks = m_chunks.at(frame);
+            while(frame_chunks.size() <= chunk_id)
+                frame_chunks.push_back(createChunk());
+
+            // the chunks stay mapped, so this is just a memcpy
+            frame_chunks.at(chunk_id)->setData(data, byte_size, getDynamicOffset(offset));
+
+            m_used_size.at(frame) = offset + m_element_stride;
+            m_peak_size = std::max(m_peak_size, m_used_size.at(frame));
+
+            return offset;
+        }
+
+        //////////////////////////////////////// statistics ////////////////////////////////////////
+
+        uint32_t DynamicUniformBuffer::getElementStride() const {
+
+            return m_element_stride;
+        }
+
+        uint32_t DynamicUniformBuffer::getUsedSize() const {
+            // bytes pushed in the current frame
+
+            uint32_t frame = m_device_handle->getCurrentFrameID();
+
+            if(m_used_size.size() <= frame || m_frame_numbers.at(frame) != m_device_handle->getFrameCount())
+                return 0;
+
+            return m_used_size.at(frame);
+        }
+
+        uint32_t DynamicUniformBuffer::getPeakSize() const {
+            // max bytes pushed in one frame
+
+            return m_peak_size;
+        }
+
+    } // graphics
+
+} // undicht
@@ -0,0 +1,101 @@
+#ifndef DYNAMIC_UNIFORM_BUFFER_H
+#define DYNAMIC_UNIFORM_BUFFER_H
+
+#include "vram_buffer.h"
+#include "buffer_layout.h"
+#include "core/vulkan/vulkan_declaration.h"
+#include "vector"
+
+namespace undicht {
+
+    namespace graphics {
+
+        class GraphicsDevice;
+        class Renderer;
+        class DrawRecorder;
+
+        class DynamicUniformBuffer {
+            /** a per frame arena for uniform data that changes with every draw call (such as model matrices)
+            * the data pushed for the draw calls of a frame is stored one after another in a few big buffers (chunks),
+            * which are bound as dynamic uniform buffers, so that the draw calls only differ in the dynamic offset
+            * the arena of a frame is reset when the frame is started again (the gpu has finished reading the data by then) */
+
+        private:
+
+            BufferLayout m_buffer_layout;
+            std::vector<uint32_t> m_offsets; // offsets of the attributes within an element (for correct alignment)
+            std::vector<char> m_tmp_buffer; // the element that gets pushed next
+
+            uint32_t m_element_size = 0; // the size of the data of one draw call
+            uint32_t m_element_stride = 0; // the element size aligned to minUniformBufferOffsetAlignment
+            uint32_t m_chunk_size = 64 * 1024; // in bytes, elements dont reach across the end of a chunk
+
+            std::vector<std::vector<VramBuffer*>> m_chunks; // frame_id -> chunks used by the frame
+            std::vector<uint32_t> m_used_size; // frame_id -> bytes pushed in the frame (including the unused space at the end of full chunks)
+            std::vector<uint64_t> m_frame_numbers; // frame_id -> the device frame the arena was last reset in
+            uint32_t m_peak_size = 0;
+
+            friend Renderer;
+            friend DrawRecorder;
+            friend GraphicsDevice;
+            const GraphicsDevice* m_device_handle = 0;
+
+            DynamicUniformBuffer(const GraphicsDevice* device);
+
+            void cleanUp();
+
+        public:
+
+            ~DynamicUniformBuffer();
+
+        private:
+            // used by the renderer
+
+            void writeDescriptorSet(vk::DescriptorSet* shader_descriptor, uint32_t index, uint32_t frame_id, uint32_t offset) const;
+
+            // the offset within the chunk the element is stored in
+            uint32_t getDynamicOffset(uint32_t offset) const;
+
+            // the buffer the element at the offset is stored in
+            const VramBuffer* getChunk(uint32_t frame_id, uint32_t offset) const;
+
+            VramBuffer* createChunk() const;
+
+        public:
+            // specifying the memory layout of an element (should not be changed once data was pushed)
+
+            void setAttribute(uint32_t index, const FixedType& type);
+            void setAttributes(const BufferLayout& layout);
+
+            // the size of the buffers the elements are stored in (call before finalizeLayout())
+            void setChunkSize(uint32_t byte_size);
+
+            // call this after the layout + max frames in flight have been set
+            // and before pushing any data
+            void finalizeLayout();
+
+        public:
+            // setting data
+
+            // storing data in the element that gets pushed next
+            void setData(uint32_t index, const void* data, uint32_t byte_size);
+
+            // appends the element to the arena of the current frame
+            // @return the offset to submit to the renderer together with the buffer
+            uint32_t push();
+            uint32_t push(const void* data, uint32_t byte_size); // data of a whole element
+
+        public:
+            // statistics
+
+            uint32_t getElementStride() const;
+            uint32_t getUsedSize() const; // bytes pushed in the current frame
+            uint32_t getPeakSize() const; // max bytes pushed in one frame
+
+        };
+
+    } // graphics
+
+} // undicht
+
+#endif // DYNAMIC_UNIFORM_BUFFER_H
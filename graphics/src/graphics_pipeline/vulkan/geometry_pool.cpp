@@ -0,0 +1,137 @@
+#include "graphics_pipeline/vulkan/geometry_pool.h"
+#include "debug.h"
+
+namespace undicht {
+
+    namespace graphics {
+
+        GeometryPool::GeometryPool(const GraphicsDevice* device) : m_vbo(device) {
+
+        }
+
+        ////////////////////////////////////// specifying the vertex layout ///////////////////////////////////////
+
+        void GeometryPool::setVertexAttributes(const BufferLayout& layout) {
+
+            m_vbo.setVertexAttributes(layout);
+        }
+
+        void GeometryPool::setVertexAttribute(uint32_t index, const FixedType& type) {
+
+            m_vbo.setVertexAttribute(index, type);
+        }
+
+        const BufferLayout& GeometryPool::getVertexAttributes() const {
+
+            return m_vbo.getVertexAttributes();
+        }
+
+        //////////////////////////////////////////////// adding meshes ////////////////////////////////////////////////
+
+        uint32_t GeometryPool::addMesh(const std::vector<float>& vertices, const std::vector<int>& indices) {
+            /** stores the mesh in the pool (the data gets transferred to the gpu with the next upload())
+            * meshes without indices get drawn in the order the vertices are stored in
+            * meshes with indices outside of their vertices are not added
+            * @return the id of the mesh, used to draw it (INVALID_MESH_ID if the mesh was not added) */
+
+            uint32_t vertex_size = m_vbo.getVertexAttributes().getTotalSize();
+
+            if(!vertex_size) {
+                UND_ERROR << "failed to add mesh to the geometry pool: the vertex layout has to be set first\n";
+                return INVALID_MESH_ID;
+            }
+
+            GeometryPoolMesh mesh;
+            mesh.first_index = m_indices.size();
+            mesh.vertex_offset = m_vertex_count;
+            mesh.vertex_count = vertices.size() * sizeof(float) / vertex_size;
+
+            // indices outside of the mesh would read the vertices of other meshes (or beyond the buffer)
+            for(int index : indices) {
+
+                if((index < 0) || (uint32_t(index) >= mesh.vertex_count)) {
+                    UND_ERROR << "failed to add mesh to the geometry pool: the mesh contains an invalid index (" << index << ")\n";
+                    return INVALID_MESH_ID;
+                }
+            }
+
+            if(indices.size()) {
+
+                m_indices.insert(m_indices.end(), indices.begin(), indices.end());
+            } else {
+
+                for(uint32_t i = 0; i < mesh.vertex_count; i++)
+                    m_indices.push_back(i);
+            }
+
+            mesh.index_count = m_indices.size() - mesh.first_index;
+
+            m_vertices.insert(m_vertices.end(), vertices.begin(), vertices.begin() + mesh.vertex_count * vertex_size / sizeof(float));
+            m_vertex_count += mesh.vertex_count;
+            m_meshes.push_back(mesh);
+
+            return m_meshes.size() - 1;
+        }
+
+        void GeometryPool::upload() {
+            /** transfers the meshes added since the last upload to the gpu
+            * (with one transfer for the vertices and one for the indices) */
+
+            if(m_uploaded_mesh_count == m_meshes.size())
+                return; // nothing new
+
+            const GeometryPoolMesh& first_new_mesh = m_meshes.at(m_uploaded_mesh_count);
+            uint32_t vertex_size = m_vbo.getVertexAttributes().getTotalSize();
+
+            // the new vertices get stored after the ones that were already uploaded
+            m_vbo.setVertexData(m_vertices.data(), m_vertices.size() * sizeof(float), first_new_mesh.vertex_offset * vertex_size);
+            m_vertices.clear();
+
+            // the indices of all meshes are kept, since they have to be stored again if the index type changes
+            bool fits_index_type = true;
+            for(uint32_t i = first_new_mesh.first_index; (i < m_indices.size()) && fits_index_type; i++)
+                fits_index_type = (m_vbo.getIndexType() == UND_UINT32) || (m_indices.at(i) <= 0xFFFF);
+
+            if(!m_uploaded_mesh_count || !fits_index_type) {
+                // (re)storing all indices, choosing the smallest index type
+                m_vbo.setIndexData(m_indices);
+            } else {
+
+                std::vector<uint32_t> new_indices(m_indices.begin() + first_new_mesh.first_index, m_indices.end());
+                m_vbo.setIndexData(new_indices, first_new_mesh.first_index * m_vbo.getIndexType().getSize());
+            }
+
+            m_uploaded_mesh_count = m_meshes.size();
+        }
+
+        void GeometryPool::clear() {
+            /** removes all meshes from the pool (the memory on the gpu is kept for new meshes) */
+
+            m_vertices.clear();
+            m_indices.clear();
+            m_meshes.clear();
+            m_uploaded_mesh_count = 0;
+            m_vertex_count = 0;
+        }
+
+        /////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+        uint32_t GeometryPool::getMeshCount() const {
+
+            return m_meshes.size();
+        }
+
+        const GeometryPoolMesh& GeometryPool::getMesh(uint32_t mesh_id) const {
+
+            return m_meshes.at(mesh_id);
+        }
+
+        const VertexBuffer& GeometryPool::getVertexBuffer() const {
+            /** the buffer containing all meshes (can be used as the vertex buffer layout prototype for renderers) */
+
+            return m_vbo;
+        }
+
+    } // graphics
+
+} // undicht
@@ -0,0 +1,94 @@
+#ifndef GEOMETRY_POOL_H
+#define GEOMETRY_POOL_H
+
+#include "core/vulkan/vulkan_declaration.h"
+#include "graphics_pipeline/vulkan/vertex_buffer.h"
+#include "buffer_layout.h"
+
+#include "vector"
+
+namespace undicht {
+
+    namespace graphics {
+
+        class GraphicsDevice;
+        class Renderer;
+        class DrawRecorder;
+
+        struct GeometryPoolMesh {
+            /** the part of the pools buffers used by one mesh */
+
+            uint32_t first_index = 0; // in the index buffer
+            uint32_t index_count = 0;
+            int32_t vertex_offset = 0; // gets added to the indices of the mesh
+            uint32_t vertex_count = 0;
+        };
+
+        class GeometryPool {
+            /** packs the vertices + indices of many meshes (with the same vertex layout) into one vertex and one index buffer
+            * so that all meshes of a scene can be drawn without binding a new vertex buffer per mesh
+            * the indices of each mesh stay relative to its first vertex (drawn with a vertex offset),
+            * so they can still be stored as 16 bit indices if every single mesh has less than 65536 vertices */
+
+        private:
+
+            VertexBuffer m_vbo;
+
+            // the data of the meshes added since the last upload()
+            std::vector<float> m_vertices;
+            std::vector<uint32_t> m_indices;
+
+            std::vector<GeometryPoolMesh> m_meshes;
+            uint32_t m_uploaded_mesh_count = 0;
+            uint32_t m_vertex_count = 0;
+
+            friend GraphicsDevice;
+            friend Renderer;
+            friend DrawRecorder;
+
+            GeometryPool(const GraphicsDevice* device);
+
+        public:
+
+            static const uint32_t INVALID_MESH_ID = uint32_t(-1); // returned by addMesh() if the mesh could not be added
+
+            virtual ~GeometryPool() = default;
+
+        public:
+            // specifying the vertex layout (has to be done before adding meshes)
+
+            void setVertexAttributes(const BufferLayout& layout);
+            void setVertexAttribute(uint32_t index, const FixedType& type);
+            const BufferLayout& getVertexAttributes() const;
+
+        public:
+            // adding meshes
+
+            /** stores the mesh in the pool (the data gets transferred to the gpu with the next upload())
+            * meshes without indices get drawn in the order the vertices are stored in
+            * meshes with indices outside of their vertices are not added
+            * @return the id of the mesh, used to draw it (INVALID_MESH_ID if the mesh was not added) */
+            uint32_t addMesh(const std::vector<float>& vertices, const std::vector<int>& indices);
+
+            /** transfers the meshes added since the last upload to the gpu
+            * (with one transfer for the vertices and one for the indices) */
+            void upload();
+
+            /** removes all meshes from the pool (the memory on the gpu is kept for new meshes) */
+            void clear();
+
+        public:
+
+            uint32_t getMeshCount() const;
+            const GeometryPoolMesh& getMesh(uint32_t mesh_id) const;
+
+            /** the buffer containing all meshes (can be used as the vertex buffer layout prototype for renderers) */
+            const VertexBuffer& getVertexBuffer() const;
+
+        };
+
+    } // graphics
+
+} // undicht
+
+#endif // GEOMETRY_POOL_H
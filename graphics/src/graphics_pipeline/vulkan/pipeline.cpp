@@ -11,17 +11,20 @@ namespace undicht {
 
     namespace graphics {
 
-        Pipeline::Pipeline(const GraphicsDevice* device) {
+        Pipeline::Pipeline(const GraphicsDevice* device) : m_shader_descriptors(device) {
 
             m_device_handle = device;
 
             m_vertex_bindings = new std::vector<vk::VertexInputBindingDescription>;
             m_vertex_attributes = new std::vector<vk::VertexInputAttributeDescription>;
             m_shader_layout = new vk::DescriptorSetLayout;
-            m_shader_input_descriptor_pool = new vk::DescriptorPool;
-            m_shader_descriptors = new std::vector<vk::DescriptorSet>;
             m_layout = new vk::PipelineLayout;
             m_pipeline = new vk::Pipeline;
+            m_bindless_layout = new vk::DescriptorSetLayout;
+            m_bindless_pool = new vk::DescriptorPool;
+            m_bindless_descriptor = new vk::DescriptorSet;
+            m_set_layouts = new std::vector<vk::DescriptorSetLayout>;
+            m_push_constant_range = new vk::PushConstantRange;
 
         }
 
@@ -32,10 +35,13 @@ namespace undicht {
             delete m_vertex_bindings;
             delete m_vertex_attributes;
             delete m_shader_layout;
-            delete m_shader_input_descriptor_pool;
-            delete m_shader_descriptors;
             delete m_layout;
             delete m_pipeline;
+            delete m_bindless_layout;
+            delete m_bindless_pool;
+            delete m_bindless_descriptor;
+            delete m_set_layouts;
+            delete m_push_constant_range;
         }
 
         void Pipeline::cleanUp() {
@@ -59,11 +65,47 @@ namespace undicht {
 
         }
 
-        void Pipeline::setShaderInput(uint32_t ubo_count, uint32_t tex_count) {
+        void Pipeline::setShaderInput(uint32_t ubo_count, uint32_t tex_count, uint32_t dynamic_ubo_count) {
+            // the bindings are: ubos, dynamic ubos, textures
 
-            createShaderInputLayout(ubo_count, tex_count);
-            createShaderInputDescriptorPool(ubo_count, tex_count, 400);
-            createShaderInputDescriptors(ubo_count, tex_count, 400);
+            createShaderInputLayout(ubo_count, tex_count, dynamic_ubo_count);
+
+            // the descriptor sets get allocated when they are first used
+            if(ubo_count || tex_count || dynamic_ubo_count)
+                m_shader_descriptors.setLayout(m_shader_layout, ubo_count, tex_count, dynamic_ubo_count);
+        }
+
+        void Pipeline::setBindlessTextures(uint32_t max_textures) {
+            // an array of textures in set 1, binding 0 (requires descriptor indexing, see GraphicsDevice::supportsBindlessTextures())
+
+            if(!m_device_handle->supportsBindlessTextures()) {
+                UND_ERROR << "failed to enable bindless textures: descriptor indexing is not supported by the device\n";
+                return;
+            }
+
+            if(max_textures > m_device_handle->getMaxBindlessTextures()) {
+                UND_WARNING << "bindless textures: the device supports only " << m_device_handle->getMaxBindlessTextures() << " textures\n";
+                max_textures = m_device_handle->getMaxBindlessTextures();
+            }
+
+            createBindlessTextureDescriptor(max_textures);
+        }
+
+        void Pipeline::setPushConstantSize(uint32_t byte_size) {
+            // the size of the push constant block in the shaders (in bytes, the device supports at least 128)
+
+            if(byte_size > m_device_handle->getMaxPushConstantSize()) {
+                UND_ERROR << "failed to set the push constant size: the device supports only " << m_device_handle->getMaxPushConstantSize() << " bytes\n";
+                return;
+            }
+
+            if(byte_size % 4) {
+                UND_ERROR << "failed to set the push constant size: the size has to be a multiple of 4\n";
+                return;
+            }
+
+            m_push_constant_size = byte_size;
+            *m_push_constant_range = vk::PushConstantRange(vk::ShaderStageFlagBits::eAllGraphics, 0, byte_size);
         }
 
         void Pipeline::setShader(Shader* shader) {
@@ -173,7 +215,7 @@ namespace undicht {
 
         }
 
-        void Pipeline::createShaderInputLayout(unsigned ubo_count, unsigned tex_count) {
+        void Pipeline::createShaderInputLayout(unsigned ubo_count, unsigned tex_count, unsigned dynamic_ubo_count) {
 
             // describes a ubo binding
             vk::DescriptorSetLayoutBinding uniform_layout_binding;
@@ -181,6 +223,10 @@ namespace undicht {
             uniform_layout_binding.descriptorType = vk::DescriptorType::eUniformBuffer;
             uniform_layout_binding.stageFlags = vk::ShaderStageFlagBits::eAllGraphics;
 
+            // describes a dynamic ubo binding (the offset into the buffer is set when binding the descriptor set)
+            vk::DescriptorSetLayoutBinding dynamic_uniform_layout_binding = uniform_layout_binding;
+            dynamic_uniform_layout_binding.descriptorType = vk::DescriptorType::eUniformBufferDynamic;
+
             // describes a sampler binding
             vk::DescriptorSetLayoutBinding sampler_layout_binding;
             sampler_layout_binding.descriptorCount = 1;
@@ -196,8 +242,13 @@ namespace undicht {
                 bindings.push_back(uniform_layout_binding);
             }
 
+            for(int i = 0; i < dynamic_ubo_count; i++) {
+                dynamic_uniform_layout_binding.binding = i + ubo_count;
+                bindings.push_back(dynamic_uniform_layout_binding);
+            }
+
             for(int i = 0; i < tex_count; i++) {
-                sampler_layout_binding.binding = i + ubo_count;
+                sampler_layout_binding.binding = i + ubo_count + dynamic_ubo_count;
                 bindings.push_back(sampler_layout_binding);
             }
 
@@ -207,45 +258,53 @@ namespace undicht {
 
         }
 
-        void Pipeline::createShaderInputDescriptorPool(unsigned ubo_count, unsigned tex_count, unsigned num_draw_calls) {
-
-            uint32_t max_frames_in_flight = m_device_handle->getMaxFramesInFlight();
-
-            // determining the size of the descriptor pool
-            vk::DescriptorPoolSize ubo_pool_size(vk::DescriptorType::eUniformBuffer, max_frames_in_flight * ubo_count * num_draw_calls);
-            vk::DescriptorPoolSize tex_pool_size(vk::DescriptorType::eCombinedImageSampler, max_frames_in_flight * tex_count * num_draw_calls);
+        void Pipeline::createBindlessTextureDescriptor(uint32_t max_textures) {
 
-            std::vector<vk::DescriptorPoolSize> pool_sizes;
-
-            if(ubo_count)
-                pool_sizes.push_back(ubo_pool_size);
-
-            if(tex_count)
-                pool_sizes.push_back(tex_pool_size);
-
-            if(pool_sizes.size()) {
-                vk::DescriptorPoolCreateInfo info({}, max_frames_in_flight * num_draw_calls, pool_sizes, nullptr);
-                *m_shader_input_descriptor_pool = m_device_handle->m_device->createDescriptorPool(info);
+            if(m_bindless_texture_count) {
+                m_device_handle->m_device->destroyDescriptorPool(*m_bindless_pool);
+                m_device_handle->m_device->destroyDescriptorSetLayout(*m_bindless_layout);
             }
 
+            // the textures get registered once and stay in the array
+            // (not all elements have to be valid + elements can be written while other elements are used by the gpu)
+            vk::DescriptorSetLayoutBinding binding;
+            binding.binding = 0;
+            binding.descriptorCount = max_textures;
+            binding.descriptorType = vk::DescriptorType::eCombinedImageSampler;
+            binding.stageFlags = vk::ShaderStageFlagBits::eFragment;
+            binding.pImmutableSamplers = nullptr;
+
+            vk::DescriptorBindingFlags binding_flags;
+            binding_flags |= vk::DescriptorBindingFlagBits::ePartiallyBound;
+            binding_flags |= vk::DescriptorBindingFlagBits::eUpdateAfterBind;
+            binding_flags |= vk::DescriptorBindingFlagBits::eUpdateUnusedWhilePending;
+
+            vk::DescriptorSetLayoutBindingFlagsCreateInfo flags_info(binding_flags);
+            vk::DescriptorSetLayoutCreateInfo layout_info(vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPool, binding);
+            layout_info.pNext = &flags_info;
+            *m_bindless_layout = m_device_handle->m_device->createDescriptorSetLayout(layout_info);
+
+            // one set that is used by all frames
+            vk::DescriptorPoolSize pool_size(vk::DescriptorType::eCombinedImageSampler, max_textures);
+            vk::DescriptorPoolCreateInfo pool_info(vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind, 1, pool_size);
+            *m_bindless_pool = m_device_handle->m_device->createDescriptorPool(pool_info);
+
+            vk::DescriptorSetAllocateInfo allocate_info(*m_bindless_pool, *m_bindless_layout);
+            *m_bindless_descriptor = m_device_handle->m_device->allocateDescriptorSets(allocate_info).at(0);
+
+            m_bindless_texture_count = max_textures;
         }
 
-        void Pipeline::createShaderInputDescriptors(unsigned ubo_count, unsigned tex_count, unsigned num_draw_calls) {
+        vk::DescriptorSet* Pipeline::getShaderInputDescriptor(unsigned frame, unsigned draw_call) {
+            // more descriptor sets get allocated if necessary
 
-            if(!(ubo_count || tex_count)) // no input
-                return;
-
-            std::vector<vk::DescriptorSetLayout> layouts(m_device_handle->getMaxFramesInFlight() * num_draw_calls, *m_shader_layout);
-            vk::DescriptorSetAllocateInfo info(*m_shader_input_descriptor_pool, layouts);
-            info.setDescriptorSetCount(m_device_handle->getMaxFramesInFlight() * num_draw_calls);
-
-            // allocate descriptor sets (destroyed when the descriptor pool is destroyed)
-            *m_shader_descriptors = m_device_handle->m_device->allocateDescriptorSets(info);
+            return m_shader_descriptors.getDescriptorSet(frame, draw_call);
         }
 
-        vk::DescriptorSet* Pipeline::getShaderInputDescriptor(unsigned frame, unsigned draw_call) const {
+        void Pipeline::resetShaderInputDescriptors(unsigned frame) {
+            // the descriptor sets of the frame will be reused
 
-            return &m_shader_descriptors->at(frame + m_device_handle->getMaxFramesInFlight() * draw_call);
+            m_shader_descriptors.reset(frame);
         }
 
 
@@ -289,8 +348,19 @@ namespace undicht {
 
             vk::PipelineLayoutCreateInfo pipeline_layout;
 
-            pipeline_layout.pSetLayouts = m_shader_layout;
-            pipeline_layout.setLayoutCount = 1;
+            // set 0: ubos + textures, set 1: bindless textures
+            m_set_layouts->assign(1, *m_shader_layout);
+
+            if(m_bindless_texture_count)
+                m_set_layouts->push_back(*m_bindless_layout);
+
+            pipeline_layout.pSetLayouts = m_set_layouts->data();
+            pipeline_layout.setLayoutCount = m_set_layouts->size();
+
+            if(m_push_constant_size) {
+                pipeline_layout.pPushConstantRanges = m_push_constant_range;
+                pipeline_layout.pushConstantRangeCount = 1;
+            }
 
             return pipeline_layout;
         }
@@ -312,7 +382,13 @@ namespace undicht {
 
         void Pipeline::destroyStaticPipelineObjects() {
 
-            m_device_handle->m_device->destroyDescriptorPool(*m_shader_input_descriptor_pool);
+            m_shader_descriptors.cleanUp();
+
+            if(m_bindless_texture_count) {
+                m_device_handle->m_device->destroyDescriptorPool(*m_bindless_pool);
+                m_device_handle->m_device->destroyDescriptorSetLayout(*m_bindless_layout);
+                m_bindless_texture_count = 0;
+            }
             m_device_handle->m_device->destroyDescriptorSetLayout(*m_shader_layout);
 
         }
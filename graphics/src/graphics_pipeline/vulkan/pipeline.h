@@ -9,6 +9,7 @@
 #include "buffer_layout.h"
 #include "shader.h"
 #include "vertex_buffer.h"
+#include "descriptor_allocator.h"
 #include "core/vulkan/swap_chain.h"
 
 namespace undicht {
@@ -18,12 +19,14 @@ namespace undicht {
         class GraphicsDevice;
         class RenderPass;
         class Renderer;
+        class DrawRecorder;
 
         class Pipeline {
 
             friend GraphicsDevice;
             friend RenderPass;
             friend Renderer;
+            friend DrawRecorder;
 
         protected:
             // pipeline settings
@@ -46,10 +49,23 @@ namespace undicht {
 
             // describes the bindings for uniform buffers (which ids are used for what)
             vk::DescriptorSetLayout* m_shader_layout = 0;
-            // the pool from which the shader descriptor sets are allocated
-            vk::DescriptorPool* m_shader_input_descriptor_pool = 0;
             // specifies what descriptors (such as uniform buffers or samplers) are bound to shaders
-            std::vector<vk::DescriptorSet>* m_shader_descriptors = 0;
+            // (allocated from pools that grow with the number of draw calls)
+            DescriptorAllocator m_shader_descriptors;
+
+            // bindless textures (optional): one big array of textures in the second descriptor set
+            // (shared by all frames, textures are only added to it)
+            uint32_t m_bindless_texture_count = 0;
+            vk::DescriptorSetLayout* m_bindless_layout = 0;
+            vk::DescriptorPool* m_bindless_pool = 0;
+            vk::DescriptorSet* m_bindless_descriptor = 0;
+
+            // small data that is stored directly in the command buffer (visible to all shader stages)
+            vk::PushConstantRange* m_push_constant_range = 0;
+            uint32_t m_push_constant_size = 0;
+
+            // the layouts of all descriptor sets used by the pipeline
+            std::vector<vk::DescriptorSetLayout>* m_set_layouts = 0;
 
             vk::RenderPass* m_render_pass = 0;
 
@@ -76,7 +92,12 @@ namespace undicht {
             // settings
 
             virtual void setVertexBufferLayout(const VertexBuffer& vbo_prototype);
-            virtual void setShaderInput(uint32_t ubo_count, uint32_t tex_count);
+            // the bindings are: ubos, dynamic ubos, textures
+            virtual void setShaderInput(uint32_t ubo_count, uint32_t tex_count, uint32_t dynamic_ubo_count = 0);
+            // an array of textures in set 1, binding 0 (requires descriptor indexing, see GraphicsDevice::supportsBindlessTextures())
+            virtual void setBindlessTextures(uint32_t max_textures);
+            // the size of the push constant block in the shaders (in bytes, the device supports at least 128)
+            virtual void setPushConstantSize(uint32_t byte_size);
             virtual void setShader(Shader* shader);
             virtual void setViewport(unsigned width, unsigned height);
             virtual void setFramebufferLayout(const Framebuffer& fbo); // dont destroy the fbo before the pipeline
@@ -97,9 +118,8 @@ namespace undicht {
             // used to tell the render pass which textures and uniform buffers are bound for each draw call
             // since there can be more than one draw call per render pass
             // you may need more than one descriptor per render pass (one for each change of texture / uniform)
-            void createShaderInputLayout(unsigned ubo_count, unsigned tex_count);
-            void createShaderInputDescriptorPool(unsigned ubo_count, unsigned tex_count, unsigned num_draw_calls = 1);
-            void createShaderInputDescriptors(unsigned ubo_count, unsigned tex_count, unsigned num_draw_calls = 1);
+            void createShaderInputLayout(unsigned ubo_count, unsigned tex_count, unsigned dynamic_ubo_count = 0);
+            void createBindlessTextureDescriptor(uint32_t max_textures);
 
         protected:
             // getting pipeline setting objects
@@ -110,7 +130,10 @@ namespace undicht {
             vk::PipelineLayoutCreateInfo getShaderInputLayout() const;
             vk::PipelineDepthStencilStateCreateInfo getDepthStencilInfo() const;
 
-            vk::DescriptorSet* getShaderInputDescriptor(unsigned frame, unsigned draw_call) const;
+            // more descriptor sets get allocated if necessary
+            vk::DescriptorSet* getShaderInputDescriptor(unsigned frame, unsigned draw_call);
+            // the descriptor sets of the frame will be reused
+            void resetShaderInputDescriptors(unsigned frame);
 
         protected:
             // destroying the pipeline
@@ -4,20 +4,42 @@ namespace undicht {
 
     namespace graphics {
 
-        RenderPass::RenderPass(const GraphicsDevice* device) {
+        RenderPass::RenderPass(const GraphicsDevice* device, bool secondary) {
+            // secondary: the commands are recorded into secondary command buffers,
+            // which get executed within the render pass of a primary one (see executeCommands())
 
             m_device_handle = device;
+            m_secondary = secondary;
             m_cmd_buffers = new std::vector<vk::CommandBuffer>;
 
+            vk::CommandPool* cmd_pool = m_device_handle->m_graphics_command_pool;
+
+            if(m_secondary) {
+                // each secondary render pass gets its own pool, so that they can be recorded by different threads
+                vk::CommandPoolCreateInfo cmd_pool_info;
+                cmd_pool_info.setFlags(vk::CommandPoolCreateFlagBits::eResetCommandBuffer);
+                cmd_pool_info.setQueueFamilyIndex(m_device_handle->m_graphics_queue_id);
+
+                m_cmd_pool = new vk::CommandPool;
+                *m_cmd_pool = m_device_handle->m_device->createCommandPool(cmd_pool_info);
+                cmd_pool = m_cmd_pool;
+            }
+
             // create a command buffer for every frame
             unsigned max_frames = m_device_handle->getMaxFramesInFlight();
-            vk::CommandBufferAllocateInfo allocate_info(*m_device_handle->m_graphics_command_pool, vk::CommandBufferLevel::ePrimary, max_frames);
+            vk::CommandBufferLevel level = m_secondary ? vk::CommandBufferLevel::eSecondary : vk::CommandBufferLevel::ePrimary;
+            vk::CommandBufferAllocateInfo allocate_info(*cmd_pool, level, max_frames);
             *m_cmd_buffers = m_device_handle->m_device->allocateCommandBuffers(allocate_info);
 
         }
 
         RenderPass::~RenderPass() {
 
+            // the command buffers are freed together with the pool
+            if(m_cmd_pool)
+                m_device_handle->m_device->destroyCommandPool(*m_cmd_pool);
+
+            delete m_cmd_pool;
             delete m_cmd_buffers;
         }
 
@@ -25,7 +47,8 @@ namespace undicht {
 
         //////////////////////////////////////////// recording commands ////////////////////////////////////////////
 
-        void RenderPass::beginRenderPass(const vk::RenderPass* render_pass, const Framebuffer* fbo, std::vector<vk::ClearValue>* clear_values, vk::Extent2D view_port) {
+        void RenderPass::beginRenderPass(const vk::RenderPass* render_pass, const Framebuffer* fbo, std::vector<vk::ClearValue>* clear_values, vk::Extent2D view_port, bool secondary_commands) {
+            // secondary_commands: the render pass only executes secondary command buffers (no other commands can be recorded)
 
             unsigned frame = m_device_handle->getCurrentFrameID();
 
@@ -39,7 +62,8 @@ namespace undicht {
             // beginning the new render pass
             vk::Rect2D render_area(vk::Offset2D(0,0), view_port);
             vk::RenderPassBeginInfo render_pass_info(*render_pass, *fbo->getCurrentFramebuffer(), render_area, *clear_values);
-            m_cmd_buffers->at(frame).beginRenderPass(render_pass_info, vk::SubpassContents::eInline);
+            vk::SubpassContents contents = secondary_commands ? vk::SubpassContents::eSecondaryCommandBuffers : vk::SubpassContents::eInline;
+            m_cmd_buffers->at(frame).beginRenderPass(render_pass_info, contents);
 
             // next the commands should be called
         }
@@ -56,6 +80,42 @@ namespace undicht {
 
         }
 
+        void RenderPass::beginSecondary(const vk::RenderPass* render_pass, const Framebuffer* fbo) {
+            // begins the secondary command buffer, which continues the render pass of a primary one
+            // (can be called from a different thread than the primary render pass)
+
+            unsigned frame = m_device_handle->getCurrentFrameID();
+
+            m_cmd_buffers->at(frame).reset();
+
+            // the commands are recorded for the first subpass of the render pass
+            vk::CommandBufferInheritanceInfo inheritance_info(*render_pass, 0, *fbo->getCurrentFramebuffer());
+            vk::CommandBufferBeginInfo begin_info(vk::CommandBufferUsageFlagBits::eRenderPassContinue | vk::CommandBufferUsageFlagBits::eOneTimeSubmit, &inheritance_info);
+            m_cmd_buffers->at(frame).begin(begin_info);
+
+        }
+
+        void RenderPass::endSecondary() {
+
+            unsigned frame = m_device_handle->getCurrentFrameID();
+
+            m_cmd_buffers->at(frame).end();
+        }
+
+        void RenderPass::executeCommands(const std::vector<RenderPass*>& secondary) {
+            // executes the secondary command buffers (in order) within the render pass
+
+            unsigned frame = m_device_handle->getCurrentFrameID();
+
+            std::vector<vk::CommandBuffer> cmd_buffers;
+            for(const RenderPass* render_pass : secondary)
+                cmd_buffers.push_back(render_pass->m_cmd_buffers->at(frame));
+
+            if(cmd_buffers.size())
+                m_cmd_buffers->at(frame).executeCommands(cmd_buffers);
+
+        }
+
         //////////////////////////////////////////// commands ////////////////////////////////////////////
 
         void RenderPass::bindPipeline(const vk::Pipeline* pipe) {
@@ -77,27 +137,34 @@ namespace undicht {
                 m_cmd_buffers->at(frame).bindVertexBuffers(1, *vbo->m_instance_data.m_buffer, {0});
 
             if(vbo->usesIndices())
-                m_cmd_buffers->at(frame).bindIndexBuffer(*vbo->m_index_data.m_buffer, 0, vk::IndexType::eUint32);
+                m_cmd_buffers->at(frame).bindIndexBuffer(*vbo->m_index_data.m_buffer, 0, (vbo->getIndexType() == UND_UINT16) ? vk::IndexType::eUint16 : vk::IndexType::eUint32);
+
+        }
+
+        void RenderPass::bindDescriptorSets(const vk::PipelineLayout* layout, const vk::DescriptorSet* descriptors, const std::vector<uint32_t>& dynamic_offsets, uint32_t set) {
+
+            unsigned frame = m_device_handle->getCurrentFrameID();
+            m_cmd_buffers->at(frame).bindDescriptorSets(vk::PipelineBindPoint::eGraphics, *layout, set, *descriptors, dynamic_offsets);
 
         }
 
-        void RenderPass::bindDescriptorSets(const vk::PipelineLayout* layout, const vk::DescriptorSet* descriptors) {
+        void RenderPass::pushConstants(const vk::PipelineLayout* layout, const void* data, uint32_t byte_size, uint32_t offset) {
 
             unsigned frame = m_device_handle->getCurrentFrameID();
-            m_cmd_buffers->at(frame).bindDescriptorSets(vk::PipelineBindPoint::eGraphics, *layout, 0, *descriptors, nullptr);
+            m_cmd_buffers->at(frame).pushConstants(*layout, vk::ShaderStageFlagBits::eAllGraphics, offset, byte_size, data);
 
         }
 
-        void RenderPass::draw(uint32_t vertex_count, bool use_indices, uint32_t instances) {
+        void RenderPass::draw(uint32_t vertex_count, bool use_indices, uint32_t instances, uint32_t first, int32_t vertex_offset, uint32_t first_instance) {
 
             unsigned frame = m_device_handle->getCurrentFrameID();
 
             if(use_indices) {
 
-                m_cmd_buffers->at(frame).drawIndexed(vertex_count, instances, 0, 0, 0);
+                m_cmd_buffers->at(frame).drawIndexed(vertex_count, instances, first, vertex_offset, first_instance);
             } else {
 
-                m_cmd_buffers->at(frame).draw(vertex_count, instances, 0, 0);
+                m_cmd_buffers->at(frame).draw(vertex_count, instances, first, first_instance);
             }
 
         }
@@ -112,6 +179,7 @@ namespace undicht {
             info->commandBufferCount = 1;
             info->pCommandBuffers = &m_cmd_buffers->at(frame);
 
+            std::lock_guard<std::mutex> lock(*m_device_handle->m_queue_mutex);
             queue->submit(1, info, *finished_fence);
         }
 
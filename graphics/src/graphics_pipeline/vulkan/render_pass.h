@@ -23,25 +23,47 @@ namespace undicht {
             // one for each frame
             std::vector<vk::CommandBuffer>* m_cmd_buffers = 0;
 
+            // secondary command buffers are allocated from a pool owned by the render pass
+            // (command pools may only be used by one thread at a time)
+            vk::CommandPool* m_cmd_pool = 0;
+            bool m_secondary = false;
 
         public:
 
-            RenderPass(const GraphicsDevice* device);
+            // secondary: the commands are recorded into secondary command buffers,
+            // which get executed within the render pass of a primary one (see executeCommands())
+            RenderPass(const GraphicsDevice* device, bool secondary = false);
             virtual ~RenderPass();
 
         public:
             // recording commands
 
-            void beginRenderPass(const vk::RenderPass* render_pass, const Framebuffer* fbo, std::vector<vk::ClearValue>* clear_values, vk::Extent2D view_port); // call this before recording any commands
+            // secondary_commands: the render pass only executes secondary command buffers (no other commands can be recorded)
+            void beginRenderPass(const vk::RenderPass* render_pass, const Framebuffer* fbo, std::vector<vk::ClearValue>* clear_values, vk::Extent2D view_port, bool secondary_commands = false); // call this before recording any commands
             void endRenderPass();
 
+            // begins the secondary command buffer, which continues the render pass of a primary one
+            // (can be called from a different thread than the primary render pass)
+            void beginSecondary(const vk::RenderPass* render_pass, const Framebuffer* fbo);
+            void endSecondary();
+
+            // executes the secondary command buffers (in order) within the render pass
+            void executeCommands(const std::vector<RenderPass*>& secondary);
+
         public:
             // commands
 
             void bindPipeline(const vk::Pipeline* pipe);
             void bindVertexBuffer(const VertexBuffer* vbo);
-            void bindDescriptorSets(const vk::PipelineLayout* layout, const vk::DescriptorSet* descriptors);
-            void draw(uint32_t vertex_count, bool use_indices = false, uint32_t instances = 1);
+            // dynamic_offsets: one for each dynamic uniform buffer (in the order of their bindings)
+            // set: the number of the set in the shader
+            void bindDescriptorSets(const vk::PipelineLayout* layout, const vk::DescriptorSet* descriptors, const std::vector<uint32_t>& dynamic_offsets = {}, uint32_t set = 0);
+            // offset + byte_size: in bytes, have to be multiples of 4
+            void pushConstants(const vk::PipelineLayout* layout, const void* data, uint32_t byte_size, uint32_t offset = 0);
+            // first: the first index (or vertex, if no indices are used) to draw
+            // vertex_offset: gets added to every index before reading the vertex
+            // first_instance: the instance index of the first instance (also the first instance data to read)
+            void draw(uint32_t vertex_count, bool use_indices = false, uint32_t instances = 1, uint32_t first = 0, int32_t vertex_offset = 0, uint32_t first_instance = 0);
 
 
         public:
@@ -6,6 +6,7 @@
 
 #include "vector"
 #include "tuple"
+#include "algorithm"
 
 #include "core/vulkan/graphics_device.h"
 
@@ -27,6 +28,10 @@ namespace undicht {
             for(vk::Fence& fence : *m_render_finished)
                 fence = m_device_handle->m_device->createFence(vk::FenceCreateInfo());
 
+            // the recorder used by the draw functions of the renderer
+            m_recorders.push_back(new DrawRecorder(this));
+            m_shader_input_mutex = new std::mutex;
+
 		}
 
 		Renderer::~Renderer() {
@@ -36,6 +41,14 @@ namespace undicht {
             // actual pipeline objects
             delete m_render_finished;
 
+            for(DrawRecorder* recorder : m_recorders)
+                delete recorder;
+
+            for(RenderPass* render_pass : m_secondary_passes)
+                delete render_pass;
+
+            delete m_shader_input_mutex;
+
 		}
 
         void Renderer::cleanUp() {
@@ -65,16 +78,34 @@ namespace undicht {
         }
 
 
-        void Renderer::setShaderInput(uint32_t ubo_count, uint32_t tex_count) {
+        void Renderer::setShaderInput(uint32_t ubo_count, uint32_t tex_count, uint32_t dynamic_ubo_count) {
+            // the bindings are: ubos, dynamic ubos, textures
+
+            for(DrawRecorder* recorder : m_recorders)
+                recorder->setShaderInput(ubo_count, tex_count, dynamic_ubo_count);
+
+            // the descriptor sets of the pipeline get recreated
+            m_descriptor_cache.assign(m_device_handle->getMaxFramesInFlight(), std::map<ShaderInputKey, uint32_t>());
+            m_descriptor_contents.assign(m_device_handle->getMaxFramesInFlight(), std::vector<ShaderInputKey>());
+            m_free_descriptors.assign(m_device_handle->getMaxFramesInFlight(), std::vector<uint32_t>());
+            m_destroyed_handles_checked.assign(m_device_handle->getMaxFramesInFlight(), m_device_handle->getDestroyedHandles()->getCount());
+
+            m_pipeline.setShaderInput(ubo_count, tex_count, dynamic_ubo_count);
 
-            m_ubos.resize(ubo_count);
-            m_textures.resize(tex_count);
+        }
+
+        void Renderer::setBindlessTextures(uint32_t max_textures) {
+            // opt in to use one big texture array (set 1, binding 0) instead of binding a texture for every draw call
+            // (check GraphicsDevice::supportsBindlessTextures() first)
 
-            m_ubos_updated_for_frame.resize(ubo_count, std::vector<bool>(m_device_handle->getMaxFramesInFlight()));
-            m_text_updated_for_frame.resize(tex_count, std::vector<bool>(m_device_handle->getMaxFramesInFlight()));
+            m_pipeline.setBindlessTextures(max_textures);
+            m_bindless_textures.clear();
+        }
 
-            m_pipeline.setShaderInput(ubo_count, tex_count);
+        void Renderer::setPushConstantSize(uint32_t byte_size) {
+            // the size of the push constant block in the shaders (in bytes, the device supports at least 128)
 
+            m_pipeline.setPushConstantSize(byte_size);
         }
 
         void Renderer::setViewport(unsigned width, unsigned height) {
@@ -98,12 +129,15 @@ namespace undicht {
 
         void Renderer::beginNewFrame(uint32_t frame_id) {
 
-            if(!renderStarted(frame_id))
-                return;
+            if(renderStarted(frame_id)) {
 
-            m_device_handle->m_device->waitForFences(1, &m_render_finished->at(frame_id), VK_TRUE,UINT64_MAX);
-            m_device_handle->m_device->resetFences(1, &m_render_finished->at(frame_id));
-            m_render_started.at(frame_id) = false;
+                m_device_handle->m_device->waitForFences(1, &m_render_finished->at(frame_id), VK_TRUE,UINT64_MAX);
+                m_device_handle->m_device->resetFences(1, &m_render_finished->at(frame_id));
+                m_render_started.at(frame_id) = false;
+            }
+
+            // the sets of the frame are no longer used by the gpu
+            updateDescriptorCache(frame_id);
 
         }
 
@@ -117,71 +151,80 @@ namespace undicht {
 
         void Renderer::submit(UniformBuffer *ubo, uint32_t index) {
 
-            if(m_ubos.size() <= index) {
-                UND_ERROR << "failed to submit ubo: the index was is to big for this renderer\n";
-                return;
-            }
+            m_recorders.at(0)->submit(ubo, index);
+        }
 
-            if(m_ubos.at(index) != ubo) {
+        void Renderer::submit(const DynamicUniformBuffer* ubo, uint32_t index, uint32_t offset) {
+            // offset: returned when pushing the data to the dynamic ubo (the index starts after the last ubo index)
 
-                std::fill(m_ubos_updated_for_frame.at(index).begin(), m_ubos_updated_for_frame.at(index).end(), false);
-                m_ubos.at(index) = ubo;
-            }
+            m_recorders.at(0)->submit(ubo, index, offset);
+        }
 
-            uint32_t current_frame = m_device_handle->getCurrentFrameID();
-            //if(!m_ubos_updated_for_frame.at(index).at(current_frame)) {
+        void Renderer::submit(const Texture* tex, uint32_t index) {
 
-                ubo->writeDescriptorSet(m_pipeline.getShaderInputDescriptor(current_frame, m_current_draw_call), index, current_frame);
-               // m_ubos_updated_for_frame.at(index).at(current_frame) = true;
-            //}
+            m_recorders.at(0)->submit(tex, index);
+        }
 
-            ubo->updateBuffer(current_frame);
+        uint32_t Renderer::registerTexture(const Texture* tex) {
+            // bindless textures: the texture is added to the texture array once
+            // (its array element is not written again, since frames in flight might use it)
+            // @return the id used to select the texture (it is passed to the shader as gl_InstanceIndex), INVALID_TEXTURE_ID on failure
 
-        }
+            if(!m_pipeline.m_bindless_texture_count) {
+                UND_ERROR << "failed to register texture: bindless textures are not enabled for this renderer\n";
+                return INVALID_TEXTURE_ID;
+            }
 
-        void Renderer::submit(const Texture* tex, uint32_t index) {
+            std::vector<const Texture*>::iterator registered = std::find(m_bindless_textures.begin(), m_bindless_textures.end(), tex);
 
-            // in the shader the texture is accessed by an index
-            // that comes after the uniform buffers
-            // calculating the actual index of the texture
-            index -= m_ubos.size();
+            if(registered != m_bindless_textures.end())
+                return registered - m_bindless_textures.begin();
 
-            if(m_textures.size() <= index) {
-                UND_ERROR << "failed to submit texture: the index is to big for this renderer\n";
-                return;
+            if(m_bindless_textures.size() >= m_pipeline.m_bindless_texture_count) {
+                UND_ERROR << "failed to register texture: the texture array is full\n";
+                return INVALID_TEXTURE_ID;
             }
 
-            if(m_textures.at(index) != tex) {
+            // the element is not used by any frame yet (UpdateUnusedWhilePending)
+            uint32_t texture_id = m_bindless_textures.size();
+            tex->writeDescriptorSet(m_pipeline.m_bindless_descriptor, 0, 0, texture_id);
+            m_bindless_textures.push_back(tex);
 
-                std::fill(m_text_updated_for_frame.at(index).begin(), m_text_updated_for_frame.at(index).end(), false);
-                m_textures.at(index) = tex;
-            }
+            return texture_id;
+        }
 
-            uint32_t current_frame = m_device_handle->getCurrentFrameID();
-            //if(!m_text_updated_for_frame.at(index).at(current_frame)) {
+        void Renderer::selectTexture(uint32_t texture_id) {
+            // the texture used by the following draw calls
+            // (not for instanced vertex buffers, since the instance index is also used to read their instance data)
 
-                tex->writeDescriptorSet(m_pipeline.getShaderInputDescriptor(current_frame, m_current_draw_call), index + m_ubos.size(), current_frame);
-            //    m_text_updated_for_frame.at(index).at(current_frame) = true;
-            //}
+            m_recorders.at(0)->selectTexture(texture_id);
+        }
+
+        void Renderer::pushConstants(const void* data, uint32_t byte_size, uint32_t offset) {
+            // stores the data directly in the command buffer, it is used by the following draw calls
+            // (the cheapest way to change small data for every draw call, such as a model matrix)
 
+            m_recorders.at(0)->pushConstants(data, byte_size, offset);
         }
 
 		void Renderer::draw(const VertexBuffer* vbo) {
 
-            m_vbo = vbo;
-
-            uint32_t current_frame = m_device_handle->getCurrentFrameID();
+            m_recorders.at(0)->draw(vbo);
+        }
 
-            m_render_pass.bindVertexBuffer(m_vbo);
-            m_render_pass.bindDescriptorSets(m_pipeline.m_layout, m_pipeline.getShaderInputDescriptor(current_frame, m_current_draw_call));
-            m_render_pass.draw(m_vbo->getVertexCount(), m_vbo->usesIndices(), m_vbo->getInstanceCount());
+        void Renderer::draw(const GeometryPool* pool, uint32_t mesh_id) {
+            // draws one mesh of the pool (the vertex buffer is only bound if the previous draw call used a different one)
 
-            m_current_draw_call++;
+            m_recorders.at(0)->draw(pool, mesh_id);
         }
 
-        void Renderer::beginRenderPass(Framebuffer* fbo) {
+        void Renderer::beginRenderPass(Framebuffer* fbo, uint32_t recorder_count) {
+            // recorder_count: 0 records the draw calls directly into the command buffer of the render pass
+            // otherwise each recorder (see getRecorder()) records into its own secondary command buffer,
+            // so that the draw calls can be recorded by multiple threads at the same time (one per recorder)
 
             m_fbo = fbo;
+            m_recorder_count = recorder_count;
 
             m_pipeline.setFramebufferLayout(*m_fbo);
             m_pipeline.setViewport(m_fbo->getWidth(), m_fbo->getHeight());
@@ -192,21 +235,68 @@ namespace undicht {
             clear_values.at(1).depthStencil = vk::ClearDepthStencilValue(1.0f, 0.0f);
 
             // recording the command buffer
-            m_render_pass.beginRenderPass(m_pipeline.m_render_pass, m_fbo, &clear_values, {m_pipeline.m_view_width, m_pipeline.m_view_height});
-            m_render_pass.bindPipeline(m_pipeline.m_pipeline);
+            m_render_pass.beginRenderPass(m_pipeline.m_render_pass, m_fbo, &clear_values, {m_pipeline.m_view_width, m_pipeline.m_view_height}, m_recorder_count > 0);
+
+            // the command buffers the recorders record into
+            std::vector<RenderPass*> render_passes(1, &m_render_pass);
+
+            if(m_recorder_count) {
+
+                while(m_secondary_passes.size() < m_recorder_count)
+                    m_secondary_passes.push_back(new RenderPass(m_device_handle, true));
+
+                while(m_recorders.size() < m_recorder_count) {
+                    m_recorders.push_back(new DrawRecorder(this));
+                    m_recorders.back()->setShaderInput(m_recorders.at(0)->m_ubos.size(), m_recorders.at(0)->m_textures.size(), m_recorders.at(0)->m_dynamic_ubos.size());
+                }
+
+                render_passes.assign(m_secondary_passes.begin(), m_secondary_passes.begin() + m_recorder_count);
+            }
+
+            // (the pipeline has to be bound in every secondary command buffer, nothing is inherited from the primary one)
+            for(uint32_t i = 0; i < render_passes.size(); i++) {
+
+                if(m_recorder_count)
+                    render_passes.at(i)->beginSecondary(m_pipeline.m_render_pass, m_fbo);
+
+                render_passes.at(i)->bindPipeline(m_pipeline.m_pipeline);
+
+                // the texture array stays bound for the whole render pass
+                if(m_pipeline.m_bindless_texture_count)
+                    render_passes.at(i)->bindDescriptorSets(m_pipeline.m_layout, m_pipeline.m_bindless_descriptor, {}, 1);
+
+                m_recorders.at(i)->beginRecording(render_passes.at(i));
+            }
 
-            m_current_draw_call = 0;
+            m_descriptor_writes = 0;
 
         }
 
         void Renderer::endRenderPass() {
             // the renderpass will be executed by the gpu
+            // (the recorders have to be finished, their command buffers are executed in the order of their ids)
 
             uint32_t current_frame = m_device_handle->getCurrentFrameID();
 
             // ending the renderpass
+            if(m_recorder_count) {
+
+                std::vector<RenderPass*> secondary_passes(m_secondary_passes.begin(), m_secondary_passes.begin() + m_recorder_count);
+
+                for(RenderPass* render_pass : secondary_passes)
+                    render_pass->endSecondary();
+
+                m_render_pass.executeCommands(secondary_passes);
+            }
+
             m_render_pass.endRenderPass();
 
+            uint32_t draw_calls = 0;
+            for(uint32_t i = 0; i < std::max(m_recorder_count, 1u); i++)
+                draw_calls += m_recorders.at(i)->getDrawCalls();
+
+            m_peak_draw_calls = std::max(m_peak_draw_calls, draw_calls);
+
             // signal objects
             std::vector<vk::Semaphore> wait_signals = m_fbo->getImageReadySemaphores(current_frame);
             vk::Semaphore* finished_signal = &m_fbo->m_render_finished->at(current_frame); // signaled once rendering is finished
@@ -215,6 +305,9 @@ namespace undicht {
             // the stages at which to wait on the signals
             std::vector<vk::PipelineStageFlags> wait_stages(wait_signals.size(), vk::PipelineStageFlagBits::eColorAttachmentOutput); // the stage at which to wait
 
+            // the transfer commands recorded so far have to be submitted before the draw calls using their data
+            m_device_handle->getUploadManager()->submit();
+
             // submitting the command buffer
             vk::SubmitInfo submit_info(wait_signals, wait_stages, {}, *finished_signal);
             m_render_pass.submit(m_device_handle->m_graphics_queue, &submit_info, render_finished_fence);
@@ -222,6 +315,173 @@ namespace undicht {
             m_render_started.at(current_frame) = true;
         }
 
+        DrawRecorder* Renderer::getRecorder(uint32_t recorder_id) {
+            // the recorders of the current render pass (the draw functions of the renderer use recorder 0)
+
+            if(recorder_id >= std::max(m_recorder_count, 1u)) {
+                UND_ERROR << "failed to get recorder: the render pass was started with fewer recorders\n";
+                return 0;
+            }
+
+            return m_recorders.at(recorder_id);
+        }
+
+
+        ////////////////////////////////////// managing the descriptor cache //////////////////////////////////////
+
+        void Renderer::updateDescriptorCache(uint32_t frame_id) {
+            // removes the sets that reference destroyed buffers / images from the cache of the frame
+            // (called at the start of the frame, once the gpu is done with its sets)
+
+            if(!m_recorders.at(0)->m_shader_input.size())
+                return; // no shader input
+
+            std::lock_guard<std::mutex> lock(*m_shader_input_mutex);
+
+            std::map<ShaderInputKey, uint32_t>& cache = m_descriptor_cache.at(frame_id);
+            std::vector<ShaderInputKey>& contents = m_descriptor_contents.at(frame_id);
+            std::vector<uint32_t>& free_descriptors = m_free_descriptors.at(frame_id);
+
+            // a new buffer / image view might get the handle of a destroyed one
+            std::vector<uint64_t> destroyed;
+            if(!m_device_handle->getDestroyedHandles()->getDestroyedSince(m_destroyed_handles_checked.at(frame_id), destroyed)) {
+                // too many handles were destroyed since the last check, all sets get rewritten
+                cache.clear();
+                contents.clear();
+                free_descriptors.clear();
+            }
+
+            if(destroyed.size()) {
+
+                std::sort(destroyed.begin(), destroyed.end());
+
+                std::map<ShaderInputKey, uint32_t>::iterator entry = cache.begin();
+                while(entry != cache.end()) {
+
+                    bool outdated = false;
+                    for(uint64_t handle : entry->first)
+                        outdated |= std::binary_search(destroyed.begin(), destroyed.end(), handle);
+
+                    if(outdated) {
+                        free_descriptors.push_back(entry->second);
+                        entry = cache.erase(entry);
+                    } else {
+                        entry++;
+                    }
+                }
+
+                // the bindings of the destroyed resources have to be written again, even if the handle gets reused
+                for(ShaderInputKey& written : contents)
+                    for(uint64_t& handle : written)
+                        if(std::binary_search(destroyed.begin(), destroyed.end(), handle))
+                            handle = 0;
+
+            }
+
+            // the cache keeps the sets of the previous frames, until it holds twice as many sets as the busiest frame needed
+            // (the written sets are kept, so that only bindings that change have to be rewritten)
+            if(cache.size() >= 2 * std::max(m_peak_draw_calls, 64u)) {
+                cache.clear();
+                free_descriptors.clear();
+            }
+
+            m_pipeline.resetShaderInputDescriptors(frame_id);
+        }
+
+        ////////////////////////////////////// used by the recorders //////////////////////////////////////
+
+        int32_t Renderer::getShaderInputDescriptor(const DrawRecorder* recorder, vk::DescriptorSet* descriptor) {
+            // the descriptor set for the resources submitted to the recorder (taken from the cache, if possible)
+            // @return the id of the descriptor set
+
+            std::lock_guard<std::mutex> lock(*m_shader_input_mutex);
+
+            uint32_t current_frame = m_device_handle->getCurrentFrameID();
+
+            std::map<ShaderInputKey, uint32_t>& cache = m_descriptor_cache.at(current_frame);
+            std::map<ShaderInputKey, uint32_t>::iterator cached = cache.find(recorder->m_shader_input);
+
+            if(cached == cache.end()) {
+                // using a set that was removed from the cache or the next unused one
+                std::vector<uint32_t>& free_descriptors = m_free_descriptors.at(current_frame);
+                uint32_t descriptor_id = cache.size();
+
+                if(free_descriptors.size()) {
+                    descriptor_id = free_descriptors.back();
+                    free_descriptors.pop_back();
+                }
+
+                writeShaderInput(recorder, current_frame, descriptor_id);
+                cached = cache.insert(std::make_pair(recorder->m_shader_input, descriptor_id)).first;
+            }
+
+            // copying the handle, since the sets of the pipeline might get moved when new ones are allocated
+            *descriptor = *m_pipeline.getShaderInputDescriptor(current_frame, cached->second);
+
+            return cached->second;
+        }
+
+        void Renderer::writeShaderInput(const DrawRecorder* recorder, uint32_t frame, uint32_t descriptor_id) {
+            // writes the bindings of the descriptor that differ from the resources submitted to the recorder
+
+            const ShaderInputKey& shader_input = recorder->m_shader_input;
+            std::vector<ShaderInputKey>& contents = m_descriptor_contents.at(frame);
+
+            if(contents.size() <= descriptor_id)
+                contents.resize(descriptor_id + 1, ShaderInputKey(shader_input.size(), 0));
+
+            ShaderInputKey& written = contents.at(descriptor_id);
+            vk::DescriptorSet* descriptor = m_pipeline.getShaderInputDescriptor(frame, descriptor_id);
+
+            uint32_t ubo_count = recorder->m_ubos.size();
+            uint32_t dynamic_ubo_count = recorder->m_dynamic_ubos.size();
+
+            for(uint32_t binding = 0; binding < shader_input.size(); binding++) {
+
+                if(written.at(binding) == shader_input.at(binding))
+                    continue; // still up to date
+
+                if(binding < ubo_count) {
+                    recorder->m_ubos.at(binding)->writeDescriptorSet(descriptor, binding, frame);
+                } else if(binding < ubo_count + dynamic_ubo_count) {
+                    uint32_t index = binding - ubo_count;
+                    recorder->m_dynamic_ubos.at(index)->writeDescriptorSet(descriptor, binding, frame, recorder->m_dynamic_ubo_offsets.at(index));
+                } else {
+                    recorder->m_textures.at(binding - ubo_count - dynamic_ubo_count)->writeDescriptorSet(descriptor, binding, frame);
+                }
+
+                written.at(binding) = shader_input.at(binding);
+                m_descriptor_writes++;
+            }
+
+        }
+
+        void Renderer::updateUniformBuffer(UniformBuffer* ubo, uint32_t frame) {
+            // the same ubo might be submitted by multiple recorders
+
+            std::lock_guard<std::mutex> lock(*m_shader_input_mutex);
+            ubo->updateBuffer(frame);
+        }
+
+        /////////////////////////////////////// statistics /////////////////////////////////////
+
+        uint32_t Renderer::getDescriptorWrites() const {
+            // the number of resources written to descriptor sets in the current render pass
+
+            return m_descriptor_writes;
+        }
+
+        uint32_t Renderer::getPeakDrawCalls() const {
+            // the max number of draw calls recorded in one render pass
+
+            return m_peak_draw_calls;
+        }
+
+        uint32_t Renderer::getPeakDescriptorSets() const {
+            // the max number of descriptor sets used in one frame (they are allocated as needed)
+
+            return m_pipeline.m_shader_descriptors.getPeakUsedSets();
+        }
 
     } // graphics
 
@@ -7,10 +7,16 @@
 
 #include "graphics_pipeline/vulkan/shader.h"
 #include "graphics_pipeline/vulkan/vertex_buffer.h"
+#include "graphics_pipeline/vulkan/geometry_pool.h"
 #include "graphics_pipeline/vulkan/uniform_buffer.h"
+#include "graphics_pipeline/vulkan/dynamic_uniform_buffer.h"
 #include "graphics_pipeline/vulkan/texture.h"
 #include "graphics_pipeline/vulkan/pipeline.h"
 #include "graphics_pipeline/vulkan/render_pass.h"
+#include "graphics_pipeline/vulkan/draw_recorder.h"
+
+#include "map"
+#include "mutex"
 
 
 namespace undicht {
@@ -32,23 +38,41 @@ namespace undicht {
             Pipeline m_pipeline;
             RenderPass m_render_pass;
 
-            // currently submitted objects
+            // the draw calls are recorded by the recorders
+            // (directly into the command buffer of m_render_pass, or into the secondary command buffers of the render pass)
+            std::vector<DrawRecorder*> m_recorders; // recorder 0 is used by the draw functions of the renderer
+            std::vector<RenderPass*> m_secondary_passes; // one per recorder (only created when needed)
+            uint32_t m_recorder_count = 0; // recorders that record the current render pass into secondary command buffers
+
             Framebuffer* m_fbo;
-            const VertexBuffer* m_vbo = 0;
-            std::vector<const UniformBuffer*> m_ubos;
-            std::vector<const Texture*> m_textures;
 
-            std::vector<std::vector<bool>> m_text_updated_for_frame;
-            std::vector<std::vector<bool>> m_ubos_updated_for_frame; // ubo_index -> frame_index
+            // descriptor sets are cached by the resources bound to them (vulkan handles, one per binding)
+            // so that draw calls with the same resources dont have to write + bind a new set
+            // (per frame, since the ubos have a buffer for each frame in flight)
+            // entries are only removed at the start of their frame, when the gpu no longer uses the sets
+            // the cache is shared by the recorders and guarded by the mutex
+            typedef std::vector<uint64_t> ShaderInputKey;
+            std::vector<std::map<ShaderInputKey, uint32_t>> m_descriptor_cache; // frame_id -> key -> descriptor id
+            std::vector<std::vector<ShaderInputKey>> m_descriptor_contents; // frame_id -> descriptor id -> written resources
+            std::vector<std::vector<uint32_t>> m_free_descriptors; // frame_id -> ids of the sets removed from the cache
+            std::vector<uint64_t> m_destroyed_handles_checked; // frame_id -> count of the device's destroyed handles at the last check
+            std::mutex* m_shader_input_mutex = 0;
+
+            // bindless textures (the texture id is passed to the shader as the instance index)
+            std::vector<const Texture*> m_bindless_textures; // texture id -> texture
 
             // objects used in the current render pass
-            unsigned m_current_draw_call = 0;
+            unsigned m_peak_draw_calls = 0; // max draw calls of one render pass
+            uint32_t m_descriptor_writes = 0; // resources written to descriptor sets in the current render pass
 
             friend GraphicsDevice;
             friend SwapChain;
+            friend DrawRecorder;
 
         public:
 
+            static const uint32_t INVALID_TEXTURE_ID = uint32_t(-1); // returned by registerTexture() if the texture could not be registered
+
             Renderer(const GraphicsDevice* device);
             virtual ~Renderer();
             void cleanUp();
@@ -58,7 +82,13 @@ namespace undicht {
             void setFramebufferLayout(const Framebuffer& fbo);
             void setVertexBufferLayout(const VertexBuffer& vbo_prototype);
             void setShader(Shader* shader);
-            void setShaderInput(uint32_t ubo_count, uint32_t tex_count);
+            // the bindings are: ubos, dynamic ubos, textures
+            void setShaderInput(uint32_t ubo_count, uint32_t tex_count, uint32_t dynamic_ubo_count = 0);
+            // opt in to use one big texture array (set 1, binding 0) instead of binding a texture for every draw call
+            // (check GraphicsDevice::supportsBindlessTextures() first)
+            void setBindlessTextures(uint32_t max_textures);
+            // the size of the push constant block in the shaders (in bytes, the device supports at least 128)
+            void setPushConstantSize(uint32_t byte_size);
             void setViewport(unsigned width, unsigned height);
             void setDepthTest(bool test = true, bool write = true);
 
@@ -75,11 +105,71 @@ namespace undicht {
 
             // commands that can be executed during a render pass
             void submit(UniformBuffer* ubo, uint32_t index);
-            void submit(const Texture* tex, uint32_t index); // the texture index starts after the last ubo index
+            // offset: returned when pushing the data to the dynamic ubo (the index starts after the last ubo index)
+            void submit(const DynamicUniformBuffer* ubo, uint32_t index, uint32_t offset);
+            void submit(const Texture* tex, uint32_t index); // the texture index starts after the last (dynamic) ubo index
+            // bindless textures: the texture is added to the texture array once
+            // (its array element is not written again, since frames in flight might use it)
+            // @return the id used to select the texture (it is passed to the shader as gl_InstanceIndex), INVALID_TEXTURE_ID on failure
+            uint32_t registerTexture(const Texture* tex);
+            // the texture used by the following draw calls
+            // (not for instanced vertex buffers, since the instance index is also used to read their instance data)
+            void selectTexture(uint32_t texture_id);
+            // stores the data directly in the command buffer, it is used by the following draw calls
+            // (the cheapest way to change small data for every draw call, such as a model matrix)
+            void pushConstants(const void* data, uint32_t byte_size, uint32_t offset = 0);
+
+            template<typename T>
+            void pushConstants(const T& data, uint32_t offset = 0) {
+                pushConstants(&data, sizeof(T), offset);
+            }
+
 			void draw(const VertexBuffer* vbo);
+            // draws one mesh of the pool (the vertex buffer is only bound if the previous draw call used a different one)
+            void draw(const GeometryPool* pool, uint32_t mesh_id);
+
+            // recorder_count: 0 records the draw calls directly into the command buffer of the render pass
+            // otherwise each recorder (see getRecorder()) records into its own secondary command buffer,
+            // so that the draw calls can be recorded by multiple threads at the same time (one per recorder)
+            void beginRenderPass(Framebuffer* fbo, uint32_t recorder_count = 0);
+            // the renderpass will be executed by the gpu
+            // (the recorders have to be finished, their command buffers are executed in the order of their ids)
+            void endRenderPass();
+
+            // the recorders of the current render pass (the draw functions of the renderer use recorder 0)
+            DrawRecorder* getRecorder(uint32_t recorder_id);
+
+        public:
+            // statistics
+
+            // the number of resources written to descriptor sets in the current render pass
+            uint32_t getDescriptorWrites() const;
+
+            // the max number of draw calls recorded in one render pass
+            uint32_t getPeakDrawCalls() const;
+
+            // the max number of descriptor sets used in one frame (they are allocated as needed)
+            uint32_t getPeakDescriptorSets() const;
+
+        protected:
+            // managing the descriptor cache
+
+            // removes the sets that reference destroyed buffers / images from the cache of the frame
+            // (called at the start of the frame, once the gpu is done with its sets)
+            void updateDescriptorCache(uint32_t frame_id);
+
+        protected:
+            // binding the shader input (used by the recorders, can be called by multiple threads at the same time)
+
+            // the descriptor set for the resources submitted to the recorder (taken from the cache, if possible)
+            // @return the id of the descriptor set
+            int32_t getShaderInputDescriptor(const DrawRecorder* recorder, vk::DescriptorSet* descriptor);
+
+            // writes the bindings of the descriptor that differ from the resources submitted to the recorder
+            void writeShaderInput(const DrawRecorder* recorder, uint32_t frame, uint32_t descriptor_id);
 
-            void beginRenderPass(Framebuffer* fbo);
-            void endRenderPass(); // the renderpass will be executed by the gpu
+            // updates the buffer of the frame with the data of the ubo (called once per render pass by each recorder submitting the ubo)
+            void updateUniformBuffer(UniformBuffer* ubo, uint32_t frame);
 
 
 		};
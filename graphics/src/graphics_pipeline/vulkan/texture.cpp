@@ -4,22 +4,19 @@ namespace undicht {
 
     namespace graphics {
 
-        Texture::Texture(const GraphicsDevice *device) : m_staging_buffer(device) {
+        Texture::Texture(const GraphicsDevice *device) {
 
             m_device_handle = device;
 
             m_sampler = new vk::Sampler;
             m_image = new vk::Image;
             m_image_view = new vk::ImageView;
-            m_memory = new vk::DeviceMemory;
             m_format = new vk::Format(vk::Format::eR8G8B8A8Srgb);
             m_current_layout = new vk::ImageLayout(vk::ImageLayout::eUndefined);
             m_image_ready = new vk::Semaphore;
 
             if(!m_device_handle) return;
 
-            initStagingBuffer();
-
             // init semaphore
             vk::SemaphoreCreateInfo semaphore_info;
             *m_image_ready = m_device_handle->m_device->createSemaphore(semaphore_info);
@@ -32,7 +29,7 @@ namespace undicht {
             *m_sampler = *tex.m_sampler;
             *m_image = *tex.m_image;
             *m_image_view = *tex.m_image_view;
-            *m_memory = *tex.m_memory;
+            m_memory = tex.m_memory;
             *m_format = *tex.m_format;
             *m_current_layout = *tex.m_current_layout;
             *m_image_ready = *tex.m_image_ready;
@@ -46,7 +43,6 @@ namespace undicht {
             delete m_sampler;
             delete m_image_view;
             delete m_image;
-            delete m_memory;
             delete m_format;
             delete m_current_layout;
             delete m_image_ready;
@@ -57,10 +53,14 @@ namespace undicht {
 
             if(!m_device_handle) return;
 
+            // the image may not be destroyed while it is still used by a transfer command
+            m_device_handle->getUploadManager()->wait(m_last_upload);
+
             m_device_handle->m_device->destroySampler(*m_sampler);
             m_device_handle->m_device->destroyImageView(*m_image_view);
+            m_device_handle->getDestroyedHandles()->add((uint64_t)(VkImageView)*m_image_view);
             if(m_own_image)m_device_handle->m_device->destroyImage(*m_image);
-            m_device_handle->m_device->freeMemory(*m_memory);
+            m_device_handle->getVramAllocator()->free(m_memory);
             m_device_handle->m_device->destroySemaphore(*m_image_ready);
         }
 
@@ -108,25 +108,6 @@ namespace undicht {
 
         /////////////////////////////  initializing the texture ////////////////////////////////
 
-        void Texture::initStagingBuffer() {
-
-            // queue families this buffer is going to be accessed from
-            std::vector<uint32_t> queue_ids;
-            queue_ids.push_back(m_device_handle->m_graphics_queue_id);
-
-            // memory properties
-            vk::MemoryPropertyFlags mem_properties; // needs to be directly accessible by the cpu
-            mem_properties |= vk::MemoryPropertyFlagBits::eHostCoherent;
-            mem_properties |= vk::MemoryPropertyFlagBits::eHostVisible;
-
-            // usage
-            vk::BufferUsageFlags usage_flags = {};
-            usage_flags |= vk::BufferUsageFlagBits::eTransferSrc;
-
-            m_staging_buffer.setUsage(usage_flags, mem_properties,  queue_ids);
-
-        }
-
         void Texture::initImageView() {
 
             vk::ImageViewCreateInfo info;
@@ -166,7 +147,8 @@ namespace undicht {
             *m_sampler = m_device_handle->m_device->createSampler(info);
         }
 
-        void Texture::writeDescriptorSet(vk::DescriptorSet* shader_descriptor, uint32_t index, uint32_t frame_id) const {
+        void Texture::writeDescriptorSet(vk::DescriptorSet* shader_descriptor, uint32_t index, uint32_t frame_id, uint32_t array_element) const {
+            // array_element: the position of the texture in an array of textures
 
             vk::DescriptorImageInfo image_info;
             image_info.imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
@@ -176,7 +158,7 @@ namespace undicht {
             vk::WriteDescriptorSet descriptor_write;
             descriptor_write.dstBinding = index;
             descriptor_write.pImageInfo = &image_info;
-            descriptor_write.dstArrayElement = 0;
+            descriptor_write.dstArrayElement = array_element;
             descriptor_write.descriptorType = vk::DescriptorType::eCombinedImageSampler;
             descriptor_write.descriptorCount = 1;
             descriptor_write.pTexelBufferView = nullptr;
@@ -192,38 +174,24 @@ namespace undicht {
             vk::MemoryRequirements requirements;
             requirements = m_device_handle->m_device->getImageMemoryRequirements(*m_image);
 
-            // specifying the type of memory we want for the texture
-            vk::MemoryType memory_type;
-            memory_type.heapIndex = requirements.memoryTypeBits; // bitfield specifying which memory types can be used
-            memory_type.propertyFlags = vk::MemoryPropertyFlagBits::eDeviceLocal; // on the actual graphics hardware
-
-            // filling out the allocate info
-            vk::MemoryAllocateInfo allocate_info;
-            allocate_info.allocationSize = requirements.size;
-            allocate_info.memoryTypeIndex = m_device_handle->findMemory(memory_type);
-
-            // allocating the memory
-            *m_memory = m_device_handle->m_device->allocateMemory(allocate_info);
+            // getting the memory from one of the bigger blocks of the allocator (on the actual graphics hardware)
+            m_memory = m_device_handle->getVramAllocator()->allocate(requirements, vk::MemoryPropertyFlagBits::eDeviceLocal, false);
 
             // binding the memory to the image
-            m_device_handle->m_device->bindImageMemory(*m_image, *m_memory, 0);
+            m_device_handle->m_device->bindImageMemory(*m_image, *m_memory.memory, m_memory.offset);
 
         }
 
         void Texture::transitionToLayout(vk::ImageLayout new_layout) {
 
-            // allocating a command buffer
-            vk::Queue* queue = m_device_handle->m_graphics_queue;
-            vk::CommandPool* cmd_pool = m_device_handle->m_graphics_command_pool;
-            vk::CommandBuffer cmd_buffer = m_device_handle->beginSingleTimeCommand(*cmd_pool);
-
             vk::ImageMemoryBarrier mem_barrier = genMemBarrier(*m_format, *m_current_layout, new_layout);
             vk::PipelineStageFlagBits start_stage = choosePreBarrierStage(*m_current_layout, new_layout);
             vk::PipelineStageFlagBits wait_stage = chooseWaitStage(*m_current_layout, new_layout);
-            cmd_buffer.pipelineBarrier(start_stage, wait_stage, {},{}, {}, mem_barrier);
 
-            // ending & submitting the command buffer
-            m_device_handle->endSingleTimeCommand(cmd_buffer, *cmd_pool, *queue);
+            // recording the transition (it gets submitted together with other transfer commands)
+            m_last_upload = m_device_handle->getUploadManager()->record([&](vk::CommandBuffer& cmd) {
+                cmd.pipelineBarrier(start_stage, wait_stage, {},{}, {}, mem_barrier);
+            });
 
             *m_current_layout = new_layout;
         }
@@ -296,30 +264,20 @@ namespace undicht {
 
             transitionToLayout(vk::ImageLayout::eTransferDstOptimal);
 
-            // storing the data in the staging buffer
-            m_staging_buffer.setData(data, byte_size, 0);
-
-            // copying the data into the texture using a command buffer
-            vk::Queue* queue = m_device_handle->m_graphics_queue;
-            vk::CommandPool* cmd_pool = m_device_handle->m_graphics_command_pool;
-            vk::CommandBuffer cmd_buffer = m_device_handle->beginSingleTimeCommand(*cmd_pool);
-
-            // copying the buffer to the image
-            vk::BufferImageCopy region = genCopyRegion();
-            cmd_buffer.copyBufferToImage(*m_staging_buffer.m_buffer, *m_image, *m_current_layout, region);
-
-            // ending & submitting the command buffer
-            m_device_handle->endSingleTimeCommand(cmd_buffer, *cmd_pool, *queue);
+            // copying the data to the image through the staging ring of the device
+            m_last_upload = m_device_handle->getUploadManager()->upload(data, byte_size, 16, [&](vk::CommandBuffer& cmd, const vk::Buffer& staging_buffer, uint64_t staging_offset) {
+                cmd.copyBufferToImage(staging_buffer, *m_image, *m_current_layout, genCopyRegion(staging_offset));
+            });
 
             transitionToLayout(vk::ImageLayout::eShaderReadOnlyOptimal);
         }
 
         ///////////////////////////////// private functions for setting data /////////////////////////////////
 
-        vk::BufferImageCopy Texture::genCopyRegion() const {
+        vk::BufferImageCopy Texture::genCopyRegion(uint64_t buffer_offset) const {
 
             vk::BufferImageCopy region;
-            region.bufferOffset = 0; // layout of the data in the buffer
+            region.bufferOffset = buffer_offset; // layout of the data in the buffer
             region.bufferRowLength = 0;
             region.bufferImageHeight = 0;
 
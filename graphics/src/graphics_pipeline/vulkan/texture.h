@@ -12,6 +12,7 @@ namespace undicht {
 
         class GraphicsDevice;
         class Renderer;
+        class DrawRecorder;
         class Framebuffer;
         class SwapChain;
 
@@ -25,7 +26,7 @@ namespace undicht {
 
             vk::Image* m_image = 0;
             vk::ImageView* m_image_view = 0;
-            vk::DeviceMemory* m_memory = 0;
+            VramAllocation m_memory; // sub allocated by the devices VramAllocator
             vk::Sampler* m_sampler = 0;
 
             // when the texture belongs to the inner workings of vulkan (i.e. the swapchain)
@@ -36,10 +37,12 @@ namespace undicht {
             vk::Format* m_format = 0;
             vk::ImageLayout* m_current_layout = 0;
 
-            VramBuffer m_staging_buffer;
+            // the last transfer command / layout transition of the image
+            UploadTicket m_last_upload = 0;
 
             friend GraphicsDevice;
             friend Renderer;
+            friend DrawRecorder;
             friend Framebuffer;
             friend SwapChain;
             const GraphicsDevice* m_device_handle = 0;
@@ -67,12 +70,12 @@ namespace undicht {
         private:
             // initializing the texture
 
-            void initStagingBuffer();
             void initImageView();
             void initSampler();
 
             // tells the descriptors that this texture will be accessed in the shader under the index
-            void writeDescriptorSet(vk::DescriptorSet* shader_descriptor, uint32_t index, uint32_t frame_id) const;
+            // array_element: the position of the texture in an array of textures
+            void writeDescriptorSet(vk::DescriptorSet* shader_descriptor, uint32_t index, uint32_t frame_id, uint32_t array_element = 0) const;
 
             void allocate();
 
@@ -96,7 +99,7 @@ namespace undicht {
         private:
             // private functions for setting data
 
-            vk::BufferImageCopy genCopyRegion() const;
+            vk::BufferImageCopy genCopyRegion(uint64_t buffer_offset) const;
 
         };
 
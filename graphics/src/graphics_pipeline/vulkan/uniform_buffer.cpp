@@ -54,20 +54,27 @@ namespace undicht {
         }
 
         void UniformBuffer::initMemoryOffsets() {
+
+            // calculating the size of the tmp buffer
+            m_tmp_buffer.resize(calcMemoryOffsets(m_buffer_layout, m_offsets));
+
+        }
+
+        uint32_t UniformBuffer::calcMemoryOffsets(const BufferLayout& layout, std::vector<uint32_t>& offsets) {
             // there are special needs for the alignment of types
             // for uniform buffers
 
-            m_offsets.clear();
+            offsets.clear();
 
             uint32_t offset = 0;
             uint32_t last_size = 0;
 
-            for(int i = 0; i < m_buffer_layout.m_types.size(); i++) {
+            for(int i = 0; i < layout.m_types.size(); i++) {
                 // moving past the last type
                 offset += last_size;
 
                 // calculating this correct types offset
-                uint32_t current_size = m_buffer_layout.getType(i).getSize();
+                uint32_t current_size = layout.getType(i).getSize();
                 uint32_t alignment = current_size;
                 alignment = std::max(alignment, 4u); // nothing smaller than 4 bytes
                 alignment = std::min(alignment, 16u); // types bigger than 16 bytes still have to be aligned as if they were 16 bytes
@@ -76,14 +83,12 @@ namespace undicht {
                     offset += alignment - (offset % alignment);
 
                 //UND_LOG << i << " offset: " << offset << "\n";
-                m_offsets.push_back(offset);
+                offsets.push_back(offset);
 
                 last_size = current_size;
             }
 
-            // calculating the size of the tmp buffer
-            m_tmp_buffer.resize(offset + m_buffer_layout.m_types.back().getSize());
-
+            return offset + last_size;
         }
 
         void UniformBuffer::writeDescriptorSet(vk::DescriptorSet* shader_descriptor, uint32_t index, uint32_t frame_id) const {
@@ -154,6 +159,7 @@ namespace undicht {
             std::copy((const char*)data, (const char*)data + byte_size, m_tmp_buffer.begin() + m_offsets.at(index));
 
             std::fill(m_buffers_updated.begin(), m_buffers_updated.end(), false);
+            m_data_version++;
         }
 
     } // graphics
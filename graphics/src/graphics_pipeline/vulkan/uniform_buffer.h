@@ -12,6 +12,8 @@ namespace undicht {
 
         class GraphicsDevice;
         class Renderer;
+        class DrawRecorder;
+        class DynamicUniformBuffer;
 
         class UniformBuffer {
 
@@ -21,10 +23,13 @@ namespace undicht {
             BufferLayout m_buffer_layout;
             std::vector<char> m_tmp_buffer; // temporarily store the data
             std::vector<bool> m_buffers_updated; // true if he buffer of a frame has been updated with the tmp data
+            uint64_t m_data_version = 0; // incremented by setData(), so that the recorders know when to update the buffer again
             std::vector<uint32_t> m_offsets; // offsets into the buffer for correct alignment
 
             friend Renderer;
+            friend DrawRecorder;
             friend GraphicsDevice;
+            friend DynamicUniformBuffer;
             const GraphicsDevice* m_device_handle = 0;
 
             UniformBuffer(const GraphicsDevice* device);
@@ -41,6 +46,10 @@ namespace undicht {
             void initBuffers(uint32_t count);
             void initMemoryOffsets();
 
+            // calculates the aligned offsets of the types in a uniform buffer
+            // @return the size of the data
+            static uint32_t calcMemoryOffsets(const BufferLayout& layout, std::vector<uint32_t>& offsets);
+
             void writeDescriptorSet(vk::DescriptorSet* shader_descriptor, uint32_t index, uint32_t frame_id) const;
             void updateBuffer(uint32_t current_frame);
 
@@ -1,11 +1,12 @@
 #include "graphics_pipeline/vulkan/vertex_buffer.h"
+#include "debug.h"
 
 namespace undicht {
 
     namespace graphics {
 
         VertexBuffer::VertexBuffer(const GraphicsDevice* device)
-        : m_vertex_data(device), m_transfer_data(device), m_index_data(device), m_instance_data(device) {
+        : m_vertex_data(device), m_index_data(device), m_instance_data(device) {
 
             m_device_handle = device;
 
@@ -13,48 +14,20 @@ namespace undicht {
             m_per_vertex_input = new vk::VertexInputBindingDescription(0, 0, vk::VertexInputRate::eVertex);
             m_per_instance_input = new vk::VertexInputBindingDescription(1, 0, vk::VertexInputRate::eInstance);
 
-            initTransferBuffer();
             initVertexDataBuffer();
             initIndexDataBuffer();
             initInstanceDataBuffer();
         }
 
         VertexBuffer::~VertexBuffer() {
-
-            cleanUp();
+            // the buffers free their memory themselves
 
             delete m_per_vertex_input;
             delete m_per_instance_input;
         }
 
-        void VertexBuffer::cleanUp() {
-
-            if(!m_device_handle)
-                return;
-
-        }
-
         ///////////////////////////////////// initializing the buffers /////////////////////////////////////
 
-        void VertexBuffer::initTransferBuffer() {
-
-            // queue families this buffer is going to be accessed from
-            std::vector<uint32_t> queue_ids;
-            queue_ids.push_back(m_device_handle->m_transfer_queue_id); // obviously
-
-            // memory properties
-            vk::MemoryPropertyFlags mem_properties; // needs to be directly accessible by the cpu
-            mem_properties |= vk::MemoryPropertyFlagBits::eHostCoherent;
-            mem_properties |= vk::MemoryPropertyFlagBits::eHostVisible;
-
-            // usage
-            vk::BufferUsageFlags usage_flags = {};
-            usage_flags |= vk::BufferUsageFlagBits::eTransferSrc;
-
-            m_transfer_data.setUsage(usage_flags, mem_properties,  queue_ids);
-
-        }
-
         void VertexBuffer::initVertexDataBuffer() {
 
             // queue families this buffer is going to be accessed from
@@ -197,10 +170,64 @@ namespace undicht {
         }
 
         void VertexBuffer::setIndexData(const std::vector<uint32_t>& data, uint32_t offset) {
+            // if all indices fit into 16 bits, they are stored as uint16
+
+            setIndexDataNarrowed(data.data(), data.size(), offset);
+        }
+
+        template<typename T>
+        void VertexBuffer::setIndexDataNarrowed(const T* indices, uint32_t count, uint32_t offset) {
+            // stores the indices as the smallest possible index type
+
+            // the index type can only change when all indices get replaced
+            if(!offset) {
+
+                bool fits_uint16 = true;
+                for(uint32_t i = 0; (i < count) && fits_uint16; i++)
+                    fits_uint16 = uint64_t(indices[i]) <= 0xFFFF;
+
+                m_index_type = fits_uint16 ? UND_UINT16 : UND_UINT32;
+
+                // the old indices might have been of a bigger type or more
+                m_index_data.setUsedSize(0);
+            }
+
+            if(m_index_type == UND_UINT16) {
+
+                if(sizeof(T) == sizeof(uint16_t)) {
+                    setIndexData(indices, count * sizeof(uint16_t), offset);
+                    return;
+                }
+
+                std::vector<uint16_t> narrowed_indices(count);
+                for(uint32_t i = 0; i < count; i++) {
+
+                    if(uint64_t(indices[i]) > 0xFFFF) {
+                        UND_ERROR << "failed to set index data: the index " << indices[i] << " does not fit into the 16 bit indices of the buffer\n";
+                        return;
+                    }
+
+                    narrowed_indices.at(i) = uint16_t(indices[i]);
+                }
+
+                setIndexData(narrowed_indices.data(), count * sizeof(uint16_t), offset);
+            } else {
+
+                if(sizeof(T) == sizeof(uint32_t)) {
+                    setIndexData(indices, count * sizeof(uint32_t), offset);
+                    return;
+                }
+
+                std::vector<uint32_t> widened_indices(indices, indices + count);
+                setIndexData(widened_indices.data(), count * sizeof(uint32_t), offset);
+            }
 
-            setIndexData(data.data(), data.size() * sizeof(uint32_t), offset);
         }
 
+        // the index types that can be set from a vector
+        template void VertexBuffer::setIndexDataNarrowed<int>(const int* indices, uint32_t count, uint32_t offset);
+        template void VertexBuffer::setIndexDataNarrowed<uint16_t>(const uint16_t* indices, uint32_t count, uint32_t offset);
+
         void VertexBuffer::setInstanceData(const std::vector<float> &data, uint32_t offset) {
 
             setInstanceData(data.data(), data.size() * sizeof(float), offset);
@@ -208,29 +235,50 @@ namespace undicht {
 
         void VertexBuffer::setVertexData(const void* data, uint32_t byte_size , uint32_t offset) {
 
-            // storing the data in the transfer buffer
-            m_transfer_data.setData(data, byte_size, 0);
-
-            // copying the data to the vertex buffer (on cpu invisible but faster gpu memory)
-            m_vertex_data.setData(m_transfer_data, byte_size, 0, offset);
+            // the data gets copied to the buffer (on cpu invisible but faster gpu memory) through the staging ring of the device
+            m_vertex_data.setData(data, byte_size, offset);
         }
 
         void VertexBuffer::setIndexData(const void* data, uint32_t byte_size, uint32_t offset) {
 
-            // storing the data in the transfer buffer
-            m_transfer_data.setData(data, byte_size, 0);
-
-            // copying the data to the vertex buffer (on cpu invisible but faster gpu memory)
-            m_index_data.setData(m_transfer_data, byte_size, 0, offset);
+            // the data gets copied to the buffer (on cpu invisible but faster gpu memory) through the staging ring of the device
+            m_index_data.setData(data, byte_size, offset);
         }
 
         void VertexBuffer::setInstanceData(const void* data, uint32_t byte_size, uint32_t offset) {
 
-            // storing the data in the transfer buffer
-            m_transfer_data.setData(data, byte_size, 0);
+            // the data gets copied to the buffer (on cpu invisible but faster gpu memory) through the staging ring of the device
+            m_instance_data.setData(data, byte_size, offset);
+        }
+
+        void VertexBuffer::setIndexType(const FixedType& type) {
+
+            if(!(type == UND_UINT16) && !(type == UND_UINT32)) {
+                UND_ERROR << "failed to set the index type: only UND_UINT16 and UND_UINT32 are supported\n";
+                return;
+            }
+
+            m_index_type = type;
+        }
+
+        const FixedType& VertexBuffer::getIndexType() const {
+
+            return m_index_type;
+        }
+
+        void VertexBuffer::setGrowthFactor(float factor) {
+
+            m_vertex_data.setGrowthFactor(factor);
+            m_index_data.setGrowthFactor(factor);
+            m_instance_data.setGrowthFactor(factor);
+        }
+
+        void VertexBuffer::shrinkToFit() {
+            // frees the capacity that is not used by the stored data
 
-            // copying the data to the vertex buffer (on cpu invisible but faster gpu memory)
-            m_instance_data.setData(m_transfer_data, byte_size, 0, offset);
+            m_vertex_data.shrinkToFit();
+            m_index_data.shrinkToFit();
+            m_instance_data.shrinkToFit();
         }
 
         bool VertexBuffer::usesIndices() const {
@@ -246,7 +294,7 @@ namespace undicht {
         uint32_t VertexBuffer::getVertexCount() const {
 
             if (usesIndices())
-                return m_index_data.getSize() / sizeof(uint32_t);
+                return m_index_data.getSize() / m_index_type.getSize();
             else
                 return m_vertex_data.getSize() / m_vertex_attributes.getTotalSize();
         }
@@ -15,14 +15,12 @@ namespace undicht {
         class GraphicsDevice;
         class Renderer;
         class RenderPass;
+        class GeometryPool;
 
         class VertexBuffer {
 
         private:
 
-            // transfer ("staging") buffer
-            VramBuffer m_transfer_data;
-
             // per vertex data
             VramBuffer m_vertex_data;
             BufferLayout m_vertex_attributes;
@@ -30,6 +28,7 @@ namespace undicht {
 
             // index data
             VramBuffer m_index_data;
+            FixedType m_index_type = UND_UINT32; // UND_UINT16 or UND_UINT32
 
             // per instance data
             VramBuffer m_instance_data;
@@ -40,13 +39,12 @@ namespace undicht {
             friend Renderer;
             friend Pipeline;
             friend RenderPass;
+            friend GeometryPool;
 
             const GraphicsDevice* m_device_handle = 0;
 
             VertexBuffer(const GraphicsDevice* device);
 
-            void cleanUp();
-
         public:
 
             virtual ~VertexBuffer();
@@ -54,7 +52,6 @@ namespace undicht {
         private:
             // initializing the buffers
 
-            void initTransferBuffer();
             void initVertexDataBuffer();
             void initIndexDataBuffer();
             void initInstanceDataBuffer();
@@ -78,17 +75,41 @@ namespace undicht {
             // translating the attributes to vk::VertexInputAttributeDescriptions
             std::vector<vk::VertexInputAttributeDescription> getAttributeDescriptions() const;
 
+            // stores the indices as the smallest possible index type
+            template<typename T>
+            void setIndexDataNarrowed(const T* indices, uint32_t count, uint32_t offset);
+
         public:
             // setting data
 
             void setVertexData(const std::vector<float>& data, uint32_t offset = 0);
-            void setIndexData(const std::vector<uint32_t>& data, uint32_t offset = 0);
             void setInstanceData(const std::vector<float>& data, uint32_t offset = 0);
 
+            // if all indices fit into 16 bits, they are stored as uint16 (when offset is 0, otherwise the current index type is kept)
+            // (the offset is in bytes of the stored indices)
+            // (braced lists of indices are taken as uint32_t)
+            void setIndexData(const std::vector<uint32_t>& data, uint32_t offset = 0);
+
+            // other integer types (implemented for int and uint16_t)
+            template<typename T>
+            void setIndexData(const std::vector<T>& data, uint32_t offset = 0) {
+                setIndexDataNarrowed(data.data(), data.size(), offset);
+            }
+
             void setVertexData(const void* data, uint32_t byte_size , uint32_t offset);
-            void setIndexData(const void* data, uint32_t byte_size, uint32_t offset);
+            void setIndexData(const void* data, uint32_t byte_size, uint32_t offset); // the data has to be of the current index type
             void setInstanceData(const void* data, uint32_t byte_size, uint32_t offset);
 
+            // the type of the stored indices (UND_UINT16 or UND_UINT32)
+            // (set automatically when setting the indices from a vector)
+            void setIndexType(const FixedType& type);
+            const FixedType& getIndexType() const;
+
+            // memory management
+            // (when data is stored beyond the end of a buffer, its capacity grows by at least the growth factor)
+            void setGrowthFactor(float factor);
+            void shrinkToFit(); // frees the capacity that is not used by the stored data
+
             bool usesIndices() const;
             bool usesInstancing() const;
             uint32_t getVertexCount() const;
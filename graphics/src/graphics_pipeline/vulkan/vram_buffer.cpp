@@ -1,4 +1,8 @@
 #include "graphics_pipeline/vulkan/vram_buffer.h"
+#include "debug.h"
+
+#include "algorithm"
+#include "cstdint"
 
 namespace undicht {
 
@@ -11,7 +15,6 @@ namespace undicht {
             m_usage = new vk::BufferUsageFlags;
             m_mem_properties = new vk::MemoryPropertyFlags;
             m_buffer = new vk::Buffer;
-            m_memory = new vk::DeviceMemory;
         }
 
         VramBuffer::~VramBuffer() {
@@ -24,13 +27,13 @@ namespace undicht {
             delete m_usage;
             delete m_mem_properties;
             delete m_buffer;
-            delete m_memory;
         }
 
         void VramBuffer::cleanUp() {
 
-            m_device_handle->m_device->freeMemory(*m_memory);
-            m_device_handle->m_device->destroyBuffer(*m_buffer);
+            // the buffer may still be used by a transfer command, then it gets destroyed once the command has finished
+            m_device_handle->getUploadManager()->releaseBuffer(m_last_upload, *m_buffer, m_memory);
+            m_memory = VramAllocation();
         }
 
         ////////////////////////////////////////// specifying usage //////////////////////////////////////////
@@ -56,9 +59,10 @@ namespace undicht {
 
         void VramBuffer::reserve(uint32_t byte_size) {
             // makes sure that the buffer has at least a size of byte_size
+            // (grows the capacity geometrically, the stored data is kept)
 
             // checking if a new memory allocation is necessary
-            if(byte_size <= getSize())
+            if(byte_size <= getCapacity())
                 return; // nothing to be done
 
             // if the buffer has no allocated memory
@@ -67,13 +71,55 @@ namespace undicht {
                 return;
             }
 
+            // growing by at least the growth factor, so that appending data takes amortized constant time
+            uint64_t grown_size = uint64_t(double(m_byte_size) * m_growth_factor);
+            reallocate(uint32_t(std::min(std::max(grown_size, uint64_t(byte_size)), uint64_t(UINT32_MAX))));
+        }
+
+        void VramBuffer::setGrowthFactor(float factor) {
+            // the capacity when growing is at least old_capacity * factor (1.0: grow to exactly the requested size)
+
+            if(factor < 1.0f) {
+                UND_WARNING << "vram buffer: growth factor has to be at least 1.0\n";
+                factor = 1.0f;
+            }
+
+            m_growth_factor = factor;
+        }
+
+        void VramBuffer::shrinkToFit() {
+            // reduces the capacity to the size of the stored data
+
+            if(m_used_size == m_byte_size)
+                return;
+
+            if(!m_used_size) {
+                // no data to keep, the buffer gets recreated when data is stored again
+                cleanUp();
+                *m_buffer = vk::Buffer();
+                m_byte_size = 0;
+                return;
+            }
+
+            reallocate(m_used_size);
+        }
+
+        void VramBuffer::reallocate(uint32_t capacity) {
+            // moves the stored data into a new buffer with the capacity
+
             // creating a new Buffer
             VramBuffer new_buffer(m_device_handle);
             new_buffer.setUsage(*m_usage, *m_mem_properties, m_queue_ids);
-            new_buffer.allocate(byte_size);
+            new_buffer.setGrowthFactor(m_growth_factor);
+            new_buffer.allocate(capacity);
+
+            // copying the old data (only the part that was actually used)
+            uint32_t copy_size = std::min(m_used_size, capacity);
+
+            if(copy_size)
+                new_buffer.setData(*this, copy_size, 0, 0);
 
-            // copying the old data
-            new_buffer.setData(*this, m_byte_size, 0, 0);
+            m_device_handle->getVramAllocator()->countReallocation(copy_size);
 
             // swapping *this and new_buffer
             // while swapping no vulkan objects should be destroyed
@@ -109,21 +155,11 @@ namespace undicht {
             vk::MemoryRequirements requirements;
             requirements = m_device_handle->m_device->getBufferMemoryRequirements(*m_buffer);
 
-            // specifying the required properties of the  memory type
-            vk::MemoryType memory_type;
-            memory_type.heapIndex = requirements.memoryTypeBits; // bitfield specifying which memory types can be used
-            memory_type.propertyFlags = *m_mem_properties;
-
-            // filling out the allocation info
-            vk::MemoryAllocateInfo allocate_info;
-            allocate_info.allocationSize = requirements.size; // comes from the buffer
-            allocate_info.memoryTypeIndex = m_device_handle->findMemory(memory_type);
-
-            // allocating the memory
-            *m_memory = m_device_handle->m_device->allocateMemory(allocate_info);
+            // getting the memory from one of the bigger blocks of the allocator
+            m_memory = m_device_handle->getVramAllocator()->allocate(requirements, *m_mem_properties, true);
 
             // binding the memory to the buffer
-            m_device_handle->m_device->bindBufferMemory(*m_buffer, *m_memory, 0);
+            m_device_handle->m_device->bindBufferMemory(*m_buffer, *m_memory.memory, m_memory.offset);
 
         }
 
@@ -134,14 +170,25 @@ namespace undicht {
 
             reserve(byte_size + offset);
 
-            // mapping the memory
-            void* buffer = m_device_handle->m_device->mapMemory(*m_memory, 0, m_byte_size);
+            if(!byte_size)
+                return;
+
+            m_used_size = std::max(m_used_size, byte_size + offset);
+
+            if(!m_memory.mapped) {
+                // memory that is not visible to the cpu gets the data through the staging ring of the upload manager
+                m_last_upload = m_device_handle->getUploadManager()->uploadBuffer(data, byte_size, *this, offset);
+                return;
+            }
+
+            // the memory might still be read by a transfer command
+            m_device_handle->getUploadManager()->wait(m_last_upload);
 
             // copying the data into the mapped buffer
-            std::memcpy(buffer, data, byte_size);
+            std::memcpy(m_memory.mapped + offset, data, byte_size);
 
-            // unmapping the memory (vulkan can now transfer it to the gpu)
-            m_device_handle->m_device->unmapMemory(*m_memory);
+            // making the data visible to the gpu (only needed for non coherent memory)
+            m_device_handle->getVramAllocator()->flush(m_memory, offset, byte_size);
 
         }
 
@@ -149,22 +196,27 @@ namespace undicht {
             // copy from buffer
 
             reserve(byte_size + dst_offset);
+            m_used_size = std::max(m_used_size, byte_size + dst_offset);
 
-            // create a command buffer
-            vk::Queue* queue = m_device_handle->m_transfer_queue;
-            vk::CommandPool* cmd_pool = m_device_handle->m_transfer_command_pool;
-            vk::CommandBuffer transfer_cmd = m_device_handle->beginSingleTimeCommand(*cmd_pool);
+            // recording the copy (it gets submitted together with other transfer commands)
+            m_last_upload = m_device_handle->getUploadManager()->copyBuffer(data, *this, byte_size, src_offset, dst_offset);
+            data.m_last_upload = m_last_upload;
+        }
 
-            // transfer commands
-            vk::BufferCopy copy_info(src_offset, dst_offset, byte_size);
-            transfer_cmd.copyBuffer(*data.m_buffer, *m_buffer, copy_info);
+        void VramBuffer::setUsedSize(uint32_t byte_size) {
+            // sets the end of the stored data (i.e. when all data gets replaced by less data)
+            // (data behind it is dropped when reallocating)
 
-            // submitting the transfer command
-            m_device_handle->endSingleTimeCommand(transfer_cmd, *cmd_pool, *queue);
+            m_used_size = std::min(byte_size, m_byte_size);
         }
 
         uint32_t VramBuffer::getSize() const {
-            // size in bytes
+            // size of the stored data in bytes
+            return m_used_size;
+        }
+
+        uint32_t VramBuffer::getCapacity() const {
+            // allocated size in bytes
             return m_byte_size;
         }
 
@@ -2,6 +2,8 @@
 #define VRAM_BUFFER_H
 
 #include "core/vulkan/vulkan_declaration.h"
+#include "core/vulkan/vram_allocator.h"
+#include "core/vulkan/upload_manager.h"
 #include "set"
 
 namespace undicht {
@@ -11,28 +13,42 @@ namespace undicht {
         class GraphicsDevice;
         class VertexBuffer;
         class Renderer;
+        class DrawRecorder;
         class UniformBuffer;
+        class DynamicUniformBuffer;
         class Texture;
         class RenderPass;
+        class UploadManager;
 
         class VramBuffer {
 
         protected:
 
             vk::Buffer* m_buffer = 0;
-            vk::DeviceMemory *m_memory = 0;
+            VramAllocation m_memory; // sub allocated by the devices VramAllocator
             vk::BufferUsageFlags* m_usage = 0;
             vk::MemoryPropertyFlags* m_mem_properties = 0;
             std::vector<uint32_t> m_queue_ids; // ids of the queue families that can use this buffer
 
-            uint32_t m_byte_size = 0;
+            uint32_t m_byte_size = 0; // the allocated size (capacity)
+            uint32_t m_used_size = 0; // the end of the data that was stored in the buffer
+
+            // when the buffer has to grow, the new capacity is at least the old one times the growth factor
+            // (so that appending data to the buffer only rarely needs a reallocation)
+            float m_growth_factor = 1.5f;
+
+            // the last transfer command reading from / writing to the buffer
+            mutable UploadTicket m_last_upload = 0;
 
             friend GraphicsDevice;
             friend VertexBuffer;
             friend Renderer;
+            friend DrawRecorder;
             friend UniformBuffer;
+            friend DynamicUniformBuffer;
             friend Texture;
             friend RenderPass;
+            friend UploadManager;
 
             const GraphicsDevice* m_device_handle = 0;
 
@@ -54,16 +70,31 @@ namespace undicht {
             // allocating memory
 
             // makes sure that the buffer has at least a size of byte_size
+            // (grows the capacity geometrically, the stored data is kept)
             void reserve(uint32_t byte_size);
             void allocate(uint32_t byte_size);
 
+            // the capacity when growing is at least old_capacity * factor (1.0: grow to exactly the requested size)
+            void setGrowthFactor(float factor);
+
+            // reduces the capacity to the size of the stored data
+            void shrinkToFit();
+
+            // moves the stored data into a new buffer with the capacity
+            void reallocate(uint32_t capacity);
+
         protected:
             // storing data
 
-            void setData(const void* data, uint32_t byte_size, uint32_t offset);
+            void setData(const void* data, uint32_t byte_size, uint32_t offset); // (buffers in device local memory get the data through a staging buffer)
             void setData(const VramBuffer& data, uint32_t byte_size, uint32_t src_offset, uint32_t dst_offset); // copy from buffer
 
-            uint32_t getSize() const; // size in bytes
+            // sets the end of the stored data (i.e. when all data gets replaced by less data)
+            // (data behind it is dropped when reallocating)
+            void setUsedSize(uint32_t byte_size);
+
+            uint32_t getSize() const; // size of the stored data in bytes
+            uint32_t getCapacity() const; // allocated size in bytes
 
         };
 
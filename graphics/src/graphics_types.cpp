@@ -22,6 +22,14 @@ namespace undicht {
                 {UND_INT32, vk::Format::eR32Sint},
                 {UND_INT64, vk::Format::eR64Sint},
                 {UND_R8, vk::Format::eR8Srgb},
+                {UND_FLOAT16, vk::Format::eR16Sfloat},
+                {UND_UINT8, vk::Format::eR8Uint},
+                {UND_UINT16, vk::Format::eR16Uint},
+                {UND_UINT32, vk::Format::eR32Uint},
+                {FixedType(Type::NORMALIZED_INT, 1, 1), vk::Format::eR8Snorm},
+                {FixedType(Type::NORMALIZED_INT, 2, 1), vk::Format::eR16Snorm},
+                {FixedType(Type::NORMALIZED_UNSIGNED_INT, 1, 1), vk::Format::eR8Unorm},
+                {FixedType(Type::NORMALIZED_UNSIGNED_INT, 2, 1), vk::Format::eR16Unorm},
 
                 // types with 2 components
                 {UND_VEC2F, vk::Format::eR32G32Sfloat},
@@ -31,6 +39,13 @@ namespace undicht {
                 {FixedType(Type::INT, 4, 2), vk::Format::eR32G32Sint},
                 {FixedType(Type::INT, 8, 2), vk::Format::eR64G64Sint},
                 {UND_R8G8, vk::Format::eR8G8Srgb},
+                {UND_VEC2H, vk::Format::eR16G16Sfloat},
+                {FixedType(Type::UNSIGNED_INT, 2, 2), vk::Format::eR16G16Uint},
+                {FixedType(Type::UNSIGNED_INT, 4, 2), vk::Format::eR32G32Uint},
+                {UND_VEC2SN8, vk::Format::eR8G8Snorm},
+                {UND_VEC2SN16, vk::Format::eR16G16Snorm},
+                {UND_VEC2UN8, vk::Format::eR8G8Unorm},
+                {UND_VEC2UN16, vk::Format::eR16G16Unorm},
 
                 // types with 3 components
                 {UND_VEC3F, vk::Format::eR32G32B32Sfloat},
@@ -41,6 +56,9 @@ namespace undicht {
                 {FixedType(Type::INT, 8, 3), vk::Format::eR64G64B64Sint},
                 {UND_R8G8B8, vk::Format::eR8G8B8Srgb},
                 {UND_B8G8R8, vk::Format::eB8G8R8Srgb},
+                {FixedType(Type::FLOAT, 2, 3), vk::Format::eR16G16B16Sfloat},
+                {FixedType(Type::NORMALIZED_INT, 2, 3), vk::Format::eR16G16B16Snorm},
+                {FixedType(Type::NORMALIZED_UNSIGNED_INT, 2, 3), vk::Format::eR16G16B16Unorm},
 
                 // types with 4 components
                 {UND_VEC4F, vk::Format::eR32G32B32A32Sfloat},
@@ -51,6 +69,12 @@ namespace undicht {
                 {FixedType(Type::INT, 8, 4), vk::Format::eR64G64B64A64Sint},
                 {UND_R8G8B8A8, vk::Format::eR8G8B8A8Srgb},
                 {UND_B8G8R8A8, vk::Format::eB8G8R8A8Srgb},
+                {UND_VEC4H, vk::Format::eR16G16B16A16Sfloat},
+                {FixedType(Type::UNSIGNED_INT, 4, 4), vk::Format::eR32G32B32A32Uint},
+                {UND_VEC4SN8, vk::Format::eR8G8B8A8Snorm},
+                {UND_VEC4SN16, vk::Format::eR16G16B16A16Snorm},
+                {UND_VEC4UN8, vk::Format::eR8G8B8A8Unorm},
+                {UND_VEC4UN16, vk::Format::eR16G16B16A16Unorm},
 
                 // depth buffer formats
                 {UND_DEPTH32F, vk::Format::eD32Sfloat},
@@ -19,9 +19,12 @@
 
 #include "graphics_pipeline/vulkan/shader.h"
 #include "graphics_pipeline/vulkan/renderer.h"
+#include "graphics_pipeline/vulkan/draw_recorder.h"
 #include "graphics_pipeline/vulkan/pipeline.h"
 #include "graphics_pipeline/vulkan/vertex_buffer.h"
+#include "graphics_pipeline/vulkan/geometry_pool.h"
 #include "graphics_pipeline/vulkan/uniform_buffer.h"
+#include "graphics_pipeline/vulkan/dynamic_uniform_buffer.h"
 #include "graphics_pipeline/vulkan/texture.h"
 #include "graphics_pipeline/vulkan/pipeline.h"
 #include "graphics_pipeline/vulkan/framebuffer.h"
@@ -3,6 +3,14 @@
 #include <sys/stat.h>
 #include "fstream"
 
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 
 namespace undicht {
 
@@ -16,6 +24,14 @@ namespace undicht {
             return rc == 0 ? stat_buf.st_size : -1;
         }
 
+        int64_t getFileModificationTime(const std::string& file) {
+
+            struct stat stat_buf;
+            int rc = stat(file.c_str(), &stat_buf);
+
+            return rc == 0 ? int64_t(stat_buf.st_mtime) : -1;
+        }
+
         std::string getLine(std::ifstream& file) {
 
             std::string s;
@@ -77,63 +93,241 @@ namespace undicht {
         }
 
 
-        void extractFloatArray(std::vector<float> &loadTo,std::string src, unsigned int num, int stride) {
-            /**@brief float arrays might be stored as chars in a text file, this functions converts them to floats */
-            /**@brief they should be only one char apart from each other though*/
+        //////////////////////////////////////// parsing numbers from text ////////////////////////////////////////
 
-            // loadTo.clear();
+        namespace {
+        // (only used by this file)
 
-            src.push_back('X'); // making sure the extracting stops there
-            // while reading through the array of chars,
-            // this pointer points to the end of the last float extracted
-            char* reading_position = ((char*)src.data());
-            char* end_position = ((char*)src.data()) + src.size() - 1;
+        bool isNumberSeparator(char c) {
 
-            while(reading_position < end_position) {
-                // the strtof function will store the end of the extracted float in the char array as an pointer
-                // this way the reading position gets updated and moves forward
-                loadTo.push_back(strtof(reading_position, &reading_position));
+            return (c == ' ') || (c == '\n') || (c == '\t') || (c == '\r');
+        }
 
-                if(loadTo.size() >= num) {
-                    break;
+        unsigned int countBits(unsigned int mask) {
+
+            unsigned int count = 0;
+
+            for (; mask; count++)
+                mask &= mask - 1;
+
+            return count;
+        }
+
+        size_t countNumbers(const char* src, const char* src_end) {
+            /// @return the number of whitespace separated tokens in the range (to reserve memory for them)
+
+            size_t count = 0;
+            bool prev_separator = true; // whether the char before the current position is a separator
+
+#ifdef __SSE2__
+            // checking 16 chars at once
+            const __m128i space = _mm_set1_epi8(' ');
+            const __m128i new_line = _mm_set1_epi8('\n');
+            const __m128i tab = _mm_set1_epi8('\t');
+            const __m128i carriage_return = _mm_set1_epi8('\r');
+
+            for (; src + 16 <= src_end; src += 16) {
+
+                __m128i chars = _mm_loadu_si128((const __m128i*)src);
+                __m128i separators = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chars, space), _mm_cmpeq_epi8(chars, new_line)),
+                                                  _mm_or_si128(_mm_cmpeq_epi8(chars, tab), _mm_cmpeq_epi8(chars, carriage_return)));
+
+                // bit i is set if char i is a separator
+                unsigned int separator_mask = _mm_movemask_epi8(separators);
+
+                // a token starts where a char is not a separator, but the one before is
+                unsigned int prev_separator_mask = ((separator_mask << 1) | prev_separator) & 0xFFFF;
+                count += countBits(~separator_mask & prev_separator_mask & 0xFFFF);
+
+                prev_separator = (separator_mask >> 15) & 1;
+            }
+#endif // __SSE2__
+
+            for (; src < src_end; src++) {
+
+                bool separator = isNumberSeparator(*src);
+                count += prev_separator && !separator;
+                prev_separator = separator;
+            }
+
+            return count;
+        }
+
+        const char* skipNumberSeparators(const char* src, const char* src_end) {
+
+            while ((src < src_end) && isNumberSeparator(*src))
+                src++;
+
+            return src;
+        }
+
+        const char* findNumberEnd(const char* src, const char* src_end) {
+
+            while ((src < src_end) && !isNumberSeparator(*src))
+                src++;
+
+            return src;
+        }
+
+        bool parseFloatFast(const char* src, const char* src_end, float& value) {
+            /** parses simple decimal numbers (like "-0.123456" or "1.5e-3") exactly
+            * @return false, if the number can not be parsed exactly (too many digits, large exponent, inf / nan ...) */
+
+            const uint64_t max_mantissa = uint64_t(1) << 24; // up to this value, all integers can be stored exactly in a float
+            const float powers_of_10[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f }; // all exact in a float
+
+            bool negative = (*src == '-');
+            if (negative || (*src == '+'))
+                src++;
+
+            uint64_t mantissa = 0;
+            int exponent = 0;
+            int digits = 0;
+
+            for (; (src < src_end) && (*src >= '0') && (*src <= '9'); src++, digits++) {
+                mantissa = mantissa * 10 + (*src - '0');
+
+                if (mantissa > max_mantissa)
+                    return false;
+            }
+
+            if ((src < src_end) && (*src == '.')) {
+
+                for (src++; (src < src_end) && (*src >= '0') && (*src <= '9'); src++, digits++) {
+                    mantissa = mantissa * 10 + (*src - '0');
+                    exponent--;
+
+                    if (mantissa > max_mantissa)
+                        return false;
                 }
+            }
+
+            if (!digits)
+                return false;
+
+            if ((src < src_end) && ((*src == 'e') || (*src == 'E'))) {
+
+                src++;
+                bool negative_exponent = (src < src_end) && (*src == '-');
+                if ((src < src_end) && ((*src == '-') || (*src == '+')))
+                    src++;
+
+                int exponent_value = 0;
+                int exponent_digits = 0;
+
+                for (; (src < src_end) && (*src >= '0') && (*src <= '9') && (exponent_digits < 4); src++, exponent_digits++)
+                    exponent_value = exponent_value * 10 + (*src - '0');
+
+                if (!exponent_digits)
+                    return false;
+
+                exponent += negative_exponent ? -exponent_value : exponent_value;
+            }
+
+            if ((src != src_end) || (exponent < -10) || (exponent > 10))
+                return false;
+
+            // both the mantissa and the power of 10 are exact, so a single multiplication / division rounds correctly
+            value = float(mantissa);
+            value = (exponent < 0) ? value / powers_of_10[-exponent] : value * powers_of_10[exponent];
+
+            if (negative)
+                value = -value;
+
+            return true;
+        }
+
+        bool parseIntFast(const char* src, const char* src_end, int& value) {
+            /** @return false, if the number is not a (not too long) decimal integer */
+
+            bool negative = (*src == '-');
+            if (negative || (*src == '+'))
+                src++;
+
+            if ((src == src_end) || (src_end - src > 18))
+                return false;
+
+            int64_t number = 0;
+
+            for (; src < src_end; src++) {
 
-                reading_position += stride;
+                if ((*src < '0') || (*src > '9'))
+                    return false;
 
+                number = number * 10 + (*src - '0');
             }
 
-            src.pop_back(); // deleting the last char
+            value = int(negative ? -number : number);
 
+            return true;
         }
 
+        } // namespace
 
-        void extractIntArray(std::vector<int> &loadTo, std::string src, unsigned int num, int stride) {
+        void extractFloatArray(std::vector<float> &loadTo, const std::string& src, unsigned int num) {
+            /**@brief float arrays might be stored as chars in a text file, this functions converts them to floats */
+
+            extractFloatArray(loadTo, src.data(), src.data() + src.size(), num);
+        }
+
+        void extractIntArray(std::vector<int> &loadTo, const std::string& src, unsigned int num) {
             /**@brief extract ints from a char array*/
-            /** @warning might not work correctly if the src's length equals its capacity, so make sure there is (at least) one extra char */
 
-            // loadTo.clear();
+            extractIntArray(loadTo, src.data(), src.data() + src.size(), num);
+        }
+
+        void extractFloatArray(std::vector<float> &loadTo, const char* src, const char* src_end, unsigned int num) {
+            /** @param src_end: points behind the last char (the range doesnt have to be null terminated) */
 
-            src.push_back('X'); // making sure the extracting stops there
-            // while reading through the array of chars,
-            // this pointer points to the end of the last float extracted
-            char* reading_position = ((char*)src.data());
-            char* end_position = ((char*)src.data()) + src.size() - 1;
+            loadTo.reserve(loadTo.size() + std::min<size_t>(num, countNumbers(src, src_end)));
 
-            while(reading_position < end_position) {
-                // the strtof function will store the end of the extracted float in the char array as an pointer
-                // this way the reading position gets updated and moves forward
-                loadTo.push_back(strtol(reading_position, &reading_position, 0));
+            std::string buffer; // null terminated copy of a number for strtof / strtol (reused, so it only allocates for long numbers)
 
-                if(loadTo.size() >= num) {
+            for (unsigned int i = 0; i < num; i++) {
+
+                src = skipNumberSeparators(src, src_end);
+                if (src == src_end)
                     break;
-                }
 
-                reading_position += stride;
+                const char* number_end = findNumberEnd(src, src_end);
 
+                float value;
+                if (!parseFloatFast(src, number_end, value)) {
+                    // slow, but exact for all numbers
+                    buffer.assign(src, number_end);
+                    value = strtof(buffer.c_str(), 0);
+                }
+
+                loadTo.push_back(value);
+                src = number_end;
             }
 
-            src.pop_back(); // deleting the last char
+        }
 
+        void extractIntArray(std::vector<int> &loadTo, const char* src, const char* src_end, unsigned int num) {
+            /** @param src_end: points behind the last char (the range doesnt have to be null terminated) */
+
+            loadTo.reserve(loadTo.size() + std::min<size_t>(num, countNumbers(src, src_end)));
+
+            std::string buffer; // null terminated copy of a number for strtof / strtol (reused, so it only allocates for long numbers)
+
+            for (unsigned int i = 0; i < num; i++) {
+
+                src = skipNumberSeparators(src, src_end);
+                if (src == src_end)
+                    break;
+
+                const char* number_end = findNumberEnd(src, src_end);
+
+                int value;
+                if (!parseIntFast(src, number_end, value)) {
+                    buffer.assign(src, number_end);
+                    value = strtol(buffer.c_str(), 0, 10);
+                }
+
+                loadTo.push_back(value);
+                src = number_end;
+            }
 
         }
 
@@ -3,6 +3,7 @@
 
 #include <sstream>
 #include <vector>
+#include <cstdint>
 
 // some simple string tools
 
@@ -18,6 +19,9 @@ namespace undicht {
 #define UND_CODE_ORIGIN UND_CODE_SRC_FILE + undicht::tools::toStr(" : ") + undicht::tools::toStr(__LINE__)
 
         size_t getFileSize(const std::string& file);
+
+        /** @return the time the file was last modified (seconds since 1970), -1 if the file doesnt exist */
+        int64_t getFileModificationTime(const std::string& file);
         std::string getLine(std::ifstream& file);
 
         /** tries to convert everything into a string */
@@ -40,14 +44,19 @@ namespace undicht {
 
 
         /**@brief float arrays might be stored as chars in a text file, this functions converts them to floats
-        * @param num is the number of floats to extract
-        * @param stride is the distance in chars between each float, default is 1 (example: " ")*/
-        void extractFloatArray(std::vector<float> &loadTo, std::string src, unsigned int num, int stride = 1);
-
-        /**@brief extract ints from a char array
-        * @param num is the number of ints to extract
-        * @param stride is the distance in chars between each int, default is 1 (example: " ") */
-        void extractIntArray(std::vector<int> &loadTo, std::string src, unsigned int num, int stride = 1);
+        * the numbers can be separated by any whitespace
+        * @param num is the max number of floats to extract (-1: all floats) */
+        void extractFloatArray(std::vector<float> &loadTo, const std::string& src, unsigned int num = -1);
+
+        /**@brief extract ints from a char array (decimal numbers separated by whitespace)
+        * @param num is the max number of ints to extract (-1: all ints) */
+        void extractIntArray(std::vector<int> &loadTo, const std::string& src, unsigned int num = -1);
+
+        /** same as the functions above, but the chars dont have to be stored in a std::string
+        * (i.e. they can be read directly from a mapped file)
+        * @param src_end: points behind the last char (the range doesnt have to be null terminated) */
+        void extractFloatArray(std::vector<float> &loadTo, const char* src, const char* src_end, unsigned int num = -1);
+        void extractIntArray(std::vector<int> &loadTo, const char* src, const char* src_end, unsigned int num = -1);
 
     } // tools
 
@@ -3,6 +3,8 @@
 #include "stb_image.h"
 #include "debug.h"
 
+#include <mutex>
+
 namespace undicht {
 
     namespace tools {
@@ -20,7 +22,10 @@ namespace undicht {
 
         bool ImageFile::loadImage(const std::string &file_name, ImageData &data) {
 
-            stbi_set_flip_vertically_on_load(true);
+            // the flag is global, setting it only once allows images to be loaded on multiple threads
+            static std::once_flag flip_flag;
+            std::call_once(flip_flag, [] { stbi_set_flip_vertically_on_load(true); });
+
             unsigned char* tmp = stbi_load(file_name.data(), (int*)&data._width, (int*)&data._height, (int*)&data._nr_channels, STBI_rgb_alpha);
 
             if(!tmp) {
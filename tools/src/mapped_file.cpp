@@ -0,0 +1,137 @@
+#include "mapped_file.h"
+#include "debug.h"
+#include "config.h"
+#include "fstream"
+
+#ifdef PLATFORM_UNIX
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+
+namespace undicht {
+
+    namespace tools {
+
+        MappedFile::MappedFile() {
+            //ctor
+        }
+
+        MappedFile::MappedFile(const std::string& file_name) {
+            //ctor
+
+            open(file_name);
+        }
+
+        MappedFile::~MappedFile() {
+            //dtor
+
+            close();
+        }
+
+        bool MappedFile::open(const std::string& file_name) {
+            /** @return false if the file could not be opened */
+
+            close();
+
+            if (map(file_name) || read(file_name)) {
+                m_is_open = true;
+                return true;
+            }
+
+            UND_ERROR << "failed to open file: " << file_name << "\n";
+            return false;
+        }
+
+        void MappedFile::close() {
+
+#ifdef PLATFORM_UNIX
+            if (m_is_mapped)
+                munmap((void*)m_data, m_size);
+#endif
+
+            m_buffer.clear();
+            m_buffer.shrink_to_fit();
+
+            m_data = 0;
+            m_size = 0;
+            m_is_mapped = false;
+            m_is_open = false;
+        }
+
+        bool MappedFile::isOpen() const {
+
+            return m_is_open;
+        }
+
+        const char* MappedFile::getData() const {
+            /** @return a pointer to the first char of the file content (stays valid until the file is closed) */
+
+            return m_data;
+        }
+
+        size_t MappedFile::getSize() const {
+
+            return m_size;
+        }
+
+        ///////////////////////////////////////////// loading the file content /////////////////////////////////////////////
+
+        bool MappedFile::map(const std::string& file_name) {
+
+#ifdef PLATFORM_UNIX
+
+            int file = ::open(file_name.c_str(), O_RDONLY);
+
+            if (file < 0)
+                return false;
+
+            struct stat stat_buf;
+            if ((fstat(file, &stat_buf) != 0) || (stat_buf.st_size <= 0)) {
+                // empty files cant be mapped (they get "read" instead)
+                ::close(file);
+                return false;
+            }
+
+            void* data = mmap(0, stat_buf.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+            ::close(file); // the mapping stays valid after the file is closed
+
+            if (data == MAP_FAILED)
+                return false;
+
+            // the file is usually read from front to back
+            madvise(data, stat_buf.st_size, MADV_SEQUENTIAL);
+
+            m_data = (const char*)data;
+            m_size = stat_buf.st_size;
+            m_is_mapped = true;
+
+            return true;
+#else
+            return false;
+#endif // PLATFORM_UNIX
+        }
+
+        bool MappedFile::read(const std::string& file_name) {
+
+            std::ifstream file(file_name, std::ios::binary | std::ios::ate);
+
+            if (!file.is_open())
+                return false;
+
+            m_buffer.resize(file.tellg());
+            file.seekg(0);
+            file.read(m_buffer.data(), m_buffer.size());
+            m_buffer.resize(file.gcount());
+
+            m_data = m_buffer.data();
+            m_size = m_buffer.size();
+
+            return true;
+        }
+
+    } // tools
+
+} // undicht
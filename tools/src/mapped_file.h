@@ -0,0 +1,56 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <string>
+#include <vector>
+
+#include "unique_object.h"
+
+namespace undicht {
+
+    namespace tools {
+
+        class MappedFile : public core::UniqueObject {
+            /** gives read only access to the whole content of a file
+            * on unix the file gets mapped into memory (no copy is made, pages are loaded by the os when they are accessed)
+            * on other platforms (or if mapping fails) the file is read into a buffer owned by this object */
+        protected:
+
+            const char* m_data = 0;
+            size_t m_size = 0;
+            bool m_is_open = false;
+
+            // the file gets mapped (as opposed to being read into m_buffer)
+            bool m_is_mapped = false;
+            std::vector<char> m_buffer;
+
+        public:
+
+            /** @return false if the file could not be opened */
+            bool open(const std::string& file_name);
+            void close();
+
+            bool isOpen() const;
+
+            /** @return a pointer to the first char of the file content (stays valid until the file is closed) */
+            const char* getData() const;
+            size_t getSize() const;
+
+        protected:
+
+            bool map(const std::string& file_name);
+            bool read(const std::string& file_name);
+
+        public:
+
+            MappedFile();
+            MappedFile(const std::string& file_name);
+            virtual ~MappedFile();
+
+        };
+
+    } // tools
+
+} // undicht
+
+#endif // MAPPED_FILE_H
@@ -1,28 +1,132 @@
 #include "collada_file.h"
+#include "model_loading/mesh_cache.h"
+#include "model_loading/mesh_optimizer.h"
 
 #include "debug.h"
 #include <file_tools.h>
+#include <algorithm>
+#include <unordered_map>
+#include <chrono>
+#include <cstdlib>
 
 namespace undicht {
 
 	namespace tools {
 
-		const std::vector<std::string> primitive_types{ "polylist", "triangles", "polygons", "lines", "trifans", "tristrips", "linestrips" };
+		namespace {
+		// (only used by this file)
+
+		// the primitive groups that can be triangulated (lines, linestrips are not loaded)
+		const std::vector<std::string> primitive_types{ "triangles", "polylist", "polygons", "trifans", "tristrips" };
+
+		// queries that are used multiple times while loading a file
+		const XmlQuery geometries_query({ "COLLADA", "library_geometries", "geometry" });
+		const XmlQuery materials_query({ "COLLADA", "library_materials", "material" });
+		const XmlQuery mesh_query({ "mesh" });
+		const XmlQuery float_array_query({ "float_array" });
+		const XmlQuery accessor_query({ "technique_common", "accessor" });
+		const XmlQuery p_query({ "p" });
+		const XmlQuery vcount_query({ "vcount" });
+		const XmlQuery init_from_query({ "init_from" });
+		const XmlQuery instance_effect_query({ "instance_effect" });
+		const XmlQuery diffuse_texture_query({ "profile_COMMON", "technique", "phong", "diffuse", "texture" });
+
+		int getIntAttribute(XmlElement* element, const std::string& attrib_name, int default_value) {
+			/// @return the value of the attribute (stored in quotes), default_value if the element doesnt have the attribute
+
+			const XmlTagAttrib* attribute = element->getAttribute(attrib_name);
+			if (!attribute || (attribute->m_value.size() < 3))
+				return default_value;
+
+			return std::atoi(attribute->m_value.substr(1, attribute->m_value.size() - 2).str().c_str());
+		}
+
+		class IndexTupleHash {
+			/// hashes the attribute indices of a vertex (the key is the number of the vertex)
+		public:
+			const std::vector<int>& m_indices;
+			size_t m_tuple_size;
+
+			IndexTupleHash(const std::vector<int>& indices, size_t tuple_size) : m_indices(indices), m_tuple_size(tuple_size) {}
+
+			size_t operator()(size_t vertex) const {
+
+				size_t hash = 2166136261u;
+
+				for (size_t i = vertex * m_tuple_size; i < (vertex + 1) * m_tuple_size; i++)
+					hash = (hash ^ size_t(m_indices[i])) * 16777619u;
+
+				return hash;
+			}
+		};
+
+		class IndexTupleEqual {
+			/// compares the attribute indices of two vertices
+		public:
+			const std::vector<int>& m_indices;
+			size_t m_tuple_size;
+
+			IndexTupleEqual(const std::vector<int>& indices, size_t tuple_size) : m_indices(indices), m_tuple_size(tuple_size) {}
+
+			bool operator()(size_t vertex0, size_t vertex1) const {
+
+				return std::equal(m_indices.begin() + vertex0 * m_tuple_size, m_indices.begin() + (vertex0 + 1) * m_tuple_size, m_indices.begin() + vertex1 * m_tuple_size);
+			}
+		};
+
+		struct ColladaInput {
+			/// an input of a primitive group that is used to build the vertices
+			XmlString source; // the id of the source element
+			int offset = -1; // the offset of the index in the index tuple of each vertex
+			int set = 0; // for inputs that exist multiple times (TEXCOORD)
+		};
+
+		} // namespace
 
 
 		ColladaFile::ColladaFile() {
 			//ctor
 		}
 
-		ColladaFile::ColladaFile(const std::string& file_name) {
+		ColladaFile::ColladaFile(const std::string& file_name, bool memory_map) {
 
-			open(file_name);
+			open(file_name, memory_map);
 		}
 
 		ColladaFile::~ColladaFile() {
 			//dtor
 		}
 
+		bool ColladaFile::open(const std::string& file_name, bool memory_map) {
+			/** loads the xml data of the file
+			* if there is an up to date mesh cache for the file, the meshes + texture files are loaded from it instead */
+
+			m_texture_files.clear();
+			m_material_textures.clear();
+			m_texture_files_found = false;
+			m_cached_meshes.clear();
+			m_mesh_cache_loaded = false;
+
+			if (m_use_mesh_cache && MeshCache().load(file_name, getMeshLoadOptions(), m_cached_meshes, m_texture_files)) {
+				// no need to parse the file
+				clear();
+				m_file_name = file_name;
+				m_texture_files_found = true;
+				m_mesh_cache_loaded = true;
+
+				return true;
+			}
+
+			return XmlFile::open(file_name, memory_map);
+		}
+
+		void ColladaFile::setUseMeshCache(bool use_cache) {
+			/** whether to use the binary mesh cache stored next to the file (enabled by default)
+			* has to be set before the file is opened */
+
+			m_use_mesh_cache = use_cache;
+		}
+
 		////////////////////////////////////////////////// ModelLoader api functions //////////////////////////////////////////////////
 		////////////////////////////////////////// functions to load single meshes / textures /////////////////////////////////////////
 
@@ -30,7 +134,16 @@ namespace undicht {
 		int ColladaFile::getMeshCount() {
 			/** @return the number of meshes stored in the file */
 
-			return getAllElements({ "COLLADA", "library_geometries", "geometry" }).size();
+			if (m_mesh_cache_loaded)
+				return m_cached_meshes.size();
+
+			// each primitive group of a geometry is loaded as its own mesh
+			int mesh_count = 0;
+
+			for (XmlElement* geometry : getAllElements(geometries_query))
+				mesh_count += getPrimitives(*geometry).size();
+
+			return mesh_count;
 		}
 
 
@@ -38,7 +151,9 @@ namespace undicht {
 			/** @return the number of unique textures used by the meshes
 			* if a mesh should use for example a color + normal texture, thats 2 */
 
-			return getAllElements({ "COLLADA", "library_materials", "material" }).size();
+			findTextureFiles();
+
+			return m_texture_files.size();
 		}
 
 
@@ -46,46 +161,30 @@ namespace undicht {
 			/** loads the vertices of the mesh
 			* @param id: to iterate through the meshes of the file */
 
-			// all geometries stored in the file
-			std::vector<XmlElement*> geometries = getAllElements({ "COLLADA", "library_geometries", "geometry" });
-
-			if (geometries.size() <= id) return;
-			XmlElement* geom_element = geometries.at(id);
+			if (m_mesh_cache_loaded) {
 
-			// loading the mesh data
-			loadGeometry(*geom_element, loadTo_mesh.vertices, loadTo_mesh.vertex_layout);
+				if (id < m_cached_meshes.size())
+					loadTo_mesh = m_cached_meshes.at(id);
 
-			// finding the right textures for the model
-			std::vector<XmlElement*> materials = getAllElements({ "COLLADA", "library_materials", "material" }); // all materials stored in the file
-
-			XmlElement* mesh = geom_element->getElement({ "mesh" });
-			std::string material_id;
-
-			// getting the material name
-			for (const std::string& primitive_type : primitive_types) {
+				return;
+			}
 
-				XmlElement* primitive = mesh->getElement({ primitive_type });
+			findTextureFiles();
 
-				if (primitive) {
-					const XmlTagAttrib* mat_attrib = primitive->getAttribute("material");
+			// all materials stored in the file
+			std::vector<XmlElement*> materials = getAllElements(materials_query);
 
-					if (mat_attrib) {
+			// finding the primitive group of the mesh
+			for (XmlElement* geometry : getAllElements(geometries_query)) {
 
-						material_id = mat_attrib->m_value;
-					}
+				std::vector<XmlElement*> primitives = getPrimitives(*geometry);
 
-					break;
+				if (id < primitives.size()) {
+					loadPrimitive(*primitives.at(id), materials, loadTo_mesh);
+					return;
 				}
-			}
 
-			// getting the id of the material containing the texture
-			// since there is one texture per material (no bump-mapping rn), that id is the same for material and texture
-			for (unsigned int i = 0; i < materials.size(); i++) {
-				if (!materials.at(i)->getAttribute("id")->m_value.compare(material_id)) {
-					// found the right material
-					loadTo_mesh.color_texture = i;
-					break;
-				}
+				id -= primitives.size();
 			}
 
 		}
@@ -93,66 +192,91 @@ namespace undicht {
 		void ColladaFile::getTexture(ImageData& loadTo_texture, int id) {
 			/** @param id: to iterate through the texture of the file */
 
-			std::vector<XmlElement*> materials = getAllElements({ "COLLADA", "library_materials", "material" }); // all materials stored in the file
+			findTextureFiles();
 
-			loadMaterialTextures(materials.at(id), loadTo_texture);
+			if (!m_texture_files.at(id).empty())
+				ImageFile image_file(m_texture_files.at(id), loadTo_texture);
 
 		}
 
 		////////////////////////////////////////// functions to load all meshes / textures ///////////////////////////////////////////
 
 		void ColladaFile::loadAllMeshes(std::vector<MeshData>& loadTo_meshes) {
+			/** the geometries are loaded in parallel (if a thread pool was set), the order of the meshes stays the same
+			* (one mesh per primitive group of each geometry)
+			* if the mesh cache is used, the meshes are copied from it / the cache gets written afterwards */
+
+			if (m_mesh_cache_loaded) {
+				loadTo_meshes.insert(loadTo_meshes.end(), m_cached_meshes.begin(), m_cached_meshes.end());
+				return;
+			}
 
 			// all materials stored in the file
-			std::vector<XmlElement*> materials = getAllElements({ "COLLADA", "library_materials", "material" });
+			std::vector<XmlElement*> materials = getAllElements(materials_query);
 
 			// all geometries stored in the file
-			std::vector<XmlElement*> geometries = getAllElements({ "COLLADA", "library_geometries", "geometry" });
+			std::vector<XmlElement*> geometries = getAllElements(geometries_query);
 
+			// the id index + textures have to be known before multiple threads look them up
+			if (!m_id_index_built)
+				buildIdIndex();
 
-			for (XmlElement* e : geometries) {
+			findTextureFiles();
 
-				loadTo_meshes.emplace_back(MeshData());
+			if (m_mesh_optimizer)
+				m_mesh_optimizer->resetStats();
 
-				loadGeometry(*e, loadTo_meshes.back().vertices, loadTo_meshes.back().vertex_layout);
+			// each primitive group of a geometry gets loaded into its own mesh
+			std::vector<std::vector<MeshData>> geometry_meshes(geometries.size());
 
-				// finding the material to the mesh
-				XmlElement* mesh = e->getElement({ "mesh" });
-				std::string material_id;
+			parallelFor(geometries.size(), [&](size_t i) {
+				loadGeometry(*geometries.at(i), materials, geometry_meshes.at(i));
+			});
 
-				// getting the material name
-				for (const std::string& primitive_type : primitive_types) {
+			if (m_mesh_optimizer)
+				UND_LOG << "optimized the meshes, ACMR: " << m_mesh_optimizer->getACMRBefore() << " -> " << m_mesh_optimizer->getACMRAfter() << "\n";
 
-					XmlElement* primitive = mesh->getElement({ primitive_type });
+			size_t first_mesh = loadTo_meshes.size();
 
-					if (primitive) {
-						material_id = primitive->getAttribute("material")->m_value;
-						break;
-					}
-				}
+			for (std::vector<MeshData>& meshes : geometry_meshes)
+				for (MeshData& mesh : meshes)
+					loadTo_meshes.emplace_back(std::move(mesh));
 
-				// getting the id of the material containing the texture
-				// since there is one texture per material (no bump-mapping rn), that id is the same for material and texture
-				for (unsigned int i = 0; i < materials.size(); i++) {
-					if (!materials.at(i)->getAttribute("id")->m_value.compare(material_id)) {
-						// found the right material
-						loadTo_meshes.back().color_texture = i;
-						break;
-					}
-				}
+			// the next time the file is opened, the meshes can be loaded from the cache
+			if (m_use_mesh_cache) {
+
+				std::vector<MeshData> meshes(loadTo_meshes.begin() + first_mesh, loadTo_meshes.end());
 
+				if (!MeshCache().save(m_file_name, getMeshLoadOptions(), meshes, m_texture_files))
+					UND_WARNING << "failed to write the mesh cache for " << m_file_name << "\n";
 			}
+
 		}
 
 		void ColladaFile::loadAllTextures(std::vector<ImageData>& loadTo_textures) {
+			/** each unique image file is decoded once (in parallel, if a thread pool was set) */
 
-			// all materials stored in the file
-			std::vector<XmlElement*> materials = getAllElements({ "COLLADA", "library_materials", "material" });
+			findTextureFiles();
 
-			for (XmlElement* material : materials) {
-				loadTo_textures.emplace_back(ImageData());
-				loadMaterialTextures(material, loadTo_textures.back());
-			}
+			size_t first_texture = loadTo_textures.size();
+			loadTo_textures.resize(first_texture + m_texture_files.size());
+
+			std::vector<double> decode_times(m_texture_files.size(), 0.0);
+
+			parallelFor(m_texture_files.size(), [&](size_t i) {
+
+				if (m_texture_files.at(i).empty())
+					return; // the texture for materials without one stays empty
+
+				std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+				ImageFile image_file(m_texture_files.at(i), loadTo_textures.at(first_texture + i));
+				decode_times.at(i) = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			});
+
+			// logging from the main thread (so that the messages dont get mixed up)
+			for (size_t i = 0; i < m_texture_files.size(); i++)
+				if (!m_texture_files.at(i).empty())
+					UND_LOG << "decoded " << m_texture_files.at(i) << " in " << decode_times.at(i) << " ms\n";
 
 		}
 
@@ -160,139 +284,420 @@ namespace undicht {
 		///////////////////////////// functions to bring more structure to the loading process /////////////////////////////////////
 
 
-		void ColladaFile::loadGeometry(XmlElement& geometry, std::vector<float>& vertices, BufferLayout& vertex_layout) {
-			/** loading the vertices from a geometry element */
+		void ColladaFile::loadGeometry(XmlElement& geometry, const std::vector<XmlElement*>& materials, std::vector<MeshData>& loadTo_meshes) {
+			/** loads one mesh for each primitive group (triangles, polylist ...) of the geometry
+			* (only reads from the xml tree, so multiple geometries can be loaded at the same time)
+			* primitive groups that fail to load are skipped */
+
+			for (XmlElement* primitive : getPrimitives(geometry)) {
+
+				loadTo_meshes.emplace_back(MeshData());
+
+				if (!loadPrimitive(*primitive, materials, loadTo_meshes.back()))
+					loadTo_meshes.pop_back();
+			}
+
+		}
+
+		std::vector<XmlElement*> ColladaFile::getPrimitives(XmlElement& geometry) {
+			/** @return the primitive groups of the geometry that can be triangulated (in the order they are stored in) */
+
+			std::vector<XmlElement*> primitives;
 
-			// getting vertex data
-			XmlElement* mesh = geometry.getElement({ "mesh" });
+			XmlElement* mesh = geometry.getElement(mesh_query);
 			if (!mesh)
-				return;
+				return primitives;
 
-			XmlElement* position_source = getMeshSource(mesh, "POSITION");
-			XmlElement* uv_source = getMeshSource(mesh, "TEXCOORD");
-			XmlElement* normal_source = getMeshSource(mesh, "NORMAL");
+			for (XmlElement* child = mesh->getFirstChild(); child; child = child->getNextSibling())
+				if (std::find(primitive_types.begin(), primitive_types.end(), child->getName()) != primitive_types.end())
+					primitives.push_back(child);
 
-			std::vector<std::vector<float>> attribute_data;
+			return primitives;
+		}
+
+		bool ColladaFile::loadPrimitive(XmlElement& primitive, const std::vector<XmlElement*>& materials, MeshData& loadTo_mesh) {
+			/** loads the (triangulated) vertices + indices of a primitive group and finds the texture of its material
+			* the vertex layout is always position, uv, normal (missing uvs / normals get a default value)
+			* @return false if the primitive group could not be loaded */
+
+			// finding the inputs (a VERTEX input references the inputs of the <vertices> element, which use its offset)
+			ColladaInput position, uv, normal;
+			int index_stride = 1; // the number of indices per vertex
+
+			for (XmlElement* input = primitive.getFirstChild(); input; input = input->getNextSibling()) {
+
+				if (input->getName() != "input")
+					continue;
+
+				const XmlTagAttrib* semantic = input->getAttribute("semantic");
+				const XmlTagAttrib* source = input->getAttribute("source");
+				int offset = getIntAttribute(input, "offset", 0);
+				int set = getIntAttribute(input, "set", 0);
+
+				index_stride = std::max(index_stride, offset + 1);
+
+				if (!semantic || !source)
+					continue;
+
+				std::vector<std::pair<XmlString, XmlString>> semantics; // semantic, source
+
+				if (semantic->m_value == "\"VERTEX\"") {
+
+					XmlElement* vertices = getElementById(source->m_value);
+					if (!vertices)
+						continue;
+
+					for (XmlElement* vertex_input = vertices->getFirstChild(); vertex_input; vertex_input = vertex_input->getNextSibling()) {
+
+						const XmlTagAttrib* vertex_semantic = vertex_input->getAttribute("semantic");
+						const XmlTagAttrib* vertex_source = vertex_input->getAttribute("source");
+
+						if ((vertex_input->getName() == "input") && vertex_semantic && vertex_source)
+							semantics.emplace_back(vertex_semantic->m_value, vertex_source->m_value);
+					}
+
+				} else {
+
+					semantics.emplace_back(semantic->m_value, source->m_value);
+				}
+
+				for (const std::pair<XmlString, XmlString>& input_semantic : semantics) {
+
+					ColladaInput* target = 0;
+
+					if (input_semantic.first == "\"POSITION\"")
+						target = &position;
+					else if (input_semantic.first == "\"NORMAL\"")
+						target = &normal;
+					else if (input_semantic.first == "\"TEXCOORD\"")
+						target = &uv;
+
+					// the first input of a semantic (or the one with the lowest set) is used
+					if (target && ((target->offset == -1) || (set < target->set))) {
+						target->source = input_semantic.second;
+						target->offset = offset;
+						target->set = set;
+					}
+
+				}
 
-			if (position_source) {
-				attribute_data.emplace_back(std::vector<float>());
-				extractFloatArray(attribute_data.back(), position_source->getContent(), -1);
-				vertex_layout.m_types.push_back(UND_VEC3F);
 			}
 
-			if (uv_source) {
-				attribute_data.emplace_back(std::vector<float>());
-				extractFloatArray(attribute_data.back(), uv_source->getContent(), -1);
-				vertex_layout.m_types.push_back(UND_VEC2F);
+			if (position.offset == -1) {
+				UND_WARNING << "failed to load primitive group: no vertex positions\n";
+				return false;
 			}
 
-			if (normal_source) {
+			// loading the vertex attributes
+			std::vector<ColladaInput> inputs;
+			std::vector<std::vector<float>> attribute_data;
+			BufferLayout vertex_layout;
+
+			for (ColladaInput* input : { &position, &uv, &normal }) {
+
+				FixedType type = (input == &uv) ? UND_VEC2F : UND_VEC3F;
 				attribute_data.emplace_back(std::vector<float>());
-				extractFloatArray(attribute_data.back(), normal_source->getContent(), -1);
-				vertex_layout.m_types.push_back(UND_VEC3F);
+				inputs.push_back(*input);
+				vertex_layout.m_types.push_back(type);
+
+				if (input->offset == -1) {
+					// all meshes get the same vertex layout, a missing attribute gets one default value used by every vertex
+					if (input == &uv)
+						attribute_data.back() = { 0.0f, 0.0f };
+					else
+						attribute_data.back() = { 0.0f, 0.0f, 1.0f };
+
+					continue;
+				}
+
+				if (!loadSource(input->source, type.m_num_components, attribute_data.back())) {
+					UND_WARNING << "failed to load primitive group: failed to load source " << input->source << "\n";
+					return false;
+				}
+
+			}
+
+			// getting the index tuple of each triangle corner
+			std::vector<int> triangle_indices;
+			if (!getTriangleIndices(primitive, index_stride, triangle_indices))
+				return false;
+
+			// picking the indices of the loaded attributes (pos, uv, normal) from each tuple
+			std::vector<int> attribute_indices;
+			attribute_indices.reserve(triangle_indices.size() / index_stride * inputs.size());
+
+			for (size_t tuple = 0; tuple < triangle_indices.size(); tuple += index_stride) {
+
+				for (size_t i = 0; i < inputs.size(); i++) {
+
+					// (missing attributes use their default value)
+					int index = (inputs.at(i).offset == -1) ? 0 : triangle_indices.at(tuple + inputs.at(i).offset);
+
+					if ((index < 0) || (size_t(index + 1) * vertex_layout.m_types.at(i).m_num_components > attribute_data.at(i).size())) {
+						UND_WARNING << "failed to load primitive group: index out of range (" << index << ")\n";
+						return false;
+					}
+
+					attribute_indices.push_back(index);
+				}
+
 			}
 
-			// getting attribute index data
-			XmlElement* index_source = 0;
-			for (const std::string& primitive_type : primitive_types) {
-				index_source = mesh->getElement({ primitive_type, "p" });
-				if (index_source)
-					break;
+			// building the vertices, each unique combination of attribute indices becomes one vertex
+			// (comparing the indices is a lot faster than comparing the vertices afterwards (see buildIndices()))
+			size_t tuple_size = inputs.size();
+			size_t vertex_count = attribute_indices.size() / tuple_size;
+
+			IndexTupleHash hash(attribute_indices, tuple_size);
+			IndexTupleEqual equal(attribute_indices, tuple_size);
+			std::unordered_map<size_t, int, IndexTupleHash, IndexTupleEqual> unique_vertices(vertex_count, hash, equal);
+
+			loadTo_mesh.vertices.reserve(vertex_count * vertex_layout.getTotalSize() / sizeof(float));
+			loadTo_mesh.indices.reserve(vertex_count);
+
+			for (size_t vertex = 0; vertex < vertex_count; vertex++) {
+
+				std::pair<std::unordered_map<size_t, int, IndexTupleHash, IndexTupleEqual>::iterator, bool> unique_vertex = unique_vertices.emplace(vertex, unique_vertices.size());
+
+				if (unique_vertex.second) {
+					// first occurrence of the vertex
+					for (size_t i = 0; i < tuple_size; i++) {
+
+						int num_components = vertex_layout.m_types.at(i).m_num_components;
+						std::vector<float>::const_iterator data = attribute_data.at(i).begin() + attribute_indices.at(vertex * tuple_size + i) * num_components;
+
+						loadTo_mesh.vertices.insert(loadTo_mesh.vertices.end(), data, data + num_components);
+					}
+
+				}
+
+				loadTo_mesh.indices.push_back(unique_vertex.first->second);
 			}
 
-			if (!index_source)
-				return;
+			loadTo_mesh.vertex_layout = vertex_layout;
+			optimizeMesh(loadTo_mesh);
+			quantizeMesh(loadTo_mesh);
 
-			std::vector<int> attrib_indices, rearranged_attr_indices;
-			extractIntArray(attrib_indices, index_source->getContent(), -1);
+			// finding the material (and with it the texture) of the primitive group
+			// the material is referenced by a symbol, which (as in files exported by blender) is expected to be the id of the material
+			const XmlTagAttrib* material_symbol = primitive.getAttribute("material");
+			if (!material_symbol)
+				return true;
 
-			rearrangeAttribIndices(attrib_indices, { 0,2,1 }, rearranged_attr_indices);
+			std::vector<XmlElement*>::const_iterator material = std::find(materials.begin(), materials.end(), getElementById(material_symbol->m_value));
 
-			// building the vertices
-			buildMeshVertices(vertices, attribute_data, vertex_layout, rearranged_attr_indices);
+			if (material != materials.end())
+				loadTo_mesh.color_texture = m_material_textures.at(material - materials.begin());
 
+			return true;
 		}
 
+		bool ColladaFile::getTriangleIndices(XmlElement& primitive, int index_stride, std::vector<int>& loadTo_indices) {
+			/** reads the index tuples (index_stride indices per vertex) of the primitive group
+			* polygons get triangulated (as fans), so that there are 3 tuples per triangle
+			* @return false if the index data is invalid */
 
-		XmlElement* ColladaFile::getMeshSource(XmlElement* mesh, const std::string& source_name) {
-			/** @param source_name: POSITION, NORMAL or TEXCOORD
-			* @return the element containing the actual data (float array) */
+			struct Polygon {
+				size_t first_vertex;
+				int vertex_count;
+				bool strip; // tristrips alternate the winding order
+			};
 
-			if (!mesh)
-				return 0;
+			std::vector<int> indices; // the tuples as they are stored in the file
+			std::vector<Polygon> polygons;
+
+			const XmlString& type = primitive.getName();
+
+			if ((type == "triangles") || (type == "polylist")) {
+				// all polygons are stored in one <p> element
+
+				XmlElement* p = primitive.getElement(p_query);
+				if (!p)
+					return false; // no triangles
+
+				extractIntArray(indices, p->getContent().begin(), p->getContent().end());
+
+				std::vector<int> vcount;
+				XmlElement* vcount_element = primitive.getElement(vcount_query);
+
+				if ((type == "polylist") && vcount_element)
+					extractIntArray(vcount, vcount_element->getContent().begin(), vcount_element->getContent().end());
+				else
+					vcount.assign(indices.size() / index_stride / 3, 3);
+
+				size_t first_vertex = 0;
 
-			bool position_source = !source_name.compare("POSITION");
+				for (int vertex_count : vcount) {
+					polygons.push_back({ first_vertex, vertex_count, false });
+					first_vertex += std::max(vertex_count, 0);
+				}
+
+			} else {
+				// polygons, trifans and tristrips store each polygon in its own <p> element
+				// (the holes of polygons (<ph>) are not supported)
+
+				for (XmlElement* p = primitive.getFirstChild(); p; p = p->getNextSibling()) {
 
-			XmlElement* input_semantic = 0;
+					if (p->getName() != "p")
+						continue;
+
+					size_t first_vertex = indices.size() / index_stride;
+					extractIntArray(indices, p->getContent().begin(), p->getContent().end());
+
+					polygons.push_back({ first_vertex, int(indices.size() / index_stride - first_vertex), type == "tristrips" });
+				}
 
-			if (position_source) {
+			}
 
-				input_semantic = mesh->getElement({ "vertices", "input semantic=" + ('"' + source_name) + '"' });
+			if (indices.size() % index_stride) {
+				UND_WARNING << "failed to load primitive group: the number of indices does not match the inputs\n";
+				return false;
 			}
-			else {
 
-				for (const std::string& primitive_type : primitive_types) {
+			size_t vertex_count = indices.size() / index_stride;
+			std::vector<size_t> triangle_vertices; // 3 per triangle
+
+			for (const Polygon& polygon : polygons) {
+
+				if (polygon.first_vertex + std::max(polygon.vertex_count, 0) > vertex_count) {
+					UND_WARNING << "failed to load primitive group: vcount does not match the number of indices\n";
+					return false;
+				}
 
-					input_semantic = mesh->getElement({ primitive_type, "input semantic=" + ('"' + source_name) + '"' });
+				for (int i = 1; i + 1 < polygon.vertex_count; i++) {
+
+					if (!polygon.strip) {
+						// fan around the first vertex
+						triangle_vertices.push_back(polygon.first_vertex);
+						triangle_vertices.push_back(polygon.first_vertex + i);
+						triangle_vertices.push_back(polygon.first_vertex + i + 1);
+					} else {
+						// every second triangle of a strip has to be flipped to keep the winding order
+						triangle_vertices.push_back(polygon.first_vertex + i - ((i % 2) ? 1 : 0));
+						triangle_vertices.push_back(polygon.first_vertex + i - ((i % 2) ? 0 : 1));
+						triangle_vertices.push_back(polygon.first_vertex + i + 1);
+					}
 
-					if (input_semantic)
-						break;
 				}
+
 			}
 
-			if (!input_semantic)
-				return 0;
+			loadTo_indices.reserve(loadTo_indices.size() + triangle_vertices.size() * index_stride);
+
+			for (size_t vertex : triangle_vertices)
+				loadTo_indices.insert(loadTo_indices.end(), indices.begin() + vertex * index_stride, indices.begin() + (vertex + 1) * index_stride);
+
+			return true;
+		}
+
+		bool ColladaFile::loadSource(const XmlString& source_id, int num_components, std::vector<float>& loadTo_data) {
+			/** loads the data of a source with num_components floats per element
+			* (the elements of the source may have more / less components (accessor stride), they get cut off / filled with 0) */
+
+			XmlElement* source = getElementById(source_id);
+			if (!source)
+				return false;
+
+			XmlElement* float_array = source->getElement(float_array_query);
+			if (!float_array)
+				return false;
+
+			XmlElement* accessor = source->getElement(accessor_query);
+			int stride = accessor ? getIntAttribute(accessor, "stride", num_components) : num_components;
+
+			if (stride == num_components) {
+				// the data can be used as it is
+				extractFloatArray(loadTo_data, float_array->getContent().begin(), float_array->getContent().end());
+				return true;
+			}
+
+			if (stride <= 0)
+				return false;
+
+			std::vector<float> data;
+			extractFloatArray(data, float_array->getContent().begin(), float_array->getContent().end());
 
-			const XmlTagAttrib* source_attribute = input_semantic->getAttribute("source");
-			if (!source_attribute)
-				return 0;
+			size_t element_count = data.size() / stride;
+			loadTo_data.resize(element_count * num_components, 0.0f);
 
-			std::string source_id = source_attribute->m_value;
-			source_id.erase(1, 1); // they put a stupid # here
+			for (size_t i = 0; i < element_count; i++)
+				for (int c = 0; c < std::min(stride, num_components); c++)
+					loadTo_data.at(i * num_components + c) = data.at(i * stride + c);
 
-			return mesh->getElement({ "source id=" + source_id, "float_array" });
+			return true;
 		}
 
+
 		//////////////////////////////// functions to load textures for a material ////////////////////////////////
 
-		void ColladaFile::loadMaterialTextures(XmlElement* material, ImageData& loadTo_texture) {
+		void ColladaFile::findTextureFiles() {
+			/** finds the texture file of each material (materials using the same file share the texture) */
+
+			if (m_texture_files_found)
+				return;
+
+			m_texture_files.clear();
+			m_material_textures.clear();
+
+			std::unordered_map<std::string, int> texture_ids;
+
+			for (XmlElement* material : getAllElements(materials_query)) {
+
+				std::string file_name = getMaterialTextureFile(material);
+				std::unordered_map<std::string, int>::iterator texture_id = texture_ids.find(file_name);
+
+				if (texture_id == texture_ids.end()) {
+					texture_id = texture_ids.emplace(file_name, m_texture_files.size()).first;
+					m_texture_files.push_back(file_name);
+				}
+
+				m_material_textures.push_back(texture_id->second);
+			}
+
+			m_texture_files_found = true;
+		}
+
+		std::string ColladaFile::getMaterialTextureFile(XmlElement* material) {
+			/** @return the file name of the materials color texture ("" if the material has no texture) */
 			// its a long and tedious process to get the name of the Texture-File ...
 
-			XmlElement* instance_effect = material->getElement({ "instance_effect" });
+			XmlElement* instance_effect = material->getElement(instance_effect_query);
 			if (!instance_effect)
-				return;
+				return "";
 
 			const XmlTagAttrib* effect_url = instance_effect->getAttribute("url");
 			if (!effect_url)
-				return;
+				return "";
 
-			std::string effect_id = effect_url->m_value;
-			effect_id.erase(1, 1); // removing stupid #
-			XmlElement* effect = getElement({ "COLLADA", "library_effects", "effect id=" + effect_id });
+			XmlElement* effect = getElementById(effect_url->m_value);
 			if (!effect)
-				return;
+				return "";
 
-			XmlElement* diffuse_texture = effect->getElement({ "profile_COMMON", "technique", "phong", "diffuse", "texture" });
+			XmlElement* diffuse_texture = effect->getElement(diffuse_texture_query);
 			if (!diffuse_texture)
-				return;
+				return "";
 
 			const XmlTagAttrib* sampler_name = diffuse_texture->getAttribute("texture");
 			if (!sampler_name)
-				return;
+				return "";
 
 			XmlElement* sampler_2D_source = effect->getElement({ "profile_COMMON", "newparam sid=" + sampler_name->m_value, "sampler2D", "source" });
 			if (!sampler_2D_source)
-				return;
+				return "";
 
 			XmlElement* image_name = effect->getElement({ "profile_COMMON", "newparam sid=" + ('"' + sampler_2D_source->getContent()) + '"', "surface", "init_from" });
 			if (!image_name)
-				return;
+				return "";
 
-			XmlElement* image_file_name = getElement({ "COLLADA", "library_images", "image id=" + ('"' + image_name->getContent()) + '"', "init_from" });
+			XmlElement* image = getElementById(image_name->getContent());
+			if (!image)
+				return "";
+
+			XmlElement* image_file_name = image->getElement(init_from_query);
 			if (!image_file_name)
-				return;
+				return "";
 
-            ImageFile image_file(getFilePath(m_file_name) + image_file_name->getContent(), loadTo_texture);
+			return getFilePath(m_file_name) + image_file_name->getContent();
 
 		}
 
@@ -11,16 +11,41 @@ namespace undicht {
 
 		class ColladaFile : public ModelLoader, public XmlFile {
 
+			protected:
+
+				// the texture files used by the materials (each file is stored once, "" for materials without a texture)
+				std::vector<std::string> m_texture_files;
+				// for each material the id of its texture in m_texture_files
+				std::vector<int> m_material_textures;
+				bool m_texture_files_found = false;
+
+				// the meshes loaded from the mesh cache of the file (see MeshCache)
+				std::vector<MeshData> m_cached_meshes;
+				bool m_use_mesh_cache = true;
+				bool m_mesh_cache_loaded = false;
+
 			public:
+
+				/** loads the xml data of the file
+				* if there is an up to date mesh cache for the file, the meshes + texture files are loaded from it instead
+				* (the xml data is not parsed then, so the XmlFile functions wont find any elements) */
+				virtual bool open(const std::string& file_name, bool memory_map = false);
+
+				/** whether to use the binary mesh cache stored next to the file (enabled by default)
+				* the cache gets written when all meshes are loaded from the parsed file (see loadAllMeshes())
+				* has to be set before the file is opened */
+				void setUseMeshCache(bool use_cache);
+
 				// ModelLoader api functions
 
 				////////////////////////////////////////// functions to load single meshes / textures ///////////////////////////////////////////
 
-				/** @return the number of meshes stored in the file */
+				/** @return the number of meshes stored in the file (each primitive group of a geometry is loaded as its own mesh) */
 				virtual int getMeshCount();
 
 				/** @return the number of unique textures used by the meshes
-				* if a mesh should use for example a color + normal texture, thats 2 */
+				* if a mesh should use for example a color + normal texture, thats 2
+				* (materials using the same image file share the texture, materials without a texture share an empty one) */
 				virtual int getTextureCount();
 
 				/** loads the vertices of the mesh
@@ -32,28 +57,53 @@ namespace undicht {
 
 				////////////////////////////////////////// functions to load all meshes / textures ///////////////////////////////////////////
 
+				/** the geometries are loaded in parallel (if a thread pool was set), the order of the meshes stays the same
+				* (one mesh per primitive group of each geometry)
+				* if the mesh cache is used, the meshes are copied from it / the cache gets written afterwards */
 				virtual void loadAllMeshes(std::vector<MeshData>& loadTo_meshes);
 
+				/** each unique image file is decoded once (in parallel, if a thread pool was set) */
 				virtual void loadAllTextures(std::vector<ImageData>& loadTo_textures);
 
 		    private:
 		        // functions to bring more structure to the loading process
 
-				/** loading the vertices from a geometry element */
-		        virtual void loadGeometry(XmlElement& geometry, std::vector<float>& vertices, BufferLayout& vertex_layout);
+				/** loads one mesh for each primitive group (triangles, polylist ...) of the geometry
+				* (only reads from the xml tree, so multiple geometries can be loaded at the same time)
+				* primitive groups that fail to load are skipped */
+				virtual void loadGeometry(XmlElement& geometry, const std::vector<XmlElement*>& materials, std::vector<MeshData>& loadTo_meshes);
+
+				/** @return the primitive groups of the geometry that can be triangulated (in the order they are stored in) */
+				virtual std::vector<XmlElement*> getPrimitives(XmlElement& geometry);
+
+				/** loads the (triangulated) vertices + indices of a primitive group and finds the texture of its material
+				* the vertex layout is always position, uv, normal (missing uvs / normals get a default value)
+				* @return false if the primitive group could not be loaded */
+				virtual bool loadPrimitive(XmlElement& primitive, const std::vector<XmlElement*>& materials, MeshData& loadTo_mesh);
 
-		        /** @param source_name: POSITION, NORMAL or TEXCOORD
-		        * @return the element containing the actual data (float array) (0 if the mesh does not have a source with that name) */
-		        virtual XmlElement* getMeshSource(XmlElement* mesh, const std::string& source_name);
+				/** reads the index tuples (index_stride indices per vertex) of the primitive group
+				* polygons get triangulated (as fans), so that there are 3 tuples per triangle
+				* @return false if the index data is invalid */
+				virtual bool getTriangleIndices(XmlElement& primitive, int index_stride, std::vector<int>& loadTo_indices);
+
+				/** loads the data of a source with num_components floats per element
+				* (the elements of the source may have more / less components (accessor stride), they get cut off / filled with 0) */
+				virtual bool loadSource(const XmlString& source_id, int num_components, std::vector<float>& loadTo_data);
 
 		        // functions to load textures for a material
 
-		        virtual void loadMaterialTextures(XmlElement* material, ImageData& loadTo_texture);
+		        /** finds the texture file of each material (materials using the same file share the texture)
+		        * has to happen before meshes get loaded in parallel */
+		        virtual void findTextureFiles();
+
+		        /** @return the file name of the materials color texture ("" if the material has no texture) */
+		        virtual std::string getMaterialTextureFile(XmlElement* material);
 
 			public:
 
 		        ColladaFile();
-		        ColladaFile(const std::string& file_name);
+		        /** @param memory_map: map the file into memory instead of reading it (see XmlFile::open()) */
+		        ColladaFile(const std::string& file_name, bool memory_map = false);
 		        virtual ~ColladaFile();
 
 		};
@@ -0,0 +1,262 @@
+#include "mesh_cache.h"
+#include "mapped_file.h"
+#include "file_tools.h"
+#include "debug.h"
+
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+
+
+namespace undicht {
+
+	namespace tools {
+
+		// has to be changed every time the layout of the cache file (or the way meshes are loaded) changes
+		const char MESH_CACHE_MAGIC[8] = { 'U', 'N', 'D', 'M', 'E', 'S', 'H', '\0' };
+		const uint32_t MESH_CACHE_VERSION = 4;
+
+		struct MeshCacheHeader {
+			char magic[8];
+			uint32_t version;
+			uint32_t mesh_count;
+			uint64_t source_size;
+			int64_t source_modification_time;
+			uint32_t texture_count;
+			uint32_t load_options; // see ModelLoader::getMeshLoadOptions()
+		};
+
+		struct MeshCacheEntry {
+			/// stored in front of the data of each mesh
+			int32_t color_texture;
+			uint32_t type_count; // number of vertex attributes (BufferLayout::m_types)
+			uint64_t vertex_count; // number of floats
+			uint64_t index_count;
+			float position_offset[3];
+			float position_scale[3];
+			uint32_t index_size; // 2 if all indices fit into 16 bits, else 4
+			uint32_t reserved = 0;
+		};
+
+		struct MeshCacheType {
+			uint32_t type;
+			uint32_t size;
+			uint32_t num_components;
+			uint32_t little_endian;
+		};
+
+		class MeshCacheReader {
+			/// reads data from the mapped cache file, checking that it does not read past the end
+		public:
+			const char* m_pos = 0;
+			const char* m_end = 0;
+
+			MeshCacheReader(const char* data, size_t size) : m_pos(data), m_end(data + size) {}
+
+			bool read(void* loadTo, size_t size) {
+
+				if (size > size_t(m_end - m_pos))
+					return false;
+
+				std::memcpy(loadTo, m_pos, size);
+				m_pos += size;
+
+				return true;
+			}
+		};
+
+		///////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+		std::string MeshCache::getCacheFileName(const std::string& source_file) {
+			/** @return the name of the cache file for the model file (stored next to it) */
+
+			return source_file + ".cache";
+		}
+
+		bool MeshCache::load(const std::string& source_file, uint32_t load_options, std::vector<MeshData>& loadTo_meshes, std::vector<std::string>& loadTo_texture_files) {
+			/** loads the meshes + texture files from the cache file (which is mapped into memory)
+			* @param load_options: the options the meshes should have been loaded with (see ModelLoader::getMeshLoadOptions())
+			* @return false, if the cache file doesnt exist, is invalid or belongs to an older version of the source file / other options */
+
+			std::string cache_file_name = getCacheFileName(source_file);
+
+			if (getFileModificationTime(cache_file_name) == -1)
+				return false; // no cache yet
+
+			MappedFile cache_file;
+			if (!cache_file.open(cache_file_name))
+				return false;
+
+			MeshCacheReader reader(cache_file.getData(), cache_file.getSize());
+
+			// checking whether the cache belongs to the current version of the source file
+			MeshCacheHeader header;
+			if (!reader.read(&header, sizeof(header)))
+				return false;
+
+			if (std::memcmp(header.magic, MESH_CACHE_MAGIC, sizeof(MESH_CACHE_MAGIC)) || (header.version != MESH_CACHE_VERSION))
+				return false;
+
+			if ((header.source_size != getFileSize(source_file)) || (header.source_modification_time != getFileModificationTime(source_file)))
+				return false;
+
+			if (header.load_options != load_options)
+				return false;
+
+			// the counts are used to allocate memory, so they have to fit into the rest of the file
+			// (each texture file is stored with at least its length, each mesh with at least its entry)
+			uint64_t min_data_size = uint64_t(header.texture_count) * sizeof(uint32_t) + uint64_t(header.mesh_count) * sizeof(MeshCacheEntry);
+			if (min_data_size > uint64_t(reader.m_end - reader.m_pos))
+				return false;
+
+			// texture files
+			std::vector<std::string> texture_files(header.texture_count);
+
+			for (std::string& texture_file : texture_files) {
+
+				uint32_t length = 0;
+				if (!reader.read(&length, sizeof(length)) || (length > size_t(reader.m_end - reader.m_pos)))
+					return false;
+
+				texture_file.assign(reader.m_pos, length);
+				reader.m_pos += length;
+			}
+
+			// meshes
+			std::vector<MeshData> meshes(header.mesh_count);
+
+			for (MeshData& mesh : meshes) {
+
+				MeshCacheEntry entry;
+				if (!reader.read(&entry, sizeof(entry)))
+					return false;
+
+				mesh.color_texture = entry.color_texture;
+				std::memcpy(mesh.position_offset, entry.position_offset, sizeof(mesh.position_offset));
+				std::memcpy(mesh.position_scale, entry.position_scale, sizeof(mesh.position_scale));
+
+				for (uint32_t i = 0; i < entry.type_count; i++) {
+
+					MeshCacheType type;
+					if (!reader.read(&type, sizeof(type)))
+						return false;
+
+					mesh.vertex_layout.m_types.push_back(FixedType(Type(type.type), type.size, type.num_components, type.little_endian));
+				}
+
+				if ((entry.index_size != sizeof(uint16_t)) && (entry.index_size != sizeof(int)))
+					return false;
+
+				if ((entry.vertex_count > size_t(reader.m_end - reader.m_pos) / sizeof(float)) || (entry.index_count > size_t(reader.m_end - reader.m_pos) / entry.index_size))
+					return false;
+
+				mesh.vertices.resize(entry.vertex_count);
+				mesh.indices.resize(entry.index_count);
+
+				if (!reader.read(mesh.vertices.data(), entry.vertex_count * sizeof(float)))
+					return false;
+
+				if (entry.index_size == sizeof(uint16_t)) {
+
+					std::vector<uint16_t> indices(entry.index_count);
+					if (!reader.read(indices.data(), entry.index_count * sizeof(uint16_t)))
+						return false;
+
+					mesh.indices.assign(indices.begin(), indices.end());
+				} else if (!reader.read(mesh.indices.data(), entry.index_count * sizeof(int))) {
+					return false;
+				}
+			}
+
+			loadTo_meshes.insert(loadTo_meshes.end(), meshes.begin(), meshes.end());
+			loadTo_texture_files = texture_files;
+
+			return true;
+		}
+
+		bool MeshCache::save(const std::string& source_file, uint32_t load_options, const std::vector<MeshData>& meshes, const std::vector<std::string>& texture_files) {
+			/** writes the cache file for the source file
+			* @return false if the file could not be written */
+
+			std::string cache_file_name = getCacheFileName(source_file);
+
+			// writing to a temporary file first, so that no half written cache can be loaded
+			std::string tmp_file_name = cache_file_name + ".tmp";
+			std::ofstream cache_file(tmp_file_name, std::ios::binary | std::ios::trunc);
+
+			if (!cache_file.is_open())
+				return false;
+
+			MeshCacheHeader header;
+			std::memcpy(header.magic, MESH_CACHE_MAGIC, sizeof(MESH_CACHE_MAGIC));
+			header.version = MESH_CACHE_VERSION;
+			header.mesh_count = meshes.size();
+			header.source_size = getFileSize(source_file);
+			header.source_modification_time = getFileModificationTime(source_file);
+			header.texture_count = texture_files.size();
+			header.load_options = load_options;
+
+			cache_file.write((const char*)&header, sizeof(header));
+
+			for (const std::string& texture_file : texture_files) {
+
+				uint32_t length = texture_file.size();
+				cache_file.write((const char*)&length, sizeof(length));
+				cache_file.write(texture_file.data(), length);
+			}
+
+			for (const MeshData& mesh : meshes) {
+
+				MeshCacheEntry entry;
+				entry.color_texture = mesh.color_texture;
+				entry.type_count = mesh.vertex_layout.m_types.size();
+				entry.vertex_count = mesh.vertices.size();
+				entry.index_count = mesh.indices.size();
+				std::memcpy(entry.position_offset, mesh.position_offset, sizeof(entry.position_offset));
+				std::memcpy(entry.position_scale, mesh.position_scale, sizeof(entry.position_scale));
+
+				// storing the indices as uint16, if they fit
+				std::vector<uint16_t> narrowed_indices;
+				entry.index_size = sizeof(uint16_t);
+
+				for (int index : mesh.indices)
+					if ((index < 0) || (index > 0xFFFF))
+						entry.index_size = sizeof(int);
+
+				if (entry.index_size == sizeof(uint16_t))
+					narrowed_indices.assign(mesh.indices.begin(), mesh.indices.end());
+
+				cache_file.write((const char*)&entry, sizeof(entry));
+
+				for (const FixedType& fixed_type : mesh.vertex_layout.m_types) {
+
+					MeshCacheType type;
+					type.type = uint32_t(fixed_type.m_type);
+					type.size = fixed_type.m_size;
+					type.num_components = fixed_type.m_num_components;
+					type.little_endian = fixed_type.m_little_endian;
+
+					cache_file.write((const char*)&type, sizeof(type));
+				}
+
+				cache_file.write((const char*)mesh.vertices.data(), mesh.vertices.size() * sizeof(float));
+
+				if (entry.index_size == sizeof(uint16_t))
+					cache_file.write((const char*)narrowed_indices.data(), narrowed_indices.size() * sizeof(uint16_t));
+				else
+					cache_file.write((const char*)mesh.indices.data(), mesh.indices.size() * sizeof(int));
+			}
+
+			cache_file.close();
+
+			if (!cache_file.good() || std::rename(tmp_file_name.c_str(), cache_file_name.c_str())) {
+				std::remove(tmp_file_name.c_str());
+				return false;
+			}
+
+			return true;
+		}
+
+	} // tools
+
+} // undicht
@@ -0,0 +1,40 @@
+#ifndef MESH_CACHE_H
+#define MESH_CACHE_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "model_loading/model_loader.h"
+
+
+namespace undicht {
+
+	namespace tools {
+
+		class MeshCache {
+			/** a binary file storing the meshes + texture file names loaded from a model file
+			* so that the model file doesnt have to be parsed again the next time it is loaded
+			* the cache stores the size and modification time of the model file, if they changed the cache is outdated
+			* (the data is stored in the byte order of the machine, since the cache is not meant to be shared) */
+		public:
+
+			/** @return the name of the cache file for the model file (stored next to it) */
+			static std::string getCacheFileName(const std::string& source_file);
+
+			/** loads the meshes + texture files from the cache file (which is mapped into memory)
+			* @param load_options: the options the meshes should have been loaded with (see ModelLoader::getMeshLoadOptions())
+			* @return false, if the cache file doesnt exist, is invalid or belongs to an older version of the source file / other options */
+			bool load(const std::string& source_file, uint32_t load_options, std::vector<MeshData>& loadTo_meshes, std::vector<std::string>& loadTo_texture_files);
+
+			/** writes the cache file for the source file
+			* @return false if the file could not be written */
+			bool save(const std::string& source_file, uint32_t load_options, const std::vector<MeshData>& meshes, const std::vector<std::string>& texture_files);
+
+		};
+
+	} // tools
+
+} // undicht
+
+#endif // MESH_CACHE_H
@@ -0,0 +1,418 @@
+#include "mesh_optimizer.h"
+#include "debug.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+namespace undicht {
+
+	namespace tools {
+
+		// a new cluster of triangles is started once the vertex cache was used that well (see optimizeVertexCache())
+		const float CLUSTER_ACMR_THRESHOLD = 0.75f;
+		// smaller clusters would cause too many cache misses at their borders (in multiples of the cache size)
+		const size_t MIN_CLUSTER_SIZE = 16;
+		// the overdraw optimization is only kept if the ACMR gets at most that much worse
+		const float MAX_OVERDRAW_ACMR_INCREASE = 1.05f;
+
+		MeshOptimizer::MeshOptimizer(unsigned int cache_size, bool optimize_overdraw)
+			: m_cache_size(std::max(cache_size, 3u)), m_optimize_overdraw(optimize_overdraw) {
+
+			resetStats();
+		}
+
+		void MeshOptimizer::optimize(MeshData& mesh) {
+			/** reorders the triangles (optimizeVertexCache(), optimizeOverdraw()) and the vertices (optimizeVertexFetch()) of the mesh
+			* meshes without indices are not changed */
+
+			size_t vertex_size = mesh.vertex_layout.getTotalSize() / sizeof(float);
+
+			if (mesh.indices.empty() || (mesh.indices.size() % 3) || !vertex_size)
+				return;
+
+			size_t vertex_count = mesh.vertices.size() / vertex_size;
+
+			for (int index : mesh.indices) {
+				if ((index < 0) || (size_t(index) >= vertex_count)) {
+					UND_WARNING << "failed to optimize mesh: index out of range (" << index << ")\n";
+					return;
+				}
+			}
+
+			size_t misses_before = countCacheMisses(mesh.indices, vertex_count);
+
+			if (m_optimize_overdraw) {
+
+				std::vector<size_t> clusters;
+				optimizeVertexCache(mesh.indices, vertex_count, &clusters);
+
+				// sorting the clusters breaks the order of the triangles at the cluster borders
+				std::vector<int> sorted_indices = mesh.indices;
+				optimizeOverdraw(mesh, sorted_indices, clusters);
+
+				if (countCacheMisses(sorted_indices, vertex_count) <= countCacheMisses(mesh.indices, vertex_count) * MAX_OVERDRAW_ACMR_INCREASE)
+					mesh.indices.swap(sorted_indices);
+			} else {
+
+				optimizeVertexCache(mesh.indices, vertex_count);
+			}
+
+			optimizeVertexFetch(mesh);
+
+			m_triangle_count += mesh.indices.size() / 3;
+			m_cache_misses_before += misses_before;
+			m_cache_misses_after += countCacheMisses(mesh.indices, mesh.vertices.size() / vertex_size);
+		}
+
+		unsigned int MeshOptimizer::getCacheSize() const {
+
+			return m_cache_size;
+		}
+
+		bool MeshOptimizer::getOptimizeOverdraw() const {
+
+			return m_optimize_overdraw;
+		}
+
+		float MeshOptimizer::getACMRBefore() const {
+			/** @return the ACMR of all meshes optimized since the last resetStats() before the optimization */
+
+			if (!m_triangle_count)
+				return 0.0f;
+
+			return float(m_cache_misses_before) / float(m_triangle_count);
+		}
+
+		float MeshOptimizer::getACMRAfter() const {
+			/** @return the ACMR of all meshes optimized since the last resetStats() after the optimization */
+
+			if (!m_triangle_count)
+				return 0.0f;
+
+			return float(m_cache_misses_after) / float(m_triangle_count);
+		}
+
+		void MeshOptimizer::resetStats() {
+
+			m_triangle_count = 0;
+			m_cache_misses_before = 0;
+			m_cache_misses_after = 0;
+		}
+
+		/////////////////////////////////////////////// single optimization passes ///////////////////////////////////////////////
+
+		size_t MeshOptimizer::countCacheMisses(const std::vector<int>& indices, size_t vertex_count) const {
+			/** @return the number of vertices that have to be transformed when drawing the triangles (simulated fifo cache) */
+
+			// the number of misses when the vertex was added to the cache (0: never added)
+			// a vertex is still in the cache if less than m_cache_size vertices were added after it
+			std::vector<size_t> added_at(vertex_count, 0);
+			size_t misses = 0;
+
+			for (int index : indices) {
+
+				if (added_at.at(index) && (misses - added_at.at(index) < m_cache_size))
+					continue; // cache hit
+
+				misses++;
+				added_at.at(index) = misses;
+			}
+
+			return misses;
+		}
+
+		float MeshOptimizer::calcACMR(const std::vector<int>& indices, size_t vertex_count) const {
+			/** @return the average number of vertices that have to be transformed per triangle (0.5 - 3.0, lower is better) */
+
+			if (indices.size() < 3)
+				return 0.0f;
+
+			return float(countCacheMisses(indices, vertex_count)) / float(indices.size() / 3);
+		}
+
+		void MeshOptimizer::optimizeVertexCache(std::vector<int>& indices, size_t vertex_count, std::vector<size_t>* loadTo_clusters) const {
+			/** reorders the triangles, so that triangles using the same vertices are drawn close to each other (Tipsify)
+			* the triangles around a vertex are drawn as a fan, the next vertex is one of the fans vertices that will still be in the cache
+			* after its remaining triangles were drawn (the one that was added to the cache first)
+			* if there is no such vertex, a recently used vertex with triangles left (or the next vertex with triangles left) is picked */
+
+			size_t triangle_count = indices.size() / 3;
+
+			// the triangles using each vertex
+			std::vector<size_t> first_triangle(vertex_count + 1, 0);
+			for (int index : indices)
+				first_triangle.at(index + 1)++;
+
+			for (size_t vertex = 0; vertex < vertex_count; vertex++)
+				first_triangle.at(vertex + 1) += first_triangle.at(vertex);
+
+			std::vector<size_t> vertex_triangles(indices.size());
+			std::vector<size_t> fill_pos(first_triangle.begin(), first_triangle.end() - 1);
+
+			for (size_t i = 0; i < indices.size(); i++)
+				vertex_triangles.at(fill_pos.at(indices.at(i))++) = i / 3;
+
+			// the number of triangles left for each vertex
+			std::vector<int> live_triangles(vertex_count);
+			for (size_t vertex = 0; vertex < vertex_count; vertex++)
+				live_triangles.at(vertex) = first_triangle.at(vertex + 1) - first_triangle.at(vertex);
+
+			std::vector<size_t> cache_time(vertex_count, 0);
+			size_t time = m_cache_size + 1; // increases with every vertex added to the cache
+			std::vector<bool> emitted(triangle_count, false);
+			std::vector<int> dead_ends; // recently used vertices
+			size_t cursor = 0; // all vertices before the cursor have no triangles left
+
+			std::vector<int> optimized_indices;
+			optimized_indices.reserve(indices.size());
+
+			if (loadTo_clusters)
+				loadTo_clusters->assign(1, 0);
+
+			size_t cluster_start_time = time;
+			size_t cluster_start_triangle = 0;
+
+			// finds the next vertex with triangles left (false if all triangles were drawn)
+			auto skipDeadEnd = [&](int& loadTo_vertex, bool& loadTo_hard_boundary) {
+
+				while (!dead_ends.empty()) {
+
+					int vertex = dead_ends.back();
+					dead_ends.pop_back();
+
+					if (live_triangles.at(vertex) > 0) {
+						loadTo_vertex = vertex;
+						loadTo_hard_boundary = false;
+						return true;
+					}
+				}
+
+				while (cursor < vertex_count) {
+
+					if (live_triangles.at(cursor) > 0) {
+						loadTo_vertex = cursor;
+						loadTo_hard_boundary = true;
+						return true;
+					}
+
+					cursor++;
+				}
+
+				return false;
+			};
+
+			int fan_vertex = 0;
+			bool hard_boundary = true;
+			std::vector<int> candidates; // the vertices of the current fan
+
+			while (skipDeadEnd(fan_vertex, hard_boundary)) {
+
+				// the triangles drawn after a jump to an unrelated vertex dont share vertices with the ones before
+				if (loadTo_clusters && hard_boundary && (optimized_indices.size() / 3 > cluster_start_triangle)) {
+
+					loadTo_clusters->push_back(optimized_indices.size() / 3);
+					cluster_start_time = time;
+					cluster_start_triangle = optimized_indices.size() / 3;
+				}
+
+				while (true) {
+					// drawing all triangles left around the fan vertex
+
+					candidates.clear();
+
+					for (size_t i = first_triangle.at(fan_vertex); i < first_triangle.at(fan_vertex + 1); i++) {
+
+						size_t triangle = vertex_triangles.at(i);
+						if (emitted.at(triangle))
+							continue;
+
+						for (size_t corner = 0; corner < 3; corner++) {
+
+							int vertex = indices.at(triangle * 3 + corner);
+
+							optimized_indices.push_back(vertex);
+							dead_ends.push_back(vertex);
+							candidates.push_back(vertex);
+							live_triangles.at(vertex)--;
+
+							if (time - cache_time.at(vertex) > m_cache_size) {
+								// the vertex has to be added to the cache
+								cache_time.at(vertex) = time;
+								time++;
+							}
+
+						}
+
+						emitted.at(triangle) = true;
+					}
+
+					// starting a new cluster once the triangles of the current cluster used the cache well
+					size_t cluster_triangles = optimized_indices.size() / 3 - cluster_start_triangle;
+
+					if (loadTo_clusters && (cluster_triangles >= MIN_CLUSTER_SIZE * m_cache_size) && (optimized_indices.size() / 3 < triangle_count)) {
+
+						if (float(time - cluster_start_time) / float(cluster_triangles) < CLUSTER_ACMR_THRESHOLD) {
+
+							loadTo_clusters->push_back(optimized_indices.size() / 3);
+							cluster_start_time = time;
+							cluster_start_triangle = optimized_indices.size() / 3;
+						}
+					}
+
+					// finding the next fan vertex among the vertices of the fan
+					int next_vertex = -1;
+					int best_priority = -1;
+
+					for (int candidate : candidates) {
+
+						if (live_triangles.at(candidate) <= 0)
+							continue;
+
+						// vertices that would stay in the cache while their triangles get drawn are preferred (the oldest one first)
+						int priority = 0;
+						if (time - cache_time.at(candidate) + 2 * live_triangles.at(candidate) <= m_cache_size)
+							priority = time - cache_time.at(candidate);
+
+						if (priority > best_priority) {
+							best_priority = priority;
+							next_vertex = candidate;
+						}
+					}
+
+					if (next_vertex == -1)
+						break; // dead end
+
+					fan_vertex = next_vertex;
+				}
+			}
+
+			indices.swap(optimized_indices);
+		}
+
+		void MeshOptimizer::optimizeOverdraw(const MeshData& mesh, std::vector<int>& indices, const std::vector<size_t>& clusters) const {
+			/** sorts the clusters of triangles, so that the clusters facing outwards of the mesh get drawn first */
+
+			if (mesh.vertex_layout.m_types.empty() || (mesh.vertex_layout.m_types.at(0).m_type != Type::FLOAT) || (mesh.vertex_layout.m_types.at(0).m_num_components != 3))
+				return; // no positions
+
+			size_t vertex_size = mesh.vertex_layout.getTotalSize() / sizeof(float);
+			size_t triangle_count = indices.size() / 3;
+
+			// @return the position of the corner of the triangle
+			auto getPosition = [&](size_t triangle, size_t corner, int component) {
+				return mesh.vertices.at(indices.at(triangle * 3 + corner) * vertex_size + component);
+			};
+
+			struct Cluster {
+				size_t first_triangle;
+				size_t triangle_count;
+				float centroid[3] = { 0.0f, 0.0f, 0.0f }; // weighted by the area of the triangles
+				float normal[3] = { 0.0f, 0.0f, 0.0f }; // sum of the triangle normals (weighted by their area)
+				float area = 0.0f;
+				float sort_key = 0.0f;
+			};
+
+			std::vector<Cluster> mesh_clusters(clusters.size());
+			float mesh_centroid[3] = { 0.0f, 0.0f, 0.0f };
+			float mesh_area = 0.0f;
+
+			for (size_t i = 0; i < clusters.size(); i++) {
+
+				Cluster& cluster = mesh_clusters.at(i);
+				cluster.first_triangle = clusters.at(i);
+				cluster.triangle_count = ((i + 1 < clusters.size()) ? clusters.at(i + 1) : triangle_count) - cluster.first_triangle;
+
+				for (size_t triangle = cluster.first_triangle; triangle < cluster.first_triangle + cluster.triangle_count; triangle++) {
+
+					float edge0[3], edge1[3], normal[3];
+
+					for (int c = 0; c < 3; c++) {
+						edge0[c] = getPosition(triangle, 1, c) - getPosition(triangle, 0, c);
+						edge1[c] = getPosition(triangle, 2, c) - getPosition(triangle, 0, c);
+					}
+
+					normal[0] = edge0[1] * edge1[2] - edge0[2] * edge1[1];
+					normal[1] = edge0[2] * edge1[0] - edge0[0] * edge1[2];
+					normal[2] = edge0[0] * edge1[1] - edge0[1] * edge1[0];
+
+					float area = 0.5f * std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+
+					for (int c = 0; c < 3; c++) {
+
+						float center = (getPosition(triangle, 0, c) + getPosition(triangle, 1, c) + getPosition(triangle, 2, c)) / 3.0f;
+
+						cluster.centroid[c] += center * area;
+						cluster.normal[c] += normal[c]; // the length of the cross product is proportional to the area
+					}
+
+					cluster.area += area;
+				}
+
+				for (int c = 0; c < 3; c++)
+					mesh_centroid[c] += cluster.centroid[c];
+
+				mesh_area += cluster.area;
+			}
+
+			if (mesh_area <= 0.0f)
+				return;
+
+			for (int c = 0; c < 3; c++)
+				mesh_centroid[c] /= mesh_area;
+
+			// clusters whose normal points away from the center of the mesh are more likely to be visible
+			for (Cluster& cluster : mesh_clusters) {
+
+				if (cluster.area <= 0.0f)
+					continue;
+
+				float normal_length = std::sqrt(cluster.normal[0] * cluster.normal[0] + cluster.normal[1] * cluster.normal[1] + cluster.normal[2] * cluster.normal[2]);
+				if (normal_length <= 0.0f)
+					continue;
+
+				for (int c = 0; c < 3; c++)
+					cluster.sort_key += (cluster.centroid[c] / cluster.area - mesh_centroid[c]) * cluster.normal[c] / normal_length;
+			}
+
+			std::stable_sort(mesh_clusters.begin(), mesh_clusters.end(), [](const Cluster& c0, const Cluster& c1) {
+				return c0.sort_key > c1.sort_key;
+			});
+
+			std::vector<int> sorted_indices;
+			sorted_indices.reserve(indices.size());
+
+			for (const Cluster& cluster : mesh_clusters)
+				sorted_indices.insert(sorted_indices.end(), indices.begin() + cluster.first_triangle * 3, indices.begin() + (cluster.first_triangle + cluster.triangle_count) * 3);
+
+			indices.swap(sorted_indices);
+		}
+
+		void MeshOptimizer::optimizeVertexFetch(MeshData& mesh) const {
+			/** stores the vertices in the order they are first used by the indices (vertices that are not used get removed) */
+
+			size_t vertex_size = mesh.vertex_layout.getTotalSize() / sizeof(float);
+			if (!vertex_size)
+				return;
+
+			std::vector<int> new_index(mesh.vertices.size() / vertex_size, -1);
+			std::vector<float> vertices;
+			vertices.reserve(mesh.vertices.size());
+
+			for (int& index : mesh.indices) {
+
+				if (new_index.at(index) == -1) {
+					// first use of the vertex
+					new_index.at(index) = vertices.size() / vertex_size;
+					vertices.insert(vertices.end(), mesh.vertices.begin() + index * vertex_size, mesh.vertices.begin() + (index + 1) * vertex_size);
+				}
+
+				index = new_index.at(index);
+			}
+
+			mesh.vertices.swap(vertices);
+		}
+
+	} // tools
+
+} // undicht
@@ -0,0 +1,82 @@
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include <vector>
+#include <atomic>
+
+#include "model_loading/model_loader.h"
+#include "unique_object.h"
+
+
+namespace undicht {
+
+	namespace tools {
+
+		class MeshOptimizer : public core::UniqueObject {
+			/** reorders the triangles + vertices of indexed meshes, so that the gpu can reuse more transformed vertices
+			* (triangles using the same vertices are drawn close to each other (Tipsify), vertices are stored in the order they are used)
+			* the vertex cache of the gpu is simulated as a fifo cache to measure the average cache miss ratio (ACMR) of the meshes
+			* can be used by multiple threads at the same time */
+		protected:
+
+			unsigned int m_cache_size = 16;
+			bool m_optimize_overdraw = false;
+
+			// statistics of all meshes optimized since the last resetStats()
+			std::atomic<size_t> m_triangle_count;
+			std::atomic<size_t> m_cache_misses_before;
+			std::atomic<size_t> m_cache_misses_after;
+
+		public:
+
+			/** @param cache_size: the number of vertices in the simulated vertex cache
+			* @param optimize_overdraw: sort clusters of triangles so that triangles facing outwards are drawn first
+			* (reduces overdraw, but may slightly increase the ACMR) */
+			MeshOptimizer(unsigned int cache_size = 16, bool optimize_overdraw = false);
+			virtual ~MeshOptimizer() = default;
+
+			/** reorders the triangles (optimizeVertexCache(), optimizeOverdraw()) and the vertices (optimizeVertexFetch()) of the mesh
+			* meshes without indices are not changed */
+			void optimize(MeshData& mesh);
+
+			/** @return the number of vertices that dont have to be transformed again when drawing with the simulated cache */
+			unsigned int getCacheSize() const;
+
+			/** @return whether the overdraw optimization is used by optimize() */
+			bool getOptimizeOverdraw() const;
+
+			/** @return the ACMR of all meshes optimized since the last resetStats() before / after the optimization */
+			float getACMRBefore() const;
+			float getACMRAfter() const;
+
+			void resetStats();
+
+		public:
+			// single optimization passes
+
+			/** @return the number of vertices that have to be transformed when drawing the triangles (simulated fifo cache) */
+			size_t countCacheMisses(const std::vector<int>& indices, size_t vertex_count) const;
+
+			/** @return the average number of vertices that have to be transformed per triangle (0.5 - 3.0, lower is better) */
+			float calcACMR(const std::vector<int>& indices, size_t vertex_count) const;
+
+			/** reorders the triangles, so that triangles using the same vertices are drawn close to each other (Tipsify)
+			* @param loadTo_clusters: if not 0, the first triangle of each cluster of triangles is stored in it
+			* (clusters are started whenever no triangle of a vertex in the cache is left) */
+			void optimizeVertexCache(std::vector<int>& indices, size_t vertex_count, std::vector<size_t>* loadTo_clusters = 0) const;
+
+			/** sorts the clusters of triangles, so that the clusters facing outwards of the mesh get drawn first
+			* (they are most likely to cover other triangles, so those can be rejected by the depth test)
+			* the first attribute of the mesh should be the vec3f position */
+			void optimizeOverdraw(const MeshData& mesh, std::vector<int>& indices, const std::vector<size_t>& clusters) const;
+
+			/** stores the vertices in the order they are first used by the indices (vertices that are not used get removed) */
+			void optimizeVertexFetch(MeshData& mesh) const;
+
+		};
+
+	} // tools
+
+} // undicht
+
+#endif // MESH_OPTIMIZER_H
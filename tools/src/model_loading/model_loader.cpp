@@ -1,13 +1,369 @@
 #include "model_loader.h"
 #include "debug.h"
+#include "thread_pool.h"
+#include "mesh_optimizer.h"
+
+#include <unordered_map>
+#include <cstring>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
 
 namespace undicht {
 
 	namespace tools {
 
 
+		///////////////////////////////////////////// hashing vertices for buildIndices() /////////////////////////////////////////////
+
+		namespace {
+		// (only used by this file)
+
+		/// @return the data of the vertex referenced by the key (see ModelLoader::buildIndices())
+		const float* getVertexData(const std::vector<float>& vertices, const std::vector<float>& indexed_vertices, int key, int vertex_size) {
+
+			if (key < 0)
+				return vertices.data() + (-(key + 1)) * vertex_size;
+
+			return indexed_vertices.data() + key * vertex_size;
+		}
+
+		/// @return the id of the grid cell the value is in
+		int64_t quantizeVertexAttribute(float value, float weld_epsilon) {
+
+			double cell = std::floor(double(value) / weld_epsilon + 0.5);
+
+			// converting values that dont fit into an int64 would be undefined (nan and -inf end up in the lowest cell)
+			if (!(cell > -9.0e18))
+				return INT64_MIN;
+
+			if (cell > 9.0e18)
+				return INT64_MAX;
+
+			return int64_t(cell);
+		}
+
+		class VertexKeyHash {
+			/// FNV-1a hash of the bytes of the vertex referenced by the key (or of its grid cell, when welding)
+		public:
+
+			const std::vector<float>* m_vertices = 0;
+			const std::vector<float>* m_indexed_vertices = 0;
+			int m_vertex_size = 0;
+			float m_weld_epsilon = 0.0f;
+
+			VertexKeyHash(const std::vector<float>& vertices, const std::vector<float>& indexed_vertices, int vertex_size, float weld_epsilon)
+				: m_vertices(&vertices), m_indexed_vertices(&indexed_vertices), m_vertex_size(vertex_size), m_weld_epsilon(weld_epsilon) {
+			}
+
+			size_t operator() (int key) const {
+
+				const float* vertex = getVertexData(*m_vertices, *m_indexed_vertices, key, m_vertex_size);
+
+				uint64_t hash = 14695981039346656037ull;
+
+				for (int f = 0; f < m_vertex_size; f++) {
+
+					uint64_t bits;
+
+					if (m_weld_epsilon > 0.0f) {
+						bits = uint64_t(quantizeVertexAttribute(vertex[f], m_weld_epsilon));
+					} else {
+						// adding 0.0f turns -0.0f into 0.0f, since both compare equal they need to have the same hash
+						float value = vertex[f] + 0.0f;
+						uint32_t value_bits;
+						std::memcpy(&value_bits, &value, sizeof(float));
+						bits = value_bits;
+					}
+
+					for (int byte = 0; byte < 8; byte++) {
+						hash ^= (bits >> (byte * 8)) & 0xFF;
+						hash *= 1099511628211ull;
+					}
+
+				}
+
+				return size_t(hash);
+			}
+
+		};
+
+		class VertexKeyEqual {
+			/// compares the vertices referenced by the keys
+		public:
+
+			const std::vector<float>* m_vertices = 0;
+			const std::vector<float>* m_indexed_vertices = 0;
+			int m_vertex_size = 0;
+			float m_weld_epsilon = 0.0f;
+
+			VertexKeyEqual(const std::vector<float>& vertices, const std::vector<float>& indexed_vertices, int vertex_size, float weld_epsilon)
+				: m_vertices(&vertices), m_indexed_vertices(&indexed_vertices), m_vertex_size(vertex_size), m_weld_epsilon(weld_epsilon) {
+			}
+
+			bool operator() (int key0, int key1) const {
+
+				const float* vertex0 = getVertexData(*m_vertices, *m_indexed_vertices, key0, m_vertex_size);
+				const float* vertex1 = getVertexData(*m_vertices, *m_indexed_vertices, key1, m_vertex_size);
+
+				for (int f = 0; f < m_vertex_size; f++) {
+
+					if (m_weld_epsilon > 0.0f) {
+
+						if (quantizeVertexAttribute(vertex0[f], m_weld_epsilon) != quantizeVertexAttribute(vertex1[f], m_weld_epsilon))
+							return false;
+
+					} else if (vertex0[f] != vertex1[f]) {
+						// vertices are not equal
+						return false;
+					}
+
+				}
+
+				return true;
+			}
+
+		};
+
+		//////////////////////////////////////////// compact vertex formats for quantizeMesh() ////////////////////////////////////////////
+
+		/// @return the half float closest to the value
+		uint16_t floatToHalf(float value) {
+
+			uint32_t bits;
+			std::memcpy(&bits, &value, sizeof(float));
+
+			uint32_t sign = (bits >> 16) & 0x8000;
+			uint32_t mantissa = bits & 0x7FFFFF;
+			int exponent = int((bits >> 23) & 0xFF) - 127 + 15;
+
+			if (((bits >> 23) & 0xFF) == 0xFF) // inf / nan
+				return sign | 0x7C00 | (mantissa ? 0x200 : 0);
+
+			if (exponent >= 31) // too big, becomes inf
+				return sign | 0x7C00;
+
+			if (exponent <= 0) {
+				// too small for a normalized half float
+
+				if (exponent < -10)
+					return sign;
+
+				mantissa |= 0x800000;
+				int shift = 14 - exponent;
+				uint32_t half_mantissa = mantissa >> shift;
+				uint32_t rest = mantissa & ((1u << shift) - 1);
+				uint32_t halfway = 1u << (shift - 1);
+
+				if ((rest > halfway) || ((rest == halfway) && (half_mantissa & 1)))
+					half_mantissa++;
+
+				return sign | half_mantissa;
+			}
+
+			uint32_t half = sign | (uint32_t(exponent) << 10) | (mantissa >> 13);
+			uint32_t rest = mantissa & 0x1FFF;
+
+			// rounding to nearest even (a carry into the exponent is still correct)
+			if ((rest > 0x1000) || ((rest == 0x1000) && (half & 1)))
+				half++;
+
+			return half;
+		}
+
+		/// @return the value in [-1, 1] as snorm16
+		int16_t floatToSnorm16(float value) {
+
+			return int16_t(std::round(std::max(-1.0f, std::min(1.0f, value)) * 32767.0f));
+		}
+
+		/// octahedral encoding of the normal: the normal gets projected onto an octahedron, whose lower half is folded over the upper half
+		void encodeOctahedral(const float* normal, int16_t* loadTo) {
+
+			float length = std::abs(normal[0]) + std::abs(normal[1]) + std::abs(normal[2]);
+			if (length <= 0.0f) {
+				loadTo[0] = loadTo[1] = 0;
+				return;
+			}
+
+			float x = normal[0] / length;
+			float y = normal[1] / length;
+
+			if (normal[2] < 0.0f) {
+				float folded_x = (1.0f - std::abs(y)) * ((x >= 0.0f) ? 1.0f : -1.0f);
+				float folded_y = (1.0f - std::abs(x)) * ((y >= 0.0f) ? 1.0f : -1.0f);
+				x = folded_x;
+				y = folded_y;
+			}
+
+			loadTo[0] = floatToSnorm16(x);
+			loadTo[1] = floatToSnorm16(y);
+		}
+
+		} // namespace
+
+		//////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+		void ModelLoader::setThreadPool(ThreadPool* pool) {
+			/** the thread pool used to load the meshes / textures of a file in parallel */
+
+			m_thread_pool = pool;
+		}
+
+		void ModelLoader::setMeshOptimizer(MeshOptimizer* optimizer) {
+			/** the optimizer used to reorder the triangles + vertices of the loaded meshes (see MeshOptimizer) */
+
+			m_mesh_optimizer = optimizer;
+		}
+
+		void ModelLoader::setVertexQuantization(const VertexQuantization& quantization) {
+			/** the attributes of the loaded meshes that should be stored in compact formats (none by default) */
+
+			m_vertex_quantization = quantization;
+		}
+
 		//////////////////////////////////////////// universal functions that may be useful for loading models ////////////////////////////////////////////
 
+		void ModelLoader::parallelFor(size_t count, const std::function<void(size_t)>& function) {
+			/** calls function(i) for every i in [0, count) (in parallel, if a thread pool is set) */
+
+			if (m_thread_pool) {
+				m_thread_pool->parallelFor(count, function);
+				return;
+			}
+
+			for (size_t i = 0; i < count; i++)
+				function(i);
+		}
+
+		void ModelLoader::optimizeMesh(MeshData& mesh) {
+			/** reorders the triangles + vertices of the indexed mesh (if a mesh optimizer is set) */
+
+			if (m_mesh_optimizer)
+				m_mesh_optimizer->optimize(mesh);
+		}
+
+		void ModelLoader::quantizeMesh(MeshData& mesh) {
+			/** stores the attributes of the mesh in the compact formats selected with setVertexQuantization()
+			* the vertex layout has to be in the default order (position (vec3f), uv (vec2f), normal (vec3f), uv and normal are optional) */
+
+			const VertexQuantization& quantization = m_vertex_quantization;
+			const std::vector<FixedType>& types = mesh.vertex_layout.m_types;
+
+			if (!quantization.positions && !quantization.uvs && !quantization.normals)
+				return;
+
+			if (types.empty() || !(types.at(0) == UND_VEC3F))
+				return; // no positions
+
+			for (const FixedType& type : types)
+				if (!(type == FixedType(Type::FLOAT, 4, type.m_num_components)))
+					return; // unknown layout (or already quantized)
+
+			size_t vertex_size = mesh.vertex_layout.getTotalSize() / sizeof(float);
+			size_t vertex_count = mesh.vertices.size() / vertex_size;
+
+			// the compact type of each attribute
+			BufferLayout compact_layout;
+			bool normal_found = false;
+
+			for (size_t i = 0; i < types.size(); i++) {
+
+				if ((i == 0) && quantization.positions)
+					compact_layout.m_types.push_back(UND_VEC4SN16);
+				else if ((types.at(i) == UND_VEC2F) && quantization.uvs)
+					compact_layout.m_types.push_back(UND_VEC2H);
+				else if ((i > 0) && (types.at(i) == UND_VEC3F) && !normal_found && quantization.normals)
+					compact_layout.m_types.push_back(UND_VEC2SN16);
+				else
+					compact_layout.m_types.push_back(types.at(i));
+
+				normal_found |= (i > 0) && (types.at(i) == UND_VEC3F);
+			}
+
+			// the positions are stored relative to the bounding box of the mesh
+			if (quantization.positions && vertex_count) {
+
+				for (int c = 0; c < 3; c++) {
+
+					float min = mesh.vertices.at(c);
+					float max = min;
+
+					for (size_t vertex = 0; vertex < vertex_count; vertex++) {
+						min = std::min(min, mesh.vertices.at(vertex * vertex_size + c));
+						max = std::max(max, mesh.vertices.at(vertex * vertex_size + c));
+					}
+
+					mesh.position_offset[c] = 0.5f * (min + max);
+					mesh.position_scale[c] = (max > min) ? 0.5f * (max - min) : 1.0f;
+				}
+
+			}
+
+			// packing the vertices
+			size_t compact_vertex_size = compact_layout.getTotalSize(); // in bytes (always a multiple of 4)
+			std::vector<float> compact_vertices(vertex_count * compact_vertex_size / sizeof(float));
+			char* compact_data = (char*)compact_vertices.data();
+
+			for (size_t vertex = 0; vertex < vertex_count; vertex++) {
+
+				const float* src = mesh.vertices.data() + vertex * vertex_size;
+				char* dst = compact_data + vertex * compact_vertex_size;
+
+				for (size_t i = 0; i < types.size(); i++) {
+
+					const FixedType& type = compact_layout.m_types.at(i);
+
+					if (type == UND_VEC4SN16) {
+
+						int16_t position[4];
+						for (int c = 0; c < 3; c++)
+							position[c] = floatToSnorm16((src[c] - mesh.position_offset[c]) / mesh.position_scale[c]);
+
+						position[3] = 32767; // w = 1
+						std::memcpy(dst, position, sizeof(position));
+					} else if (type == UND_VEC2H) {
+
+						uint16_t uv[2] = { floatToHalf(src[0]), floatToHalf(src[1]) };
+						std::memcpy(dst, uv, sizeof(uv));
+					} else if (type == UND_VEC2SN16) {
+
+						int16_t normal[2];
+						encodeOctahedral(src, normal);
+						std::memcpy(dst, normal, sizeof(normal));
+					} else {
+
+						std::memcpy(dst, src, type.getSize());
+					}
+
+					src += types.at(i).m_num_components;
+					dst += type.getSize();
+				}
+
+			}
+
+			mesh.vertices.swap(compact_vertices);
+			mesh.vertex_layout = compact_layout;
+		}
+
+		uint32_t ModelLoader::getMeshLoadOptions() const {
+			/** @return a number that is different for each combination of options that changes the loaded meshes */
+
+			uint32_t options = 0;
+
+			if (m_mesh_optimizer) {
+				options |= 1;
+				options |= uint32_t(m_mesh_optimizer->getOptimizeOverdraw()) << 1;
+				options |= (m_mesh_optimizer->getCacheSize() & 0xFF) << 8;
+			}
+
+			options |= uint32_t(m_vertex_quantization.positions) << 2;
+			options |= uint32_t(m_vertex_quantization.uvs) << 3;
+			options |= uint32_t(m_vertex_quantization.normals) << 4;
+
+			return options;
+		}
+
 		void ModelLoader::rearrangeAttribIndices(const std::vector<int>& attrib_indices, std::vector<int> new_order, std::vector<int>& loadTo) {
 			/** some file formats may store the attributes in a different order (i.e. pos, uv, normal or pos, normal, uv)
 			* and with them the attribute indices. since undicht uses always the same order (pos, uv, normal), the indices may have to be rearranged
@@ -67,49 +423,46 @@ namespace undicht {
 
 		}
 
-		void ModelLoader::buildIndices(const std::vector<float>& vertices, const BufferLayout& vertex_layout, std::vector<float>& loadTo_vertices, std::vector<int>& loadTo_indices) {
-			/** removes double vertices by adding indices referencing the first version of that vertex to the loadTo_indices vector*/
+		void ModelLoader::buildIndices(const std::vector<float>& vertices, const BufferLayout& vertex_layout, std::vector<float>& loadTo_vertices, std::vector<int>& loadTo_indices, float weld_epsilon) {
+			/** removes double vertices by adding indices referencing the first version of that vertex to the loadTo_indices vector
+			* the unique vertices are stored in a hash map, so this takes linear time instead of comparing every vertex with every other one
+			* @param weld_epsilon: if bigger than 0, the vertex attributes get snapped to a grid with that spacing before they are compared,
+			* so that nearly equal vertices get welded together as well (the first vertex of a grid cell is the one that gets stored) */
 
 			int vertex_size = vertex_layout.getTotalSize() / sizeof(float);
-			int vertex_count = vertices.size() / vertex_size;
+			if (!vertex_size)
+				return;
 
-			for (int vertex = 0; vertex < vertex_count; vertex++) {
-
-				int indexed_vertex; // the index of the vertex in loadTo_vertices equal to the current vertex
-				bool vertices_are_equal = false; // (only if this is true)
-
-				// comparing the vertex to the ones that where already confirmed unique
-				for (indexed_vertex = 0; indexed_vertex < loadTo_vertices.size() / vertex_size; indexed_vertex++) {
+			int vertex_count = vertices.size() / vertex_size;
 
-					vertices_are_equal = true;
+			// the keys of the map are the indices of the unique vertices in loadTo_vertices
+			// negative keys are used to look up vertex -(key + 1) of the vertices that are not yet indexed
+			VertexKeyHash hash(vertices, loadTo_vertices, vertex_size, weld_epsilon);
+			VertexKeyEqual equal(vertices, loadTo_vertices, vertex_size, weld_epsilon);
+			std::unordered_map<int, int, VertexKeyHash, VertexKeyEqual> unique_vertices(vertex_count, hash, equal);
 
-					// testing if one float is different
-					for (int f = 0; f < vertex_size; f++) {
+			// vertices that were already stored in loadTo_vertices can be referenced as well
+			int indexed_count = loadTo_vertices.size() / vertex_size;
+			for (int indexed_vertex = 0; indexed_vertex < indexed_count; indexed_vertex++)
+				unique_vertices.emplace(indexed_vertex, indexed_vertex); // keeps the first version of a vertex
 
-						if (vertices.at(vertex * vertex_size + f) != loadTo_vertices.at(indexed_vertex * vertex_size + f)) {
-							// vertices are not equal
-							vertices_are_equal = false;
-							break;
-						}
+			loadTo_indices.reserve(loadTo_indices.size() + vertex_count);
 
-					}
-
-					if (vertices_are_equal) {
-						// found one, adding the index to the indices list
-						//std::cout << "found an redundant vertex " << "\n";
-						loadTo_indices.push_back(indexed_vertex);
-						break;
-					}
+			for (int vertex = 0; vertex < vertex_count; vertex++) {
 
-				}
+				std::unordered_map<int, int, VertexKeyHash, VertexKeyEqual>::const_iterator indexed_vertex = unique_vertices.find(-(vertex + 1));
 
-				if (!vertices_are_equal) {
-					// no equal vertices were found, so adding the vertex to loadTo_vertices
-					// std::cout << "vertex is unique" << "\n";
-					loadTo_indices.push_back(loadTo_vertices.size() / vertex_size);
-					loadTo_vertices.insert(loadTo_vertices.end(), vertices.begin() + vertex * vertex_size, vertices.begin() + (vertex + 1) * vertex_size);
+				if (indexed_vertex != unique_vertices.end()) {
+					// found one, adding the index to the indices list
+					loadTo_indices.push_back(indexed_vertex->second);
+					continue;
 				}
 
+				// no equal vertices were found, so adding the vertex to loadTo_vertices
+				int new_index = loadTo_vertices.size() / vertex_size;
+				loadTo_vertices.insert(loadTo_vertices.end(), vertices.begin() + vertex * vertex_size, vertices.begin() + (vertex + 1) * vertex_size);
+				unique_vertices.emplace(new_index, new_index);
+				loadTo_indices.push_back(new_index);
 			}
 
 		}
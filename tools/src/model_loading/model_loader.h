@@ -3,16 +3,22 @@
 
 #include <vector>
 #include <string>
+#include <functional>
+#include <cstdint>
 #include <buffer_layout.h>
 #include "images/image_file.h"
 
 namespace undicht {
 
+	class ThreadPool;
+
 	namespace tools {
 
+		class MeshOptimizer;
 
 		struct MeshData {
 
+			// the vertex data (if the layout contains compact types, the packed vertices are stored in the floats)
 			std::vector<float> vertices;
 			std::vector<int> indices;
 
@@ -21,16 +27,49 @@ namespace undicht {
 			// ids of the textures used by this mesh
 			int color_texture = -1;
 
+			// positions stored as normalized integers have to be transformed back in the shader:
+			// position = quantized_position * position_scale + position_offset
+			float position_offset[3] = { 0.0f, 0.0f, 0.0f };
+			float position_scale[3] = { 1.0f, 1.0f, 1.0f };
+
+		};
+
+		struct VertexQuantization {
+			/** which attributes of the loaded meshes should be stored in compact formats (see ModelLoader::setVertexQuantization()) */
+
+			bool positions = false; // UND_VEC4SN16 (w = 1), relative to the bounding box of the mesh (see MeshData::position_scale)
+			bool uvs = false; // UND_VEC2H (half floats, since uvs may be outside of [0, 1])
+			bool normals = false; // UND_VEC2SN16, octahedral encoded
 		};
 
 		class ModelLoader {
 			/** the base class to all classes that load Meshes, Textures ... from files */
 
+		protected:
+
+			ThreadPool* m_thread_pool = 0;
+			MeshOptimizer* m_mesh_optimizer = 0;
+			VertexQuantization m_vertex_quantization;
+
 		public:
 
 			ModelLoader() = default;
 			virtual ~ModelLoader() = default;
 
+			/** the thread pool used to load the meshes / textures of a file in parallel
+			* (if no pool is set, everything is loaded on the calling thread) */
+			void setThreadPool(ThreadPool* pool);
+
+			/** the optimizer used to reorder the triangles + vertices of the loaded meshes (see MeshOptimizer)
+			* (if no optimizer is set, the meshes are stored in the order they are stored in the file)
+			* has to be set before the file is opened (it may load the meshes from a cache) */
+			void setMeshOptimizer(MeshOptimizer* optimizer);
+
+			/** the attributes of the loaded meshes that should be stored in compact formats (none by default)
+			* a vertex with all attributes quantized takes 16 instead of 32 bytes
+			* has to be set before the file is opened (it may load the meshes from a cache) */
+			void setVertexQuantization(const VertexQuantization& quantization);
+
 		public:
 			/** the functions that should be implemented by derived model loading classes */
 
@@ -59,6 +98,22 @@ namespace undicht {
 		protected:
 			// universal functions that may be useful for loading models
 
+			/** calls function(i) for every i in [0, count) (in parallel, if a thread pool is set)
+			* returns once all calls have finished */
+			void parallelFor(size_t count, const std::function<void(size_t)>& function);
+
+			/** reorders the triangles + vertices of the indexed mesh (if a mesh optimizer is set)
+			* should be called once the indices of the mesh were built */
+			void optimizeMesh(MeshData& mesh);
+
+			/** stores the attributes of the mesh in the compact formats selected with setVertexQuantization()
+			* the vertex layout has to be in the default order (position (vec3f), uv (vec2f), normal (vec3f), uv and normal are optional) */
+			void quantizeMesh(MeshData& mesh);
+
+			/** @return a number that is different for each combination of options that changes the loaded meshes
+			* (used to check whether cached meshes were loaded with the same options) */
+			uint32_t getMeshLoadOptions() const;
+
 			/** some file formats may store the attributes in a different order (i.e. pos, uv, normal or pos, normal, uv)
 			* and with them the attribute indices. since undicht uses always the same order (pos, uv, normal), the indices may have to be rearranged
 			* @param attribute_indices: the indices as they come from the file, @param new_order: the way they have to be rearranged to form the default order */
@@ -70,8 +125,11 @@ namespace undicht {
 				const BufferLayout& vertex_layout, const std::vector<int>& attribute_indices);
 
 
-			/** removes double vertices by adding indices referencing the first version of that vertex to the loadTo_indices vector*/
-			virtual void buildIndices(const std::vector<float>& vertices, const BufferLayout& vertex_layout, std::vector<float>& loadTo_vertices, std::vector<int>& loadTo_indices);
+			/** removes double vertices by adding indices referencing the first version of that vertex to the loadTo_indices vector
+			* the unique vertices are stored in a hash map, so this takes linear time instead of comparing every vertex with every other one
+			* @param weld_epsilon: if bigger than 0, the vertex attributes get snapped to a grid with that spacing before they are compared,
+			* so that nearly equal vertices get welded together as well (the first vertex of a grid cell is the one that gets stored) */
+			virtual void buildIndices(const std::vector<float>& vertices, const BufferLayout& vertex_layout, std::vector<float>& loadTo_vertices, std::vector<int>& loadTo_indices, float weld_epsilon = 0.0f);
 
 		};
 
@@ -0,0 +1,131 @@
+#include "xml_arena.h"
+#include "xml_element.h"
+
+#include <algorithm>
+
+
+namespace undicht {
+
+	namespace tools {
+
+		namespace {
+		// (only used by this file)
+
+		// the size of the chunks grows with the number of elements
+		// (so that small trees dont waste much memory and large trees dont need many chunks)
+		const size_t XML_MIN_CHUNK_SIZE = 64;
+		const size_t XML_MAX_CHUNK_SIZE = 16384;
+
+		size_t getChunkSize(size_t chunk_id) {
+
+			return std::min(XML_MIN_CHUNK_SIZE << std::min<size_t>(chunk_id, 16), XML_MAX_CHUNK_SIZE);
+		}
+
+		} // namespace
+
+		XmlArena::XmlArena() {
+			//ctor
+		}
+
+		XmlArena::~XmlArena() {
+			//dtor
+
+			clear();
+		}
+
+		XmlElement* XmlArena::newElement(XmlElement* parent) {
+			/** @return a new element (stored in the arena) */
+
+			if (m_used_chunk_size == m_last_chunk_size) {
+				// the last chunk is full
+				m_last_chunk_size = getChunkSize(m_element_chunks.size());
+				m_element_chunks.push_back(new XmlElement[m_last_chunk_size]);
+				m_used_chunk_size = 0;
+			}
+
+			XmlElement* element = m_element_chunks.back() + m_used_chunk_size;
+			element->m_parent_element = parent;
+			element->m_arena = this;
+
+			m_used_chunk_size++;
+			m_element_count++;
+
+			return element;
+		}
+
+		int XmlArena::newAttributes(int count) {
+			/** adds count attributes to the end of the attribute array
+			* @return the index of the first new attribute */
+
+			int first_attribute = m_attributes.size();
+			m_attributes.resize(m_attributes.size() + count);
+
+			return first_attribute;
+		}
+
+		XmlTagAttrib* XmlArena::getAttribute(int index) {
+
+			return &m_attributes[index];
+		}
+
+		const XmlTagAttrib* XmlArena::getAttribute(int index) const {
+
+			return &m_attributes[index];
+		}
+
+		int XmlArena::getAttributeCount() const {
+
+			return m_attributes.size();
+		}
+
+		int XmlArena::internName(const XmlString& name) {
+			/** @return the id of the tag name (the name gets added to the arena if it is not stored yet) */
+
+			std::unordered_map<XmlString, int, XmlStringHash>::iterator id = m_name_ids.find(name);
+
+			if (id != m_name_ids.end())
+				return id->second;
+
+			m_names.push_back(name);
+			m_name_ids.emplace(name, m_names.size() - 1);
+
+			return m_names.size() - 1;
+		}
+
+		int XmlArena::findName(const XmlString& name) const {
+			/** @return the id of the tag name, -1 if no element with the name was stored */
+
+			std::unordered_map<XmlString, int, XmlStringHash>::const_iterator id = m_name_ids.find(name);
+
+			return (id != m_name_ids.end()) ? id->second : -1;
+		}
+
+		const XmlString& XmlArena::getName(int id) const {
+
+			return m_names.at(id);
+		}
+
+		size_t XmlArena::getElementCount() const {
+
+			return m_element_count;
+		}
+
+		void XmlArena::clear() {
+			/** destroys all elements and attributes stored in the arena */
+
+			for (XmlElement* chunk : m_element_chunks)
+				delete[] chunk;
+
+			m_element_chunks.clear();
+			m_last_chunk_size = 0;
+			m_used_chunk_size = 0;
+			m_element_count = 0;
+
+			m_attributes.clear();
+			m_names.clear();
+			m_name_ids.clear();
+		}
+
+	} // tools
+
+} // undicht
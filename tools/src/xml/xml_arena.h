@@ -0,0 +1,72 @@
+#ifndef XML_ARENA_H
+#define XML_ARENA_H
+
+#include <vector>
+#include <unordered_map>
+
+#include "xml_string.h"
+#include "xml_tag_attribute.h"
+#include "unique_object.h"
+
+
+namespace undicht {
+
+	namespace tools {
+
+		class XmlElement;
+
+		class XmlArena : public core::UniqueObject {
+			/** storage for the elements, attributes and tag names of a xml element tree
+			* the elements are allocated in chunks, so their addresses stay the same while the tree grows
+			* the attributes of all elements are stored in one array (each element references a range of it)
+			* everything gets freed at once when the arena gets cleared / destroyed */
+		protected:
+
+			std::vector<XmlElement*> m_element_chunks;
+			size_t m_last_chunk_size = 0; // how many elements fit into the last chunk
+			size_t m_used_chunk_size = 0; // how many elements of the last chunk are in use
+			size_t m_element_count = 0;
+
+			std::vector<XmlTagAttrib> m_attributes;
+
+			// each tag name gets stored once, elements with the same name share the id
+			std::vector<XmlString> m_names;
+			std::unordered_map<XmlString, int, XmlStringHash> m_name_ids;
+
+		public:
+
+			/** @return a new element (stored in the arena) */
+			XmlElement* newElement(XmlElement* parent);
+
+			/** adds count attributes to the end of the attribute array
+			* @return the index of the first new attribute
+			* (pointers to the attributes may become invalid once new attributes are added) */
+			int newAttributes(int count);
+			XmlTagAttrib* getAttribute(int index);
+			const XmlTagAttrib* getAttribute(int index) const;
+			int getAttributeCount() const;
+
+			/** @return the id of the tag name (the name gets added to the arena if it is not stored yet) */
+			int internName(const XmlString& name);
+
+			/** @return the id of the tag name, -1 if no element with the name was stored */
+			int findName(const XmlString& name) const;
+			const XmlString& getName(int id) const;
+
+			size_t getElementCount() const;
+
+			/** destroys all elements and attributes stored in the arena */
+			void clear();
+
+		public:
+
+			XmlArena();
+			virtual ~XmlArena();
+
+		};
+
+	} // tools
+
+} // undicht
+
+#endif // XML_ARENA_H
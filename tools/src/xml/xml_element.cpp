@@ -14,11 +14,17 @@ namespace undicht {
 		XmlElement::XmlElement(XmlElement* parent) {
 
 			m_parent_element = parent;
+
+			if (parent)
+				m_arena = parent->getArena();
 		}
 
 
 		XmlElement::~XmlElement() {
 			//dtor
+
+			if (m_owns_arena)
+				delete m_arena;
 		}
 
 
@@ -31,9 +37,9 @@ namespace undicht {
 
 			for (const std::string& param_attr : tag_attributes) {
 
-				for (const XmlTagAttrib& elem_attr : m_tag_attributes) {
+				for (int i = 0; i < m_attribute_count; i++) {
 
-					if (elem_attr == param_attr) {
+					if (getAttributes()[i] == param_attr) {
 
 						attributes_found += 1;
 
@@ -53,9 +59,9 @@ namespace undicht {
 
 			for (const std::string& name : elem_names) {
 
-				for (const XmlElement& child_elem : m_child_elements) {
+				for (XmlElement* child_elem = getFirstChild(); child_elem; child_elem = child_elem->getNextSibling()) {
 
-					if (!name.compare(child_elem.getName())) {
+					if (child_elem->getName() == name) {
 
 						elements_found += 1;
 
@@ -69,12 +75,12 @@ namespace undicht {
 			return (elements_found == elem_names.size());
 		}
 
-		const std::string& XmlElement::getName() const {
+		const XmlString& XmlElement::getName() const {
 
 			return m_tag_name;
 		}
 
-		const std::string& XmlElement::getContent() const {
+		const XmlString& XmlElement::getContent() const {
 			/// @return the content stored between the start and end tag of the element (excluding child elements)
 
 			return m_content; // this one is easy
@@ -82,11 +88,11 @@ namespace undicht {
 
 		const XmlTagAttrib* XmlElement::getAttribute(const std::string& attr_name) {
 
-			for (XmlTagAttrib& attr : m_tag_attributes) {
+			for (int i = 0; i < m_attribute_count; i++) {
 
-				if (!attr.m_name.compare(attr_name)) {
+				if (getAttributes()[i].m_name == attr_name) {
 
-					return &attr;
+					return getAttributes() + i;
 				}
 
 			}
@@ -94,69 +100,75 @@ namespace undicht {
 			return 0;
 		}
 
+		const XmlTagAttrib* XmlElement::getAttributes() const {
+			/** @return the attributes of the element (getAttributeCount() attributes stored next to each other) */
+
+			return m_attribute_count ? m_arena->getAttribute(m_first_attribute) : 0;
+		}
+
+		int XmlElement::getAttributeCount() const {
+
+			return m_attribute_count;
+		}
+
+
 		XmlElement* XmlElement::getElement(const std::vector<std::string>& attribute_strings, int attrib_num) {
 			/** searches the elements children for the first one which has the attributes stored in the attribute string at attrib_num
 			* if multiple attribute strings are provided, its children in return will be checked
 			* @param attrib_num: needed so that the function can be used recursivly (what attribute string to use)
 			* @return 0 if the element could not be found */
 
-			// splitting the attributes
-			std::string elem_name;
-			std::vector<std::string> attributes = splitAttributeString(attribute_strings.at(attrib_num), elem_name);
-
-			// searching for a child element
-			for (XmlElement& elem : m_child_elements) {
+			return getElement(XmlQuery(attribute_strings), attrib_num);
+		}
 
-				if (elem.hasAttributes(attributes) && (!elem.getName().compare(elem_name))) {
-					// found the element matching the current attributes
+		std::vector<XmlElement*> XmlElement::getAllElements(const std::vector<std::string>& attribute_strings, int attrib_num) {
+			/** @return all xml elements that have all the requested tag attributes */
 
-					if (attrib_num + 1 >= attribute_strings.size()) {
-						// last element of the search queue
-						return &elem;
-					}
-					else {
-						// the search continues
-						return elem.getElement(attribute_strings, attrib_num + 1);
-					}
+			return getAllElements(XmlQuery(attribute_strings), attrib_num);
+		}
 
-				}
+		XmlElement* XmlElement::getElement(const XmlQuery& query, int step) {
+			/** same as the function above, but the attribute strings dont have to be parsed again */
 
-			}
+			std::vector<int> name_ids;
+			if (!findNameIds(query, step, name_ids))
+				return 0;
 
-			return 0;
+			return findElement(query, name_ids.data(), step);
 		}
 
-		std::vector<XmlElement*> XmlElement::getAllElements(const std::vector<std::string>& attribute_strings, int attrib_num) {
-			/** @return all xml elements that have all the requested tag attributes */
-
-			// splitting the attributes
-			std::string elem_name;
-			std::vector<std::string> attributes = splitAttributeString(attribute_strings.at(attrib_num), elem_name);
+		std::vector<XmlElement*> XmlElement::getAllElements(const XmlQuery& query, int step) {
 
 			std::vector<XmlElement*> elements;
 
-			// searching for child elements
-			for (XmlElement& elem : m_child_elements) {
+			std::vector<int> name_ids;
+			if (findNameIds(query, step, name_ids))
+				findAllElements(query, name_ids.data(), step, elements);
 
-				if (elem.hasAttributes(attributes) && (!elem.getName().compare(elem_name))) {
-					// found an element matching the current attributes
+			return elements;
+		}
 
-					if (attrib_num + 1 >= attribute_strings.size()) {
-						// at end of search queue
-						elements.push_back(&elem);
-					}
-					else {
-						// the search continues
+		bool XmlElement::matches(const XmlQueryStep& step, int name_id) const {
+			/** @return whether the element has the name and attributes requested by the query step */
 
-						std::vector<XmlElement*> new_elements = elem.getAllElements(attribute_strings, attrib_num + 1);
-						elements.insert(elements.end(), new_elements.begin(), new_elements.end());
-					}
+			if ((m_tag_name_id != name_id) || !step.valid)
+				return false;
+
+			for (const XmlQueryAttrib& query_attr : step.attributes) {
+
+				bool attribute_found = false;
 
+				for (int i = 0; (i < m_attribute_count) && !attribute_found; i++) {
+
+					const XmlTagAttrib& elem_attr = getAttributes()[i];
+					attribute_found = (elem_attr.m_name == query_attr.name) && ((elem_attr.m_value != query_attr.value) == query_attr.negate);
 				}
-			}
 
+				if (!attribute_found)
+					return false;
+			}
 
-			return elements;
+			return true;
 		}
 
 		std::vector<std::string> XmlElement::splitAttributeString(std::string attribute_string, std::string& loadTo_name) const {
@@ -204,9 +216,9 @@ namespace undicht {
 			}
 
 			std::cout << "<" << m_tag_name;
-			for (const XmlTagAttrib& attr : m_tag_attributes) {
+			for (int i = 0; i < m_attribute_count; i++) {
 
-				std::cout << " " << attr.m_name << "=" << attr.m_value;
+				std::cout << " " << getAttributes()[i].m_name << "=" << getAttributes()[i].m_value;
 
 			}
 			std::cout << ">";
@@ -228,20 +240,59 @@ namespace undicht {
 
 			printShortInfo(indent);
 
-			for (const XmlElement& child : m_child_elements) {
+			for (XmlElement* child = getFirstChild(); child; child = child->getNextSibling()) {
 
-				child.printRecursive(indent + 2);
+				child->printRecursive(indent + 2);
 			}
 
 		}
 
 		/////////////////////////////////////////////// functions to set the elements data ///////////////////////////////////////////////
 
+		void XmlElement::setName(const XmlString& name) {
+
+			m_tag_name = name;
+			m_tag_name_id = getArena()->internName(name);
+		}
+
+		XmlTagAttrib* XmlElement::addAttribute() {
+			/** @return the new attribute (only valid until the next attribute is added to the tree) */
+
+			XmlArena* arena = getArena();
+
+			if (m_attribute_count && (m_first_attribute + m_attribute_count != arena->getAttributeCount())) {
+				// the attributes of an element have to be stored next to each other
+				// (this only happens if attributes are added to an element after other elements got attributes)
+				int first_attribute = arena->newAttributes(m_attribute_count);
+
+				for (int i = 0; i < m_attribute_count; i++)
+					*arena->getAttribute(first_attribute + i) = *arena->getAttribute(m_first_attribute + i);
+
+				m_first_attribute = first_attribute;
+			}
+
+			int new_attribute = arena->newAttributes(1);
+
+			if (!m_attribute_count)
+				m_first_attribute = new_attribute;
+
+			m_attribute_count++;
+
+			return arena->getAttribute(new_attribute);
+		}
+
 		XmlElement* XmlElement::addChildElement() {
 
-			m_child_elements.emplace_back(XmlElement(this));
+			XmlElement* child = getArena()->newElement(this);
+
+			if (m_last_child)
+				m_last_child->m_next_sibling = child;
+			else
+				m_first_child = child;
 
-			return &m_child_elements.back();
+			m_last_child = child;
+
+			return child;
 		}
 
 		XmlElement* XmlElement::getParentElement() {
@@ -249,41 +300,105 @@ namespace undicht {
 			return m_parent_element;
 		}
 
+		void XmlElement::clear() {
+			/** removes the name, content, attributes and all child elements
+			* (the memory used by the removed elements gets freed when the root element is cleared / destroyed) */
+
+			m_tag_name.clear();
+			m_tag_name_id = -1;
+			m_content.clear();
+			m_first_attribute = 0;
+			m_attribute_count = 0;
+			m_first_child = 0;
+			m_last_child = 0;
+
+			if (m_owns_arena)
+				m_arena->clear();
+		}
+
+		bool XmlElement::findNameIds(const XmlQuery& query, int first_step, std::vector<int>& loadTo_ids) const {
+			/** finds the ids of the names of the query steps (starting at first_step)
+			* @return false if one of the names does not belong to any element (so no element can be found) */
 
-		void XmlElement::setData(const std::string& line) {
-			/** extracts data from the line which can be read from a xml file
-			* @param a line containing the start tag and possibly the content of a xml element
-			* start_tag: the start tag as it can be found in an xml file
-			* @example <texture width="256" height="256"> */
+			if (!m_arena || (first_step >= query.getStepCount()))
+				return false;
 
-			// tag name
-			size_t tag_start = line.find('<');
-			size_t tag_end = line.find('>');
-			size_t name_length = std::min(tag_end - tag_start, line.find(' ') - tag_start) - 1;
+			loadTo_ids.resize(query.getStepCount() - first_step);
 
-			m_tag_name = line.substr(tag_start + 1, name_length);
+			for (int i = first_step; i < query.getStepCount(); i++) {
 
-			// tag attributes
-			size_t attr_start = tag_start + name_length + 1; // before the ' ', the +1 is for the '<'
-			size_t attr_end = 0;
-			size_t attr_length = 0;
-			while (attr_start < tag_end) {
+				// the name has to be converted to a XmlString (without copying it) to look it up
+				const std::string& name = query.getStep(i).name;
+				loadTo_ids.at(i - first_step) = m_arena->findName(XmlString(name));
 
-				attr_start = line.find(' ', attr_start) + 1;
-				attr_end = std::min(std::min(line.find(' ', attr_start), line.find('>', attr_start)), line.find('/', attr_start));
-				attr_length = attr_end - attr_start;
+				if (loadTo_ids.at(i - first_step) == -1)
+					return false;
+			}
+
+			return true;
+		}
+
+		XmlElement* XmlElement::findElement(const XmlQuery& query, const int* name_ids, int step) {
+			/** the recursive part of getElement() */
+
+			const XmlQueryStep& query_step = query.getStep(step);
+
+			// searching for a child element
+			for (XmlElement* elem = getFirstChild(); elem; elem = elem->getNextSibling()) {
+
+				if (elem->matches(query_step, name_ids[0])) {
+					// found the element matching the current attributes
+
+					if (step + 1 >= query.getStepCount()) {
+						// last element of the search queue
+						return elem;
+					}
+					else {
+						// the search continues
+						return elem->findElement(query, name_ids + 1, step + 1);
+					}
 
-				if (attr_start - 1 == std::string::npos) {
-					break;
 				}
 
-				m_tag_attributes.emplace_back(XmlTagAttrib(line.substr(attr_start, attr_length)));
+			}
+
+			return 0;
+		}
+
+		void XmlElement::findAllElements(const XmlQuery& query, const int* name_ids, int step, std::vector<XmlElement*>& loadTo_elements) {
+			/** the recursive part of getAllElements() */
+
+			const XmlQueryStep& query_step = query.getStep(step);
+
+			// searching for child elements
+			for (XmlElement* elem = getFirstChild(); elem; elem = elem->getNextSibling()) {
+
+				if (elem->matches(query_step, name_ids[0])) {
+					// found an element matching the current attributes
+
+					if (step + 1 >= query.getStepCount()) {
+						// at end of search queue
+						loadTo_elements.push_back(elem);
+					}
+					else {
+						// the search continues
+						elem->findAllElements(query, name_ids + 1, step + 1, loadTo_elements);
+					}
 
+				}
 			}
 
-			// content
-			m_content = line.substr(tag_end + 1, line.find('<', tag_end + 1) - tag_end - 1);
+		}
+
+		XmlArena* XmlElement::getArena() {
+			/** @return the arena in which the elements of the tree are stored (created if it doesnt exist yet) */
+
+			if (!m_arena) {
+				m_arena = new XmlArena;
+				m_owns_arena = true;
+			}
 
+			return m_arena;
 		}
 
 	} // tools
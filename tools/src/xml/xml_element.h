@@ -4,6 +4,9 @@
 #include <string>
 #include <vector>
 #include "xml_tag_attribute.h"
+#include "xml_string.h"
+#include "xml_arena.h"
+#include "xml_query.h"
 
 
 
@@ -12,19 +15,31 @@ namespace undicht {
 	namespace tools {
 
 		class XmlElement {
-
+			/** the elements of a tree are stored in the arena of the root element
+			* so their addresses stay the same while the tree grows (and they cant be copied) */
 		public:
 			// the data a xml element can store
-			std::string m_tag_name;
-			std::vector<XmlTagAttrib> m_tag_attributes;
-			std::string m_content;
+			// (views into the data of the xml file the element was loaded from)
+			XmlString m_tag_name;
+			XmlString m_content;
+
+			// the id of the tag name in the arena (elements with the same name have the same id)
+			int m_tag_name_id = -1;
 
-			// each element can contain multiple child elements
-			std::vector<XmlElement> m_child_elements;
+			// the attributes are stored in the arena (m_attribute_count attributes, starting at m_first_attribute)
+			int m_first_attribute = 0;
+			int m_attribute_count = 0;
 
-			// the parent element
+			// the tree structure
 			XmlElement* m_parent_element = 0;
+			XmlElement* m_first_child = 0;
+			XmlElement* m_last_child = 0;
+			XmlElement* m_next_sibling = 0;
 
+			// the arena in which the child elements + attributes are stored
+			// (created by the root element when the first child / attribute gets added)
+			XmlArena* m_arena = 0;
+			bool m_owns_arena = false;
 
 		public:
 			// functions to access the data stored in the element
@@ -36,13 +51,23 @@ namespace undicht {
 			/** @return whether the element has child elements with all the names */
 			bool hasChildElements(const std::vector<std::string>& elem_names) const;
 
-			const std::string& getName() const;
+			const XmlString& getName() const;
 
 			/// @return the content stored between the start and end tag of the element (excluding child elements)
-			const std::string& getContent() const;
+			const XmlString& getContent() const;
 
 			const XmlTagAttrib* getAttribute(const std::string& attrib_name);
 
+			/** @return the attributes of the element (getAttributeCount() attributes stored next to each other) */
+			const XmlTagAttrib* getAttributes() const;
+			int getAttributeCount() const;
+
+			/** the child elements can be visited like this:
+			* for(XmlElement* child = elem.getFirstChild(); child; child = child->getNextSibling())
+			* (defined here so that they can be inlined when traversing large trees) */
+			XmlElement* getFirstChild() const { return m_first_child; }
+			XmlElement* getNextSibling() const { return m_next_sibling; }
+
 
 			/** searches the elements children for the first one which has the attributes stored in the attribute string at attrib_num
 			* if multiple attribute strings are provided, its children in return will be checked
@@ -53,6 +78,16 @@ namespace undicht {
 			/** @return all xml elements that have all the requested tag attributes */
 			std::vector<XmlElement*> getAllElements(const std::vector<std::string>& attribute_strings, int attrib_num = 0);
 
+			/** same as the functions above, but the attribute strings dont have to be parsed again
+			* (for searches that are done multiple times)
+			* @param step: the step of the query at which the search starts */
+			XmlElement* getElement(const XmlQuery& query, int step = 0);
+			std::vector<XmlElement*> getAllElements(const XmlQuery& query, int step = 0);
+
+			/** @return whether the element has the name and attributes requested by the query step
+			* @param name_id: the id of the steps name in the arena of the element */
+			bool matches(const XmlQueryStep& step, int name_id) const;
+
 			/// the attribute string should look like this "name attr0=val0 attr1=val1 ..."
 			std::vector<std::string> splitAttributeString(std::string attribute_string, std::string& loadTo_name) const;
 
@@ -66,15 +101,30 @@ namespace undicht {
 		public:
 			// functions to set the elements data
 
+			void setName(const XmlString& name);
+
+			/** @return the new attribute (only valid until the next attribute is added to the tree) */
+			XmlTagAttrib* addAttribute();
+
 			XmlElement* addChildElement();
 			XmlElement* getParentElement();
 
-			/** extracts data from the line which can be read from a xml file
-			* @param a line containing the start tag and possibly the content of a xml element
-			* start_tag: the start tag as it can be found in an xml file
-			* @example <texture width="256" height="256"> */
-			void setData(const std::string& line);
+			/** removes the name, content, attributes and all child elements */
+			void clear();
+
+		protected:
 
+			/** finds the ids of the names of the query steps (starting at first_step)
+			* @return false if one of the names does not belong to any element (so no element can be found) */
+			bool findNameIds(const XmlQuery& query, int first_step, std::vector<int>& loadTo_ids) const;
+
+			/** the recursive part of getElement() and getAllElements()
+			* @param name_ids: the name ids of the query steps, starting with the one for step */
+			XmlElement* findElement(const XmlQuery& query, const int* name_ids, int step);
+			void findAllElements(const XmlQuery& query, const int* name_ids, int step, std::vector<XmlElement*>& loadTo_elements);
+
+			/** @return the arena in which the elements of the tree are stored (created if it doesnt exist yet) */
+			XmlArena* getArena();
 
 		public:
 
@@ -82,6 +132,10 @@ namespace undicht {
 			XmlElement(XmlElement* parent);
 			virtual ~XmlElement();
 
+			// elements cant be copied (the tree is referenced by pointers)
+			XmlElement(const XmlElement&) = delete;
+			XmlElement& operator= (const XmlElement&) = delete;
+
 
 		};
 
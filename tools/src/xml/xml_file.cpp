@@ -1,158 +1,421 @@
 #include "xml_file.h"
 #include "fstream"
 #include "debug.h"
+#include "file_tools.h"
 
-const int XML_START_TAG = 1;
-const int XML_END_TAG = 2;
-const int XML_ONE_LINE_ELEMENT = 3;
+#include <cstring>
+#include <algorithm>
 
 
 namespace undicht {
 
 	namespace tools {
 
+		namespace {
+		// (only used by this file)
+
+		bool isXmlWhitespace(char c) {
+
+			return (c == ' ') || (c == '\n') || (c == '\t') || (c == '\r');
+		}
+
+		} // namespace
+
 		XmlFile::XmlFile() {
 			//ctor
 		}
 
-		XmlFile::XmlFile(const std::string& file_name) {
+		XmlFile::XmlFile(const std::string& file_name, bool memory_map) {
 			//ctor
 
-			open(file_name);
+			open(file_name, memory_map);
 		}
 
 		XmlFile::~XmlFile() {
 			//dtor
 		}
 
-		bool XmlFile::open(const std::string& file_name) {
+		bool XmlFile::open(const std::string& file_name, bool memory_map) {
+			/** loads the root element and all its sub elements
+			* @param memory_map: map the file into memory instead of reading it */
+
+			m_file_name = file_name;
+
+			// the old elements reference the old file data
+			clear();
+			m_assembled_strings.clear();
+			m_id_index.clear();
+			m_id_index_built = false;
+			m_file_data.clear();
+			m_mapped_file.close();
+
+			const char* data = 0;
+			size_t data_size = 0;
 
+			if (memory_map) {
 
-            std::ifstream file(file_name);
-            m_file_name = file_name;
+				if (!m_mapped_file.open(file_name))
+					return false;
+
+				data = m_mapped_file.getData();
+				data_size = m_mapped_file.getSize();
+			}
+			else {
+
+				std::ifstream file(file_name, std::ios::binary);
+
+				if (!file.is_open()) {
+					UND_ERROR << "failed to open file: " << file_name << "\n";
+					return false;
+				}
 
-			if (!file.is_open()) {
-                UND_ERROR << "failed to open file: " << file_name << "\n";
+				// reading the whole file at once
+				m_file_data.resize(getFileSize(file_name));
+				file.read(&m_file_data[0], m_file_data.size());
+				m_file_data.resize(file.gcount());
+
+				data = m_file_data.data();
+				data_size = m_file_data.size();
+			}
+
+			if (!parse(data, data + data_size)) {
+				UND_ERROR << "failed to parse xml file: " << file_name << "\n";
 				return false;
 			}
 
-			// loading all xml elements
-			m_child_elements.clear();
+			return true;
+		}
 
-			// the line in which the xml information is stored
-			std::string xml_info;
-            std::getline(file, xml_info);
 
-			setData(xml_info);
-			m_last_element = this;
+		XmlElement* XmlFile::getElementById(const XmlString& id) {
+			/** @return the element with the id attribute, 0 if there is none
+			* @param id: may start with a '#' and be surrounded by double quotes (as in "#id" references) */
 
+			if (!m_id_index_built)
+				buildIdIndex();
 
-			while (!file.eof()) {
+			XmlString key = id;
 
-				if (!readNextLine(file)) {
+			if ((key.size() >= 2) && (key[0] == '"') && (key[key.size() - 1] == '"'))
+				key = key.substr(1, key.size() - 2);
 
-					if (file.eof()) {
-						// a valid end to the reading
-						file.close();
-						return true;
-					}
-					// reached invalid line
-					file.close();
-					return false;
+			if (!key.empty() && (key[0] == '#'))
+				key = key.substr(1);
+
+			std::unordered_map<XmlString, XmlElement*, XmlStringHash>::iterator elem = m_id_index.find(key);
+
+			return (elem != m_id_index.end()) ? elem->second : 0;
+		}
+
+		void XmlFile::buildIdIndex() {
+			/** stores all elements with an id attribute in a hash map */
+
+			m_id_index.clear();
+			m_id_index_built = true;
+
+			// going through the tree without recursion
+			std::vector<XmlElement*> elements(1, this);
+
+			while (elements.size()) {
+
+				XmlElement* elem = elements.back();
+				elements.pop_back();
+
+				const XmlTagAttrib* id = elem->getAttribute("id");
+
+				if (id && (id->m_value.size() >= 2)) {
+					// if ids are not unique, the first one is stored
+					m_id_index.emplace(id->m_value.substr(1, id->m_value.size() - 2), elem); // without the quotes
 				}
 
+				// the children are visited in reverse order (so the first one gets stored first)
+				size_t children_start = elements.size();
+
+				for (XmlElement* child = elem->getFirstChild(); child; child = child->getNextSibling())
+					elements.push_back(child);
+
+				std::reverse(elements.begin() + children_start, elements.end());
 			}
-			 
-			file.close();
-			return true; // it could have actually worked
+
 		}
 
 
-		/////////////////////////////////// reading line by line /////////////////////////////////////
+		/////////////////////////////////// parsing the xml data /////////////////////////////////////
 
 
-		bool XmlFile::readNextLine(std::ifstream& file) {
-			/// reads and processes the next line of the file
+		bool XmlFile::parse(const char* data, const char* data_end) {
+			/// goes through the data once (char by char), building the element tree
 
-			std::string line;
-            std::getline(file, line);
-			if (!removeIndentation(line)) return 0; // no tag in line (line invalid)
+			// the elements whose end tag was not reached yet
+			// the last one is the element which gets the content + child elements that are read next
+			std::vector<XmlElement*> open_elements(1, this);
 
-			int line_tag_type = getLineTagType(line);
+			// the strings the contents of the open elements are assembled in (0 if the content is one piece of the file data)
+			std::vector<std::string*> assembled_contents(1, 0);
 
-			if (line_tag_type == XML_START_TAG) {
+			const char* pos = data;
 
-				m_last_element = m_last_element->addChildElement();
-				m_last_element->setData(line);
+			while (pos < data_end) {
 
-			}
-			else if (line_tag_type == XML_END_TAG) {
+				// text until the next tag is the content of the current element
+				const char* tag_start = (const char*)std::memchr(pos, '<', data_end - pos);
+				if (!tag_start)
+					tag_start = data_end;
+
+				if (open_elements.size() > 1)
+					addContent(pos, tag_start, open_elements.back(), assembled_contents.back());
+
+				pos = tag_start + 1;
+
+				if (pos >= data_end)
+					break;
+
+				if (!std::strncmp(pos, "!--", std::min<size_t>(3, data_end - pos))) {
+					// comment
+					pos = skipPast(pos + 3, data_end, "-->");
+				}
+				else if (!std::strncmp(pos, "![CDATA[", std::min<size_t>(8, data_end - pos))) {
+					// character data that is not parsed, belongs to the content of the element
+					const char* cdata_end = skipPast(pos + 8, data_end, "]]>");
+
+					if (cdata_end)
+						addContent(pos + 8, cdata_end - 3, open_elements.back(), assembled_contents.back(), false);
+
+					pos = cdata_end;
+				}
+				else if (*pos == '!') {
+					// doctype declaration (may contain an internal subset in [])
+					int bracket_depth = 0;
+
+					while ((pos < data_end) && ((*pos != '>') || bracket_depth)) {
+						bracket_depth += (*pos == '[') - (*pos == ']');
+						pos++;
+					}
+
+					pos = (pos < data_end) ? pos + 1 : 0;
+				}
+				else if (*pos == '?') {
+					// processing instruction, the xml declaration is stored in this element
+					const char* instruction_end = skipPast(pos, data_end, "?>");
+
+					if (instruction_end && (open_elements.size() == 1) && m_tag_name.empty() && !m_first_child) {
+
+						const char* name_end = pos;
+						while ((name_end < instruction_end - 2) && !isXmlWhitespace(*name_end))
+							name_end++;
+
+						setName(XmlString(pos, name_end));
+
+						if (!parseAttributes(name_end, instruction_end, this))
+							return false;
+					}
+
+					pos = instruction_end;
+				}
+				else if (*pos == '/') {
+					// end tag
+					const char* name_end = (const char*)std::memchr(pos, '>', data_end - pos);
+
+					if (!name_end) {
+						pos = 0;
+						break;
+					}
 
-				m_last_element = m_last_element->getParentElement();
+					// allowing whitespace between the name and the '>'
+					const char* name_start = pos + 1;
+					const char* name_last = name_end;
+					while ((name_last > name_start) && isXmlWhitespace(*(name_last - 1)))
+						name_last--;
 
-				if (!m_last_element) {
-					// the highest element should be the xml info element
-					// which has no end tag, so there is something wrong with the file
+					if ((open_elements.size() <= 1) || (open_elements.back()->m_tag_name != XmlString(name_start, name_last))) {
+						UND_ERROR << "unexpected xml end tag: " << std::string(name_start, name_last) << "\n";
+						return false;
+					}
+
+					if (assembled_contents.back())
+						open_elements.back()->m_content = XmlString(*assembled_contents.back());
+
+					open_elements.pop_back();
+					assembled_contents.pop_back();
+					pos = name_end + 1;
+				}
+				else {
+					// start tag
+					XmlElement* new_element = open_elements.back()->addChildElement();
+					bool self_closing = false;
+
+					if (!parseTag(pos, data_end, new_element, self_closing))
+						return false;
+
+					if (!self_closing) {
+						open_elements.push_back(new_element);
+						assembled_contents.push_back(0);
+					}
+
+				}
+
+				if (!pos) {
+					UND_ERROR << "unexpected end of xml data\n";
 					return false;
 				}
 
 			}
-			else if (line_tag_type == XML_ONE_LINE_ELEMENT) {
 
-				m_last_element->addChildElement()->setData(line);
+			if (open_elements.size() > 1) {
+				UND_ERROR << "missing xml end tag for element: " << open_elements.back()->getName() << "\n";
+				return false;
+			}
 
+			// the root element is never closed by an end tag
+			if (assembled_contents.back())
+				m_content = XmlString(*assembled_contents.back());
+
+			return true;
+		}
+
+		bool XmlFile::parseTag(const char*& pos, const char* end, XmlElement* elem, bool& self_closing) {
+			/// reads the name + attributes of a tag
+
+			const char* name_start = pos;
+
+			while ((pos < end) && !isXmlWhitespace(*pos) && (*pos != '>') && (*pos != '/'))
+				pos++;
+
+			if (pos == name_start) {
+				UND_ERROR << "found xml tag without a name\n";
+				return false;
 			}
-			else if (line_tag_type == 0) {
-				// invalid
 
+			elem->setName(XmlString(name_start, pos));
+
+			if (!parseAttributes(pos, end, elem))
+				return false;
+
+			if (*pos != '>' && *pos != '/') {
+				UND_ERROR << "invalid end of xml tag: " << elem->m_tag_name << "\n";
 				return false;
 			}
 
+			self_closing = (*pos == '/');
+			pos += self_closing ? 2 : 1;
+
 			return true;
 		}
 
+		bool XmlFile::parseAttributes(const char*& pos, const char* end, XmlElement* elem) {
+			/// reads the attributes of a tag until the closing '>', "/>" or "?>" is reached
 
-		int XmlFile::getLineTagType(const std::string& tag) {
-			/** @return the type of element tag stored in the line
-			* one of XML_START_TAG, XML_END_TAG, XML_ONE_LINE_ELEMENT
-			* @return 0 if invalid line */
+			while (pos < end) {
 
+				while ((pos < end) && isXmlWhitespace(*pos))
+					pos++;
 
-			if (tag.at(0) == '<') {
-				if (tag.back() == '>') {
-					// it seems to be a valid xml tag
-					if (tag.at(1) == '/') {
-						// end tag
+				if (pos >= end)
+					break;
 
-						return XML_END_TAG;
+				if ((*pos == '>') || (((*pos == '/') || (*pos == '?')) && (pos + 1 < end) && (*(pos + 1) == '>')))
+					return true; // reached the end of the tag
 
-					}
-					else if ((tag.find("/>") != std::string::npos) || (tag.find("</") != std::string::npos)) {
-						// @if one line element (tag only) || one liner with content
+				// attribute name
+				const char* name_start = pos;
+				while ((pos < end) && !isXmlWhitespace(*pos) && (*pos != '=') && (*pos != '>') && (*pos != '/'))
+					pos++;
 
-						return XML_ONE_LINE_ELEMENT;
-					}
+				if (pos == name_start) {
+					// i.e. a '/' that does not close the tag
+					UND_ERROR << "invalid char in xml tag: " << elem->m_tag_name << "\n";
+					return false;
+				}
+
+				XmlTagAttrib& attribute = *elem->addAttribute();
+				attribute.m_name = XmlString(name_start, pos);
 
-					return XML_START_TAG;
+				while ((pos < end) && isXmlWhitespace(*pos))
+					pos++;
+
+				if ((pos >= end) || (*pos != '='))
+					continue; // attribute without a value
+
+				pos++; // skipping the '='
+				while ((pos < end) && isXmlWhitespace(*pos))
+					pos++;
+
+				if ((pos >= end) || ((*pos != '"') && (*pos != '\''))) {
+					UND_ERROR << "missing quotes around the value of xml attribute: " << attribute.m_name << "\n";
+					return false;
+				}
+
+				// the value may contain any char but the quote used to surround it
+				const char* value_end = (const char*)std::memchr(pos + 1, *pos, end - pos - 1);
+				if (!value_end)
+					break;
+
+				// the value is stored with surrounding double quotes (i.e. "value")
+				if (*pos == '"') {
+					attribute.m_value = XmlString(pos, value_end + 1);
+				}
+				else {
+					m_assembled_strings.push_back('"' + std::string(pos + 1, value_end) + '"');
+					attribute.m_value = XmlString(m_assembled_strings.back());
 				}
-			}
 
+				pos = value_end + 1;
+			}
 
-			return 0; // invalid line
+			UND_ERROR << "unexpected end of xml tag: " << elem->m_tag_name << "\n";
+			return false;
 		}
 
-		bool XmlFile::removeIndentation(std::string& str) {
-			/// removes all free space characters in front of the '<'
+		void XmlFile::addContent(const char* text, const char* text_end, XmlElement* elem, std::string*& assembled, bool trim) {
+			/// stores the text (without the surrounding whitespace) as content of the element
 
-			int tag_start = str.find("<");
-			if (tag_start == std::string::npos) {
-				// no tag
-				return false;
+			if (trim) {
+
+				while ((text < text_end) && isXmlWhitespace(*text))
+					text++;
+
+				while ((text_end > text) && isXmlWhitespace(*(text_end - 1)))
+					text_end--;
 			}
 
-			str = str.substr(tag_start);
+			if (text == text_end)
+				return;
 
-			return true;
+			if (elem->m_content.empty()) {
+				// usually the content is one piece of the file data
+				elem->m_content = XmlString(text, text_end);
+			}
+			else {
+				// appending to one string per element (the content view is set to it once the element is closed)
+				if (!assembled) {
+					m_assembled_strings.push_back(std::string(elem->m_content.data(), elem->m_content.size()));
+					assembled = &m_assembled_strings.back();
+				}
+
+				assembled->push_back(' ');
+				assembled->append(text, text_end);
+			}
+		}
+
+		const char* XmlFile::skipPast(const char* pos, const char* end, const char* pattern) {
+			/// @return the position after the first occurrence of the pattern (0 if the pattern was not found)
+
+			size_t pattern_length = std::strlen(pattern);
+
+			while (pos && (pos + pattern_length <= end)) {
+
+				pos = (const char*)std::memchr(pos, pattern[0], end - pos);
+
+				if (!pos || (pos + pattern_length > end))
+					return 0;
+
+				if (!std::memcmp(pos, pattern, pattern_length))
+					return pos + pattern_length;
+
+				pos++;
+			}
+
+			return 0;
 		}
 
 	} // tools
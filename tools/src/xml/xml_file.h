@@ -3,7 +3,10 @@
 
 
 #include "xml_element.h"
+#include "mapped_file.h"
 #include "fstream"
+#include <deque>
+#include <unordered_map>
 
 namespace undicht {
 
@@ -12,37 +15,71 @@ namespace undicht {
 		class XmlFile : public XmlElement {
 			/** a class that can be used to read xml style files
 			* after being opened, the XmlFile object resembles the xml information element of the file
-			* the other elements are stored in m_child_elements */
+			* the other elements are its child elements (stored in its arena)
+			* the names, attributes and contents of all elements are views into the file data owned by the XmlFile
+			* so they are only valid as long as the XmlFile exists (and is not reopened) */
         protected:
 
             std::string m_file_name;
 
-        private:
+            // the data of the file (either read into memory or mapped into memory)
+            std::string m_file_data;
+            MappedFile m_mapped_file;
+
+            // strings that dont exist as one piece in the file data
+            // (i.e. content interrupted by comments, attribute values in single quotes)
+            // (a deque, because the strings may not move once they are referenced)
+            std::deque<std::string> m_assembled_strings;
+
+            // the elements of the file by the value of their id attribute (built when it is first needed)
+            std::unordered_map<XmlString, XmlElement*, XmlStringHash> m_id_index;
+            bool m_id_index_built = false;
 
-			XmlElement* m_last_element = 0;
+        private:
+            // parsing the xml data
 
-			/**  reads and processes the next line of the file
-			*  @return whether the line was valid */
-			virtual bool readNextLine(std::ifstream& file);
+			/** goes through the data once (char by char), building the element tree
+			* tags dont have to be on separate lines, comments, CDATA sections and doctype declarations are supported
+			* @return false if the data is not valid xml */
+			bool parse(const char* data, const char* data_end);
 
-			/** @return the type of element tag stored in the line
-			* one of XML_START_TAG, XML_END_TAG, XML_ONE_LINE_ELEMENT
-			* @return 0 if invalid line */
-			int getLineTagType(const std::string& tag);
+			/** reads the name + attributes of a tag
+			* @param pos: should point to the first char of the tag name, points to the first char after the tag afterwards
+			* @param self_closing: set to true if the tag ended with "/>" (element without content / end tag)
+			* @return false if the tag is not valid */
+			bool parseTag(const char*& pos, const char* end, XmlElement* elem, bool& self_closing);
 
-			/** removes all free space characters in front of the '<'
-			* @return false if the string does not contain a '<' */
-			bool removeIndentation(std::string& str);
+			/** reads the attributes of a tag until the closing '>', "/>" or "?>" is reached
+			* @param pos: points to the closing sequence afterwards */
+			bool parseAttributes(const char*& pos, const char* end, XmlElement* elem);
 
+			/** stores the text (without the surrounding whitespace) as content of the element
+			* if the element already has content, the text gets appended (separated by a space) to the assembled string
+			* @param assembled: the string the content of the element is assembled in (created when the second piece is added)
+			* the content of the element should be set to it once the element is closed */
+			void addContent(const char* text, const char* text_end, XmlElement* elem, std::string*& assembled, bool trim = true);
 
+			/** @return the position after the first occurrence of the pattern (0 if the pattern was not found) */
+			const char* skipPast(const char* pos, const char* end, const char* pattern);
 
 		public:
 
-			// loads the root element and all its sub elements
-			virtual bool open(const std::string& file_name);
+			/** loads the root element and all its sub elements
+			* @param memory_map: map the file into memory instead of reading it
+			* (no copy of the file is made, but the file should not be changed while the XmlFile is open) */
+			virtual bool open(const std::string& file_name, bool memory_map = false);
+
+			/** @return the element with the id attribute, 0 if there is none
+			* @param id: may start with a '#' and be surrounded by double quotes (as in "#id" references)
+			* (the first call builds an index of all ids, so its not thread safe (see buildIdIndex()) ) */
+			XmlElement* getElementById(const XmlString& id);
+
+			/** stores all elements with an id attribute in a hash map (happens automatically when getElementById() is first called)
+			* should be called before getElementById() gets used by multiple threads */
+			void buildIdIndex();
 
 			XmlFile();
-			XmlFile(const std::string& file_name);
+			XmlFile(const std::string& file_name, bool memory_map = false);
 			virtual ~XmlFile();
 
 
@@ -0,0 +1,76 @@
+#include "xml_query.h"
+#include <algorithm>
+
+
+namespace undicht {
+
+	namespace tools {
+
+		XmlQuery::XmlQuery() {
+			//ctor
+		}
+
+		XmlQuery::XmlQuery(const std::vector<std::string>& attribute_strings) {
+			//ctor
+
+			setQuery(attribute_strings);
+		}
+
+		XmlQuery::~XmlQuery() {
+			//dtor
+		}
+
+		void XmlQuery::setQuery(const std::vector<std::string>& attribute_strings) {
+			/** @param attribute_strings: each string should look like this "name attr0=val0 attr1=val1 ..." */
+
+			m_steps.clear();
+			m_steps.reserve(attribute_strings.size());
+
+			for (const std::string& attribute_string : attribute_strings) {
+
+				m_steps.emplace_back(XmlQueryStep());
+				XmlQueryStep& step = m_steps.back();
+
+				// the name ends at the first space
+				size_t attr_end = attribute_string.find(' ');
+				step.name = attribute_string.substr(0, attr_end);
+
+				// the attributes are separated by spaces
+				while (attr_end < attribute_string.size()) {
+
+					size_t attr_start = attr_end + 1;
+					attr_end = std::min(attribute_string.find(' ', attr_start), attribute_string.size());
+
+					size_t split_pos = attribute_string.find('=', attr_start);
+
+					if (split_pos >= attr_end) {
+						// attribute without a value (cant be matched by any element)
+						step.valid = false;
+						continue;
+					}
+
+					XmlQueryAttrib attribute;
+					attribute.negate = (split_pos > attr_start) && (attribute_string[split_pos - 1] == '!');
+					attribute.name = attribute_string.substr(attr_start, split_pos - attr_start - attribute.negate);
+					attribute.value = attribute_string.substr(split_pos + 1, attr_end - split_pos - 1);
+
+					step.attributes.push_back(attribute);
+				}
+
+			}
+
+		}
+
+		int XmlQuery::getStepCount() const {
+
+			return m_steps.size();
+		}
+
+		const XmlQueryStep& XmlQuery::getStep(int step) const {
+
+			return m_steps.at(step);
+		}
+
+	} // tools
+
+} // undicht
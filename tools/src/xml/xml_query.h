@@ -0,0 +1,55 @@
+#ifndef XML_QUERY_H
+#define XML_QUERY_H
+
+#include <string>
+#include <vector>
+
+
+namespace undicht {
+
+	namespace tools {
+
+		struct XmlQueryAttrib {
+			/// an attribute the searched element has to have
+			std::string name;
+			std::string value; // stored with surrounding double quotes, just like the values of XmlTagAttrib
+			bool negate = false; // the attribute has to have a different value
+		};
+
+		struct XmlQueryStep {
+			/// the element searched for at one level of the search path
+			std::string name;
+			std::vector<XmlQueryAttrib> attributes;
+			bool valid = true; // false, if one of the attribute strings did not contain a value (no element can match)
+		};
+
+		class XmlQuery {
+			/** a search path for xml elements that can be used with XmlElement::getElement() and XmlElement::getAllElements()
+			* it is split into its parts once when the query is created, so that it can be reused without parsing the strings again
+			* @example XmlQuery({ "COLLADA", "library_images", "image id=\"image_0\"", "init_from" }) */
+		protected:
+
+			std::vector<XmlQueryStep> m_steps;
+
+		public:
+
+			/** @param attribute_strings: each string should look like this "name attr0=val0 attr1=val1 ..."
+			* tag attributes can be negated using "!=" */
+			void setQuery(const std::vector<std::string>& attribute_strings);
+
+			int getStepCount() const;
+			const XmlQueryStep& getStep(int step) const;
+
+		public:
+
+			XmlQuery();
+			XmlQuery(const std::vector<std::string>& attribute_strings);
+			virtual ~XmlQuery();
+
+		};
+
+	} // tools
+
+} // undicht
+
+#endif // XML_QUERY_H
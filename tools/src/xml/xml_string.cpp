@@ -0,0 +1,224 @@
+#include "xml_string.h"
+#include <cstring>
+#include <algorithm>
+#include <cstdint>
+
+
+namespace undicht {
+
+	namespace tools {
+
+		const size_t XmlString::npos;
+
+		XmlString::XmlString() {
+			//ctor
+		}
+
+		XmlString::XmlString(const char* data, size_t size) {
+
+			m_data = data;
+			m_size = size;
+		}
+
+		XmlString::XmlString(const char* begin, const char* end) {
+
+			m_data = begin;
+			m_size = end - begin;
+		}
+
+		XmlString::XmlString(const std::string& str) {
+			/// the view is only valid as long as str is not changed / destroyed
+
+			m_data = str.data();
+			m_size = str.size();
+		}
+
+
+		const char* XmlString::data() const {
+
+			return m_data;
+		}
+
+		size_t XmlString::size() const {
+
+			return m_size;
+		}
+
+		bool XmlString::empty() const {
+
+			return !m_size;
+		}
+
+		const char* XmlString::begin() const {
+
+			return m_data;
+		}
+
+		const char* XmlString::end() const {
+
+			return m_data + m_size;
+		}
+
+		char XmlString::operator[] (size_t pos) const {
+
+			return m_data[pos];
+		}
+
+		size_t XmlString::find(char c, size_t pos) const {
+			/** @return the position of the first occurrence of c at or after pos (npos if there is none) */
+
+			if (pos >= m_size)
+				return npos;
+
+			const char* found = (const char*)std::memchr(m_data + pos, c, m_size - pos);
+
+			return found ? found - m_data : npos;
+		}
+
+		XmlString XmlString::substr(size_t pos, size_t count) const {
+
+			pos = std::min(pos, m_size);
+			count = std::min(count, m_size - pos);
+
+			return XmlString(m_data + pos, count);
+		}
+
+		int XmlString::compare(const XmlString& str) const {
+			/** same return value as std::string::compare() */
+
+			int result = m_size && str.m_size ? std::memcmp(m_data, str.m_data, std::min(m_size, str.m_size)) : 0;
+
+			if (result)
+				return result;
+
+			return (m_size < str.m_size) ? -1 : (m_size > str.m_size);
+		}
+
+		int XmlString::compare(const std::string& str) const {
+
+			return compare(XmlString(str.data(), str.size()));
+		}
+
+		int XmlString::compare(const char* str) const {
+
+			return compare(XmlString(str, std::strlen(str)));
+		}
+
+		bool XmlString::operator== (const XmlString& str) const {
+
+			return (m_size == str.m_size) && !compare(str);
+		}
+
+		bool XmlString::operator== (const std::string& str) const {
+
+			return (m_size == str.size()) && !compare(str);
+		}
+
+		bool XmlString::operator== (const char* str) const {
+
+			return !compare(str);
+		}
+
+		bool XmlString::operator!= (const XmlString& str) const {
+
+			return !(*this == str);
+		}
+
+		bool XmlString::operator!= (const std::string& str) const {
+
+			return !(*this == str);
+		}
+
+		bool XmlString::operator!= (const char* str) const {
+
+			return !(*this == str);
+		}
+
+		std::string XmlString::str() const {
+			/** copies the viewed chars into a std::string */
+
+			return std::string(m_data, m_size);
+		}
+
+		XmlString::operator std::string() const {
+
+			return str();
+		}
+
+		void XmlString::clear() {
+
+			m_data = 0;
+			m_size = 0;
+		}
+
+		size_t XmlStringHash::operator() (const XmlString& str) const {
+			/// FNV-1a
+
+			uint32_t hash = 2166136261u;
+
+			for (char c : str) {
+				hash ^= (unsigned char)c;
+				hash *= 16777619u;
+			}
+
+			return hash;
+		}
+
+		/////////////////////////////////////////// operators for using XmlStrings together with std::strings ///////////////////////////////////////////
+
+		bool operator== (const std::string& a, const XmlString& b) {
+
+			return b == a;
+		}
+
+		bool operator!= (const std::string& a, const XmlString& b) {
+
+			return b != a;
+		}
+
+		std::string operator+ (const std::string& a, const XmlString& b) {
+
+			std::string result;
+			result.reserve(a.size() + b.size());
+			result.append(a).append(b.data(), b.size());
+
+			return result;
+		}
+
+		std::string operator+ (const XmlString& a, const std::string& b) {
+
+			std::string result;
+			result.reserve(a.size() + b.size());
+			result.append(a.data(), a.size()).append(b);
+
+			return result;
+		}
+
+		std::string operator+ (const char* a, const XmlString& b) {
+
+			return std::string(a) + b;
+		}
+
+		std::string operator+ (const XmlString& a, const char* b) {
+
+			return a + std::string(b);
+		}
+
+		std::string operator+ (char a, const XmlString& b) {
+
+			return std::string(1, a) + b;
+		}
+
+		std::string operator+ (const XmlString& a, char b) {
+
+			return a + std::string(1, b);
+		}
+
+		std::ostream& operator<< (std::ostream& out, const XmlString& str) {
+
+			return out.write(str.data(), str.size());
+		}
+
+	} // tools
+
+} // undicht
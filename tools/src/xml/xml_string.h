@@ -0,0 +1,86 @@
+#ifndef XML_STRING_H
+#define XML_STRING_H
+
+#include <string>
+#include <ostream>
+
+namespace undicht {
+
+	namespace tools {
+
+		class XmlString {
+			/** a non owning view of a string stored somewhere else (i.e. in the data of a XmlFile)
+			* the view is only valid as long as the data it points to exists
+			* can be used like a (read only) std::string in most places, since it converts to one implicitly */
+		protected:
+
+			const char* m_data = 0;
+			size_t m_size = 0;
+
+		public:
+
+			static const size_t npos = size_t(-1);
+
+			const char* data() const;
+			size_t size() const;
+			bool empty() const;
+
+			const char* begin() const;
+			const char* end() const;
+
+			char operator[] (size_t pos) const;
+
+			/** @return the position of the first occurrence of c at or after pos (npos if there is none) */
+			size_t find(char c, size_t pos = 0) const;
+
+			XmlString substr(size_t pos, size_t count = npos) const;
+
+			/** same return value as std::string::compare() */
+			int compare(const XmlString& str) const;
+			int compare(const std::string& str) const;
+			int compare(const char* str) const;
+
+			bool operator== (const XmlString& str) const;
+			bool operator== (const std::string& str) const;
+			bool operator== (const char* str) const;
+
+			bool operator!= (const XmlString& str) const;
+			bool operator!= (const std::string& str) const;
+			bool operator!= (const char* str) const;
+
+			/** copies the viewed chars into a std::string */
+			std::string str() const;
+			operator std::string() const;
+
+			void clear();
+
+			XmlString();
+			XmlString(const char* data, size_t size);
+			XmlString(const char* begin, const char* end);
+			explicit XmlString(const std::string& str);
+
+		};
+
+		class XmlStringHash {
+			/// hash function, so that XmlStrings can be used as keys in unordered containers
+		public:
+			size_t operator() (const XmlString& str) const;
+		};
+
+		bool operator== (const std::string& a, const XmlString& b);
+		bool operator!= (const std::string& a, const XmlString& b);
+
+		std::string operator+ (const std::string& a, const XmlString& b);
+		std::string operator+ (const XmlString& a, const std::string& b);
+		std::string operator+ (const char* a, const XmlString& b);
+		std::string operator+ (const XmlString& a, const char* b);
+		std::string operator+ (char a, const XmlString& b);
+		std::string operator+ (const XmlString& a, char b);
+
+		std::ostream& operator<< (std::ostream& out, const XmlString& str);
+
+	} // tools
+
+} // undicht
+
+#endif // XML_STRING_H
@@ -10,8 +10,10 @@ namespace undicht {
 			//ctor
 		}
 
-		XmlTagAttrib::XmlTagAttrib(const std::string& data) {
-			setData(data);
+		XmlTagAttrib::XmlTagAttrib(const XmlString& name, const XmlString& value) {
+
+			m_name = name;
+			m_value = value;
 		}
 
 		XmlTagAttrib::~XmlTagAttrib() {
@@ -19,18 +21,6 @@ namespace undicht {
 		}
 
 
-		void XmlTagAttrib::setData(const std::string& data) {
-			/** @param data would be something like "name="first_tag_attribute""
-			* "name" would be the attrib name and "first_tag_attribute" its value */
-
-			// splitting the data into name and value
-			size_t split_pos = data.find("=");
-			m_name = data.substr(0, split_pos);
-			m_value = data.substr(split_pos + 1); // skipping the "="
-
-		}
-
-
 		bool XmlTagAttrib::operator== (const std::string& data) const {
 			/** @example tag attributes can be negated using "!=" */
 
@@ -43,12 +33,13 @@ namespace undicht {
 				return false;
 			}
 
-			std::string name = data.substr(0, split_pos - negate_value);
-			std::string value = data.substr(split_pos + 1); // skipping the "="
+			// no copies of the name / value needed
+			XmlString name(data.data(), split_pos - negate_value);
+			XmlString value(data.data() + split_pos + 1, data.size() - split_pos - 1); // skipping the "="
 
-			if (!m_name.compare(name)) {
+			if (m_name == name) {
 
-				if (bool(m_value.compare(value)) == negate_value) {
+				if ((m_value != value) == negate_value) {
 					// attribute data equal
 					return true;
 				}
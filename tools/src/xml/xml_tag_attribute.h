@@ -2,6 +2,7 @@
 #define XML_TAG_ATTRIBUTE_H
 
 #include <string>
+#include "xml_string.h"
 
 namespace undicht {
 
@@ -11,18 +12,16 @@ namespace undicht {
 			/// a class containing the content of a single xml tag attribute
 		public:
 
-			std::string m_name;
-			std::string m_value;
-
-			/** @param data would be something like "name="first_tag_attribute""
-			* "name" would be the attrib name and "first_tag_attribute" its value */
-			void setData(const std::string& data);
+			// views into the data of the xml file
+			// the value is stored with surrounding double quotes (i.e. "first_tag_attribute")
+			XmlString m_name;
+			XmlString m_value;
 
 			/** @example tag attributes can be negated using "!=" */
 			bool operator== (const std::string& data) const;
 
 			XmlTagAttrib();
-			XmlTagAttrib(const std::string& data);
+			XmlTagAttrib(const XmlString& name, const XmlString& value);
 			virtual ~XmlTagAttrib();
 
 		};